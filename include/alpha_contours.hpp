@@ -0,0 +1,92 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <include/vector.hpp>
+#include <include/collision_shape.hpp>
+#include <include/collision_line_sequence.hpp>
+#include <include/polyline_shape.hpp>
+
+namespace ts
+{
+    /// \brief outlines of the opaque areas of an image, c.f. ts::AlphaContourBaker
+    struct AlphaContours
+    {
+        /// \brief width of the image, in pixels
+        size_t width = 0;
+
+        /// \brief height of the image, in pixels
+        size_t height = 0;
+
+        /// \brief closed outlines, the first and last vertex of each chain are equal. Positions are in pixels relative to the top left of the image. Chains run clockwise around opaque areas and counter-clockwise around holes, such that one-sided shapes collide on the transparent side
+        std::vector<std::vector<Vector2f>> chains;
+
+        /// \brief create one collision line sequence per chain
+        /// \param world: world to create the shapes in
+        /// \param type: collision type
+        /// \param top_left: position of the top left corner of the image in the world
+        /// \param is_two_sided: if false, chains are one-sided, c.f. ts::CollisionLineSequence
+        /// \returns vector of shapes, heap-allocated because box2d holds pointers to them
+        std::vector<std::unique_ptr<CollisionLineSequence>> create_collision_shapes(PhysicsWorld* world, CollisionType type, Vector2f top_left = Vector2f(0, 0), bool is_two_sided = true) const;
+
+        /// \brief create one polyline per chain, with the exact same vertices as the collision shapes
+        /// \param top_left: position of the top left corner of the image in the world
+        /// \param thickness: width of the lines, in pixels
+        /// \returns vector of polylines
+        std::vector<PolylineShape> create_render_shapes(Vector2f top_left = Vector2f(0, 0), float thickness = 1) const;
+    };
+
+    /// \brief extract the outlines of the opaque areas of an image using marching squares, such that collision for hand-painted terrain can be generated from the image itself
+    class AlphaContourBaker
+    {
+        public:
+            /// \brief construct
+            /// \param alpha_threshold: pixels with an alpha of at least this value are opaque, in [0, 1]
+            /// \param simplification_tolerance: maximum deviation of the simplified chains from the traced outline, in pixels, c.f. ts::CollisionLineSequence::simplify
+            /// \param n_threads: number of threads the image is split across, or 0 to use one per hardware thread
+            AlphaContourBaker(float alpha_threshold = 0.5, float simplification_tolerance = 1, size_t n_threads = 0);
+
+            /// \brief set the directory results of ts::AlphaContourBaker::bake_file are cached in. Caching is disabled if the directory is empty, which is the default
+            /// \param directory: path to an existing directory
+            void set_cache_directory(const std::string&);
+
+            /// \brief extract the outlines of an image file. If caching is enabled and the file, threshold and tolerance are the same as for a previous bake, the cached result is loaded instead and the image is not decoded
+            /// \param path: path to image file, supported formats are the same as for ts::StaticTexture::load
+            /// \param out: [out] contours
+            /// \returns true if successful, false otherwise
+            bool bake_file(const std::string& path, AlphaContours* out);
+
+            /// \brief extract the outlines from an alpha channel
+            /// \param alpha: one byte per pixel, row-major
+            /// \param width: width of the image, in pixels
+            /// \param height: height of the image, in pixels
+            /// \returns contours
+            AlphaContours bake(const std::vector<uint8_t>& alpha, size_t width, size_t height) const;
+
+            /// \brief was the result of the last call to ts::AlphaContourBaker::bake_file loaded from the cache
+            /// \returns true if cached, false otherwise
+            bool get_last_was_cached() const;
+
+            /// \brief version of the cache file format, files of other versions are ignored
+            static inline constexpr uint32_t cache_version = 2;
+
+        private:
+            float _alpha_threshold;
+            float _simplification_tolerance;
+            size_t _n_threads;
+
+            std::string _cache_directory;
+            bool _last_was_cached = false;
+
+            std::string get_cache_path(uint64_t file_hash) const;
+            bool load_cache(const std::string& path, AlphaContours* out) const;
+            void save_cache(const std::string& path, const AlphaContours&) const;
+    };
+}
@@ -0,0 +1,139 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace ts
+{
+    /// \brief apply all audio commands issued since the last call, such as playing a sound or changing the volume of a channel. Called by ts::end_frame, only needs to be called manually if ts::end_frame is not used
+    /// \returns number of commands applied
+    size_t flush_audio_commands();
+
+    namespace detail
+    {
+        // for critical sections of a few instructions that may be entered from the audio thread, usable with std::lock_guard
+        class SpinLock
+        {
+            public:
+                void lock()
+                {
+                    while (_flag.test_and_set(std::memory_order_acquire))
+                        ;
+                }
+
+                void unlock()
+                {
+                    _flag.clear(std::memory_order_release);
+                }
+
+            private:
+                std::atomic_flag _flag = ATOMIC_FLAG_INIT;
+        };
+
+        // bounded multi-producer single-consumer queue, push and pop are lock-free
+        template<typename T, size_t Capacity>
+        class MPSCQueue
+        {
+            static_assert(Capacity > 0 and (Capacity & (Capacity - 1)) == 0, "In ts::detail::MPSCQueue: Capacity has to be a power of two");
+
+            public:
+                MPSCQueue();
+
+                // thread-safe, returns false if the queue is full
+                bool try_push(const T&);
+
+                // may only be called by one thread at a time, returns false if the queue is empty
+                bool try_pop(T&);
+
+            private:
+                struct Cell
+                {
+                    std::atomic<size_t> sequence;
+                    T value;
+                };
+
+                std::array<Cell, Capacity> _cells;
+                alignas(64) std::atomic<size_t> _push_position = 0;
+                alignas(64) size_t _pop_position = 0;
+        };
+
+        // deferred call to SDL_mixer, written by ts::SoundHandler, ts::MusicHandler, ts::MusicPlaylist and ts::AudioMixer
+        struct AudioCommand
+        {
+            enum Type : uint8_t
+            {
+                CHANNEL_PLAY,
+                CHANNEL_FADE_IN,
+                CHANNEL_STOP,
+                CHANNEL_FADE_OUT,
+                CHANNEL_PAUSE,
+                CHANNEL_UNPAUSE,
+                CHANNEL_EXPIRE,
+                CHANNEL_SET_VOLUME,
+                CHANNEL_SET_PANNING,
+                CHANNEL_SET_POSITION,
+
+                MUSIC_PLAY,
+                MUSIC_FADE_IN,
+                MUSIC_STOP,
+                MUSIC_FADE_OUT,
+                MUSIC_PAUSE,
+                MUSIC_UNPAUSE,
+                MUSIC_SKIP_TO,
+                MUSIC_SET_VOLUME,
+
+                PLAYLIST_START,
+                PLAYLIST_STOP,
+                PLAYLIST_SKIP,
+
+                MIXER_ENABLE,
+                MIXER_DISABLE,
+                MIXER_SET_BUS_VOLUME,
+                MIXER_SET_BUS_LOW_PASS,
+                MIXER_SET_LIMITER
+            };
+
+            Type type;
+            int32_t channel = -1;
+            int32_t n_loops = 0;
+            int32_t duration_ms = 0;
+            float value = 0;
+            uint8_t distance = 0;
+            uint8_t bus = 0; // ts::AudioBus
+            uint32_t stream = 0; // serial of a ts::StreamingSound, 0 for a regular sound
+            void* data = nullptr; // Mix_Chunk* or Mix_Music*
+        };
+
+        // queue shared by all audio handlers, such that commands are applied in the order they were issued
+        class AudioCommandQueue
+        {
+            public:
+                static inline constexpr size_t capacity = 4096;
+
+                // thread-safe, never takes a lock unless the queue is full
+                static void push(const AudioCommand&);
+
+                // applies all commands while holding the audio device lock once, instead of once per command
+                static size_t flush();
+
+                // applies all commands issued so far before returning, called before freeing audio that queued commands may point to
+                static void flush_pending();
+
+            private:
+                static size_t apply_all();
+                static void apply(const AudioCommand&);
+
+                static inline MPSCQueue<AudioCommand, capacity> _queue;
+                static inline std::atomic_flag _is_flushing = ATOMIC_FLAG_INIT;
+        };
+    }
+}
+
+#include <src/audio_command_queue.inl>
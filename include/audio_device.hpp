@@ -0,0 +1,104 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#pragma once
+
+#include <atomic>
+
+#include <SDL2/SDL_mixer.h>
+
+#include <include/time.hpp>
+#include <include/music_handler.hpp>
+
+namespace ts
+{
+    namespace detail
+    {
+        // cpu time consumed by the calling thread in nanoseconds, 0 on platforms without a per-thread cpu clock
+        uint64_t thread_cpu_ns();
+    }
+
+    /// \brief configuration of the audio device, c.f. ts::initialize
+    struct AudioConfig
+    {
+        /// \brief number of frames per second, in Hz
+        size_t sample_rate = MusicHandler::sample_rate;
+
+        /// \brief number of output channels, 1 for mono, 2 for stereo
+        size_t n_channels = 2;
+
+        /// \brief number of frames mixed per audio callback. Smaller buffers lower the latency, but leave less time to mix each of them
+        size_t chunk_size = 1024;
+
+        /// \brief sample format, one of SDLs AUDIO_* constants. ts::AudioMixer and ts::MusicPlaylist require AUDIO_S16SYS
+        uint16_t format = MIX_DEFAULT_FORMAT;
+    };
+
+    /// \brief the audio device all sounds and music are played on, opened by ts::initialize
+    class AudioDevice
+    {
+        public:
+            /// \brief open the audio device, called by ts::initialize
+            /// \param config: requested configuration, the device may choose a different one
+            /// \returns true if successful, false otherwise
+            static bool open(AudioConfig = AudioConfig());
+
+            /// \brief close the device and open it again with a different configuration. All sounds, streamed sounds and music are stopped, then reloaded in the new format
+            /// \param config: requested configuration
+            /// \returns true if successful, false if the device was reopened with the previous configuration instead
+            static bool reopen(AudioConfig);
+
+            /// \brief is the audio device open
+            /// \returns true if open, false otherwise
+            static bool is_open();
+
+            /// \brief get the configuration the device actually uses, which may differ from the one requested
+            /// \returns configuration, the chunk size is measured once the first buffer was mixed
+            static AudioConfig get_config();
+
+            /// \brief get the delay the mixer adds between a sound being played and it reaching the driver, which is one buffer. The driver may add its own buffering, which SDL does not report
+            /// \returns latency
+            static Time get_latency();
+
+            /// \brief get the cpu time the audio thread spent on the last buffer, including SDL_mixer, ts::AudioMixer and the driver
+            /// \returns duration, 0 on platforms without a per-thread cpu clock
+            static Time get_last_callback_cpu_time();
+
+            /// \brief get the average cpu time the audio thread spent per buffer since the last reset
+            /// \returns duration, 0 on platforms without a per-thread cpu clock
+            static Time get_average_callback_cpu_time();
+
+            /// \brief get the largest cpu time the audio thread spent on one buffer since the last reset
+            /// \returns duration, 0 on platforms without a per-thread cpu clock
+            static Time get_max_callback_cpu_time();
+
+            /// \brief get the number of buffers mixed since the last reset
+            /// \returns number of callbacks
+            static size_t get_n_callbacks();
+
+            /// \brief reset callback statistics
+            static void reset_callback_statistics();
+
+        private:
+            static bool open_device(AudioConfig);
+
+            // the only post-mix hook, forwards to ts::AudioMixer
+            static void on_post_mix(void*, uint8_t* stream, int length);
+
+            static inline bool _is_open = false;
+            static inline AudioConfig _requested;
+            static inline std::atomic<size_t> _bytes_per_frame = 4;
+            static inline std::atomic<int> _frequency = 0;
+
+            // written by the audio thread
+            static inline uint64_t _last_thread_ns = 0;
+            static inline uint64_t _last_callback_ns = 0; // wall clock
+            static inline std::atomic<size_t> _n_frames_per_callback = 0;
+            static inline std::atomic<uint64_t> _last_ns = 0;
+            static inline std::atomic<uint64_t> _max_ns = 0;
+            static inline std::atomic<uint64_t> _total_ns = 0;
+            static inline std::atomic<size_t> _n_callbacks = 0;
+    };
+}
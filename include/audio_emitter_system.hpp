@@ -0,0 +1,131 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <unordered_map>
+
+#include <include/sound.hpp>
+#include <include/vector.hpp>
+#include <include/camera.hpp>
+
+namespace ts
+{
+    /// \brief id of an emitter, c.f. ts::AudioEmitterSystem::add
+    using AudioEmitterID = size_t;
+
+    /// \brief sounds positioned in the world, panned and attenuated relative to a listener. Emitters out of hearing range are virtual: they do not use a channel until they come back in range
+    class AudioEmitterSystem
+    {
+        public:
+            /// \brief construct
+            /// \param hearing_radius: distance from the listener, in world units, at which emitters become inaudible
+            AudioEmitterSystem(float hearing_radius = 1000);
+
+            /// \brief destruct, stops all emitters
+            ~AudioEmitterSystem();
+
+            /// \brief add an emitter, it starts playing at the next update if it is in range
+            /// \param sound: sound to play, user is responsible for the sound staying in memory
+            /// \param position: position in the world
+            /// \param should_loop: if true, the sound repeats until the emitter is removed. Otherwise, the emitter is removed once the sound ends, or once it leaves the hearing range
+            /// \param priority: priority of the voice, c.f. ts::SoundHandler::play
+            /// \returns id of the emitter
+            AudioEmitterID add(Sound&, Vector2f position, bool should_loop = true, int32_t priority = 0);
+
+            /// \brief remove an emitter, stopping its sound
+            /// \param id: id returned by ts::AudioEmitterSystem::add
+            void remove(AudioEmitterID);
+
+            /// \brief does an emitter exist, emitters that do not loop are removed automatically
+            /// \param id: id returned by ts::AudioEmitterSystem::add
+            /// \returns true if the emitter exists, false otherwise
+            bool has_emitter(AudioEmitterID) const;
+
+            /// \brief move an emitter, takes effect at the next update
+            /// \param id: id returned by ts::AudioEmitterSystem::add
+            /// \param position: new position in the world
+            void set_position(AudioEmitterID, Vector2f);
+
+            /// \brief get the position of an emitter
+            /// \param id: id returned by ts::AudioEmitterSystem::add
+            /// \returns position in the world
+            Vector2f get_position(AudioEmitterID) const;
+
+            /// \brief is an emitter currently without a channel, because it is out of range or all channels are taken by sounds of higher priority
+            /// \param id: id returned by ts::AudioEmitterSystem::add
+            /// \returns true if virtual, false if audible
+            bool get_is_virtual(AudioEmitterID) const;
+
+            /// \brief compute panning and attenuation of all emitters relative to the center of the camera, should be called once per frame
+            /// \param camera: camera, its center is the listener
+            void update(const Camera&);
+
+            /// \brief compute panning and attenuation of all emitters relative to a listener, should be called once per frame. Channels are only updated if their quantized position changed
+            /// \param listener: position of the listener in the world
+            void update(Vector2f listener);
+
+            /// \brief set the distance at which emitters become inaudible, takes effect at the next update
+            /// \param radius: distance, in world units
+            void set_hearing_radius(float);
+
+            /// \brief get the distance at which emitters become inaudible
+            /// \returns distance, in world units
+            float get_hearing_radius() const;
+
+            /// \brief get the number of emitters
+            /// \returns number of emitters
+            size_t get_n_emitters() const;
+
+            /// \brief get the number of emitters that were virtual during the last update
+            /// \returns number of emitters
+            size_t get_n_virtual() const;
+
+            /// \brief get the number of channel positions sent to the mixer during the last update
+            /// \returns number of updates
+            size_t get_n_position_updates() const;
+
+            /// \brief number of distinct angles an emitter can have, positions are quantized such that small movements do not need to update the channel
+            static inline constexpr size_t n_angle_steps = 64;
+
+        private:
+            float _hearing_radius;
+
+            // structure of arrays, indexed by slot, such that distances can be computed in one pass
+            std::vector<float> _x;
+            std::vector<float> _y;
+            std::vector<float> _distance_squared; // scratch
+
+            struct Emitter
+            {
+                AudioEmitterID id;
+                Sound* sound;
+                bool should_loop;
+                int32_t priority;
+
+                size_t channel; // or ts::SoundHandler::no_channel if virtual
+                uint32_t play_count; // n_started of the channel when it was assigned, detects stolen voices
+                int32_t angle_step; // last quantized position sent, -1 if none
+                int32_t distance;
+            };
+
+            std::vector<Emitter> _emitters;
+            std::unordered_map<AudioEmitterID, size_t> _id_to_slot;
+            AudioEmitterID _current_id = 1;
+
+            size_t _n_virtual = 0;
+            size_t _n_position_updates = 0;
+
+            // sum over all instances, c.f. ts::AudioStatistics
+            friend class AudioStatistics;
+            static inline std::atomic<size_t> _n_virtual_total = 0;
+
+            bool owns_voice(const Emitter&) const;
+            void remove_slot(size_t);
+            size_t get_slot(AudioEmitterID, const std::string& function_name) const;
+    };
+}
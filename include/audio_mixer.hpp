@@ -0,0 +1,199 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <unordered_map>
+
+#include <include/audio_command_queue.hpp>
+#include <include/sound.hpp>
+#include <include/streaming_sound.hpp>
+#include <include/sound_handler.hpp>
+#include <include/time.hpp>
+
+struct Mix_Chunk;
+
+namespace ts
+{
+    /// \brief submix bus, c.f. ts::AudioMixer
+    enum class AudioBus : uint8_t
+    {
+        /// \brief sound effects, default for all sounds
+        SFX = 0,
+
+        /// \brief user interface sounds
+        UI = 1,
+
+        /// \brief ambience and environmental loops
+        AMBIENCE = 2,
+
+        /// \brief the track played by ts::MusicHandler
+        MUSIC = 3
+    };
+
+    namespace detail
+    {
+        // state of a channel as seen by the mixer, only accessed while holding the audio device lock
+        struct MixerChannel
+        {
+            AudioBus bus = AudioBus::SFX;
+            Mix_Chunk* chunk = nullptr;
+            bool is_registered = false; // SDL_mixer removes effects when a channel finishes
+
+            // as passed to Mix_SetPosition, such that it can be restored once the mixer is disabled
+            float angle = 0;
+            uint8_t distance = 0;
+            float gain_left = 1;
+            float gain_right = 1;
+
+            size_t generation = 0; // callback the offset belongs to
+            size_t offset = 0;     // in samples, SDL_mixer hands over a looping chunk in pieces
+        };
+
+        struct MixerBus
+        {
+            float gain = 1;
+            float target_gain = 1;
+            float gain_per_frame = 0; // ramp speed
+            float cutoff_hz = 0;
+            float low_pass = 1;       // one-pole coefficient, 1 if disabled
+            std::array<float, 2> filter_state = {0, 0};
+            bool is_used = false;     // anything was mixed into it this callback
+        };
+    }
+
+    /// \brief optional software mixer that routes sounds and music through submix buses with per-bus volume ramps, low-pass filters and a master limiter
+    class AudioMixer
+    {
+        public:
+            /// \brief number of submix buses
+            static inline constexpr size_t n_buses = 4;
+
+            /// \brief maximum number of stereo frames per audio callback, larger buffers bypass the mixer
+            static inline constexpr size_t max_n_frames = 8192;
+
+            /// \brief route all channels through the mixer, takes effect at the end of the frame. Requires the device to be opened by ts::AudioDevice with 16-bit stereo output
+            static void enable();
+
+            /// \brief return to SDL_mixers default mixing, takes effect at the end of the frame
+            static void disable();
+
+            /// \brief is the mixer enabled
+            /// \returns true if ts::AudioMixer::enable was called last, false otherwise
+            static bool is_enabled();
+
+            /// \brief set the bus a sound is mixed into, applies to all plays issued after this call
+            /// \param sound: sound
+            /// \param bus: bus, ts::AudioBus::SFX by default
+            static void set_bus(const Sound&, AudioBus);
+
+            /// \brief get the bus a sound is mixed into
+            /// \param sound: sound
+            /// \returns bus
+            static AudioBus get_bus(const Sound&);
+
+            /// \brief set the bus a streamed sound is mixed into, applies to all plays issued after this call
+            /// \param sound: streamed sound
+            /// \param bus: bus, ts::AudioBus::SFX by default
+            static void set_bus(const StreamingSound&, AudioBus);
+
+            /// \brief get the bus a streamed sound is mixed into
+            /// \param sound: streamed sound
+            /// \returns bus
+            static AudioBus get_bus(const StreamingSound&);
+
+            /// \brief set the volume of a bus, e.g. to duck music while dialog is playing
+            /// \param bus: bus
+            /// \param zero_to_one: volume, clamped to [0, 1]
+            /// \param ramp_duration: time over which the volume changes from its current value, the change is never instant to avoid clicks
+            static void set_bus_volume(AudioBus, float zero_to_one, Time ramp_duration = milliseconds(20));
+
+            /// \brief get the volume of a bus as of the last call to ts::AudioMixer::set_bus_volume
+            /// \param bus: bus
+            /// \returns volume in [0, 1]
+            static float get_bus_volume(AudioBus);
+
+            /// \brief filter high frequencies out of a bus, e.g. for sounds heard through a wall
+            /// \param bus: bus
+            /// \param cutoff_hz: cutoff frequency of the one-pole low-pass filter, or 0 to disable the filter
+            static void set_bus_low_pass(AudioBus, float cutoff_hz);
+
+            /// \brief set the peak level above which the master output is turned down instead of clipping
+            /// \param zero_to_one: threshold, relative to full scale
+            static void set_limiter_threshold(float zero_to_one);
+
+            /// \brief get the duration of audio one callback has to produce, the mixer has to stay well below this
+            /// \returns duration of one buffer, or 0 if the audio device is not open
+            static Time get_callback_budget();
+
+            /// \brief get the time spent in the mixer during the last audio callback
+            /// \returns duration
+            static Time get_last_callback_duration();
+
+            /// \brief get the average time spent in the mixer per audio callback since the last reset
+            /// \returns duration
+            static Time get_average_callback_duration();
+
+            /// \brief get the longest time spent in the mixer during one audio callback since the last reset
+            /// \returns duration
+            static Time get_max_callback_duration();
+
+            /// \brief get the number of audio callbacks since the last reset
+            /// \returns number of callbacks
+            static size_t get_n_callbacks();
+
+            /// \brief reset callback statistics
+            static void reset_callback_statistics();
+
+        private:
+            friend class SoundHandler;
+            friend class AudioDevice;
+            friend class detail::AudioCommandQueue;
+
+            // game thread
+            static inline std::atomic<bool> _is_enabled = false;
+            static inline detail::SpinLock _bus_lock;
+            static inline std::unordered_map<size_t, AudioBus> _sound_to_bus;
+            static inline std::array<std::atomic<float>, n_buses> _bus_volume = {1, 1, 1, 1};
+
+            // applied by ts::detail::AudioCommandQueue, while holding the audio device lock
+            static void apply_enable();
+            static void apply_disable();
+            static void on_play(size_t channel, Mix_Chunk*, AudioBus);
+            static void set_channel_position(size_t channel, float angle_degrees, uint8_t distance);
+            static void apply_bus_volume(AudioBus, float zero_to_one, int32_t ramp_ms);
+            static void apply_bus_low_pass(AudioBus, float cutoff_hz);
+            static void apply_limiter_threshold(float);
+
+            // audio thread
+            static void on_channel_effect(int channel, void* stream, int length, void*);
+            static void on_channel_effect_done(int channel, void*);
+            static void begin_callback();
+            static void on_post_mix(void*, uint8_t* stream, int length);
+
+            static inline bool _is_active = false; // as seen by the audio thread
+            static inline std::atomic<int> _frequency = 0;
+            static inline size_t _generation = 1;
+            static inline bool _callback_started = false;
+            static inline uint64_t _callback_start_ns = 0;
+
+            static inline std::array<detail::MixerChannel, SoundHandler::n_channels> _channels = {};
+            static inline std::array<detail::MixerBus, n_buses> _buses = {};
+            alignas(16) static inline std::array<std::array<float, 2 * max_n_frames>, n_buses> _bus_buffers = {};
+            alignas(16) static inline std::array<float, 2 * max_n_frames> _master = {};
+
+            static inline float _limiter_threshold = 0.98;
+            static inline float _limiter_gain = 1;
+
+            // statistics, written by the audio thread
+            static inline std::atomic<uint64_t> _last_ns = 0;
+            static inline std::atomic<uint64_t> _max_ns = 0;
+            static inline std::atomic<uint64_t> _total_ns = 0;
+            static inline std::atomic<size_t> _n_callbacks = 0;
+            static inline std::atomic<size_t> _n_frames_per_callback = 0;
+    };
+}
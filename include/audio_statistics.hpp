@@ -0,0 +1,127 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <include/audio_command_queue.hpp>
+#include <include/time.hpp>
+
+namespace ts
+{
+    /// \brief state of the audio engine during one frame, c.f. ts::AudioStatistics
+    struct AudioFrameStatistics
+    {
+        /// \brief index of the frame, counted from the first call to ts::AudioStatistics::update
+        size_t frame = 0;
+
+        /// \brief time since the previous frame
+        Time frame_duration = nanoseconds(0);
+
+        /// \brief number of channels playing a sound at the end of the frame, including paused channels
+        size_t n_active_voices = 0;
+
+        /// \brief number of emitters of all ts::AudioEmitterSystem instances that are out of range or did not get a channel
+        size_t n_virtual_voices = 0;
+
+        /// \brief number of voices cut off by ts::SoundHandler::play during the frame
+        size_t n_stolen_voices = 0;
+
+        /// \brief is ts::MusicHandler or ts::MusicPlaylist playing
+        bool is_music_playing = false;
+
+        /// \brief number of audio commands applied during the frame
+        size_t n_commands = 0;
+
+        /// \brief number of buffers the audio thread mixed during the frame
+        size_t n_callbacks = 0;
+
+        /// \brief smallest cpu time the audio thread spent on one buffer during the frame
+        Time min_callback_duration = nanoseconds(0);
+
+        /// \brief average cpu time the audio thread spent on one buffer during the frame
+        Time average_callback_duration = nanoseconds(0);
+
+        /// \brief largest cpu time the audio thread spent on one buffer during the frame
+        Time max_callback_duration = nanoseconds(0);
+
+        /// \brief duration of the audio in one buffer, a callback that takes longer can not keep up
+        Time callback_budget = nanoseconds(0);
+
+        /// \brief number of buffers during the frame that started late, such that the device likely ran out of samples
+        size_t n_underruns = 0;
+    };
+
+    namespace detail
+    {
+        // callback timings since the last frame, written by the audio thread
+        struct CallbackWindow
+        {
+            uint64_t min_ns = uint64_t(-1);
+            uint64_t max_ns = 0;
+            uint64_t total_ns = 0;
+            size_t n_callbacks = 0;
+            size_t n_late = 0;
+            uint64_t budget_ns = 0;
+        };
+    }
+
+    /// \brief per-frame statistics of the audio engine, collected from ts::SoundHandler, ts::MusicHandler and the audio thread
+    class AudioStatistics
+    {
+        public:
+            /// \brief number of frames kept, 10 seconds at 60 fps
+            static inline constexpr size_t history_size = 600;
+
+            /// \brief close the current frame and record its statistics. Called by ts::end_frame, only needs to be called manually if ts::end_frame is not used
+            static void update();
+
+            /// \brief get the statistics of the last frame recorded
+            /// \returns object of type ts::AudioFrameStatistics
+            static AudioFrameStatistics get_last_frame();
+
+            /// \brief get the statistics of the last ts::AudioStatistics::history_size frames
+            /// \returns vector, oldest frame first
+            static std::vector<AudioFrameStatistics> get_history();
+
+            /// \brief get the number of buffers that started late since the last reset
+            /// \returns number of underruns
+            static size_t get_n_underruns();
+
+            /// \brief clear the history and all counters
+            static void reset();
+
+            /// \brief write the history as comma-separated values, one line per frame
+            /// \param path: absolute path of the file, overwritten if it exists
+            /// \returns true if successful, false otherwise
+            static bool export_csv(const std::string& path);
+
+        private:
+            friend class AudioDevice;
+            friend class detail::AudioCommandQueue;
+
+            // game thread
+            static void on_commands_applied(size_t n);
+
+            // audio thread, once per buffer
+            static void on_callback(uint64_t cpu_ns, uint64_t budget_ns, bool is_late);
+
+            static inline detail::SpinLock _window_lock;
+            static inline detail::CallbackWindow _window;
+            static inline std::atomic<size_t> _n_commands = 0;
+
+            static inline std::mutex _history_lock;
+            static inline std::array<AudioFrameStatistics, history_size> _history = {};
+            static inline size_t _n_frames = 0;
+            static inline size_t _n_underruns = 0;
+            static inline size_t _last_n_stolen = 0;
+            static inline Clock _frame_clock;
+    };
+}
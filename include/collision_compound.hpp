@@ -0,0 +1,74 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+
+#include <include/collision_shape.hpp>
+
+namespace ts
+{
+    /// \brief collision shape: arbitrary simple polygon, may be concave. Internally decomposed into convex pieces that are all part of the same body
+    class CollisionCompound : public CollisionShape
+    {
+        public:
+            // no docs
+            virtual ~CollisionCompound() = default;
+
+            /// \brief construct from the outline of a polygon
+            /// \param world: physics world
+            /// \param type: collision type of object
+            /// \param vertices: world vertex positions, in order along the outline. The outline may not intersect itself
+            CollisionCompound(PhysicsWorld* world, CollisionType type, const std::vector<Vector2f>& vertices);
+
+            /// \brief get the convex pieces the polygon was decomposed into
+            /// \returns vector of polygons, world coordinates at the time of construction
+            std::vector<std::vector<Vector2f>> get_pieces() const;
+
+            /// \brief get the number of convex pieces, each piece is one fixture of the same body
+            /// \returns number of pieces
+            size_t get_n_pieces() const;
+
+            /// \brief decompose a simple polygon into convex polygons of at most 8 vertices each, results are cached
+            /// \param vertices: vertex positions, in order along the outline
+            /// \returns vector of convex polygons, each given by its vertex positions in counter-clockwise order
+            static std::vector<std::vector<Vector2f>> decompose(const std::vector<Vector2f>& vertices);
+
+            /// \brief clear the cache of previously computed decompositions
+            static void clear_decomposition_cache();
+
+            /// \brief maximum number of outlines whose decomposition is cached, once reached, an older entry is replaced
+            static inline constexpr size_t decomposition_cache_capacity = 1024;
+
+        protected:
+            // first piece only, queries of ts::PhysicsWorld consider all fixtures of the body
+            b2Shape* get_native_shape() override;
+
+        private:
+            std::vector<b2Fixture*> _subsequent_fixtures;
+            void on_fixtures_moved(const FixtureMap&) override;
+
+            std::vector<b2PolygonShape> _shapes;
+
+            Vector2f _center;
+            std::vector<std::vector<Vector2f>> _pieces; // local coordinates
+
+            static std::vector<std::vector<Vector2f>> decompose_local(const std::vector<Vector2f>&);
+            static std::vector<std::vector<Vector2f>> decompose_uncached(std::vector<Vector2f>);
+
+            // decompositions are cached by the hash of the outline relative to its mean, such that
+            // translated copies of the same outline share a decomposition
+            struct CacheEntry
+            {
+                std::vector<Vector2f> outline;
+                std::vector<std::vector<Vector2f>> pieces;
+            };
+
+            static inline std::unordered_map<size_t, CacheEntry> _decomposition_cache = {};
+            static inline std::mutex _cache_lock = std::mutex();
+    };
+}
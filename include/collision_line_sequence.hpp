@@ -19,14 +19,40 @@ namespace ts
             /// \param a: first point of the line
             /// \param b: second point of the line
             /// \param two_sided: should collision happend from both sides of the line. If false, collision only happens on the outer, clockwise side of the line
+            /// \param simplification_tolerance: if larger than 0, the vertices are simplified before the lines are created, c.f. ts::CollisionLineSequence::simplify
             /// \note Lines can only be ts::STATIC or ts::KINEMATIC. If ts::DYNAMIC is provided as the ts::CollisionType, a weak warning is issued
-            CollisionLineSequence(PhysicsWorld* world, CollisionType type, const std::vector<Vector2f>&, bool two_sided = true);
+            /// \note one-sided sequences are simulated as a single box2d chain, two-sided sequences as one edge per line. A one-sided sequence whose last vertex is equal to its first is closed and simulated as a loop. Vertices of a one-sided sequence that are too close to their predecessor for box2d are removed with a warning, ts::CollisionLineSequence::get_vertices reports the vertices that are simulated
+            CollisionLineSequence(PhysicsWorld* world, CollisionType type, const std::vector<Vector2f>&, bool two_sided = true, float simplification_tolerance = 0);
+
+            /// \brief get the vertices the lines were created from, after simplification and after removing vertices box2d does not support
+            /// \returns vector of world coordinates, at the time of construction
+            const std::vector<Vector2f>& get_vertices() const;
+
+            /// \brief get the number of lines
+            /// \returns number of lines
+            size_t get_n_edges() const;
+
+            /// \brief simplify a polyline: removes duplicate and collinear vertices, then removes all vertices that are closer than the tolerance to the line between their neighbors (Ramer-Douglas-Peucker). The first and last vertex are always kept
+            /// \param vertices: vertex positions, in order
+            /// \param tolerance: maximum distance between the original and the simplified polyline, in world units
+            /// \returns simplified vertices
+            static std::vector<Vector2f> simplify(const std::vector<Vector2f>& vertices, float tolerance);
+
+            /// \brief join polylines where the last vertex of one is equal to the first vertex of another, such that adjacent sequences can be simulated as a single chain
+            /// \param sequences: polylines
+            /// \param tolerance: maximum distance between two vertices that are considered equal, in world units
+            /// \returns joined polylines, direction of each input polyline is preserved. If the ends of a joined polyline are considered equal, its last vertex is set to its first, such that it is closed
+            static std::vector<std::vector<Vector2f>> join(const std::vector<std::vector<Vector2f>>& sequences, float tolerance = 0.01);
 
         protected:
             b2Shape* get_native_shape() override;
 
             std::vector<b2Fixture*> _subsequent_fixtures;
+
+            void on_fixtures_moved(const FixtureMap&) override;
         private:
             b2EdgeShape _shape;
+            std::vector<Vector2f> _vertices;
+            size_t _n_edges = 0;
     };
 }
\ No newline at end of file
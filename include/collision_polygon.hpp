@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include <include/collision_shape.hpp>
 
 namespace ts
@@ -17,7 +19,7 @@ namespace ts
             virtual ~CollisionPolygon() = default;
 
             /// \brief construct from list of vertices
-            /// \param vertices: vector of world vertex positions
+            /// \param vertices: vector of world vertex positions, at most 8. For concave or larger polygons, use ts::CollisionCompound
             CollisionPolygon(PhysicsWorld*, CollisionType, const std::vector<Vector2f>&);
 
             /// \brief construct from ts::TriangleShape
@@ -44,6 +46,61 @@ namespace ts
             b2Shape* get_native_shape() override;
 
         private:
+            friend class PhysicsWorld;
+
+            // used by ts::PhysicsWorld::create_polygons, shape is already in native, local coordinates
+            CollisionPolygon(PhysicsWorld*, CollisionType, Vector2f center, const b2PolygonShape& shape);
+
             b2PolygonShape _shape;
     };
+
+    /// \brief polygons created by ts::PhysicsWorld::create_polygons, stored contiguously in a single allocation. Shapes keep their address for the lifetime of the batch, moving the batch does not move the shapes
+    class CollisionPolygonBatch
+    {
+        public:
+            /// \brief construct empty
+            CollisionPolygonBatch() = default;
+
+            /// \brief destruct, deallocates the shapes. Like any ts::CollisionShape, their bodies have to be destroyed with ts::CollisionShape::destroy before, c.f. ts::CollisionPolygonBatch::destroy
+            ~CollisionPolygonBatch();
+
+            // no docs
+            CollisionPolygonBatch(CollisionPolygonBatch&&) noexcept;
+            CollisionPolygonBatch& operator=(CollisionPolygonBatch&&) noexcept;
+            CollisionPolygonBatch(const CollisionPolygonBatch&) = delete;
+            CollisionPolygonBatch& operator=(const CollisionPolygonBatch&) = delete;
+
+            /// \brief destroy the bodies of all shapes, c.f. ts::CollisionShape::destroy
+            void destroy();
+
+            /// \brief get the number of shapes
+            /// \returns number of shapes
+            size_t size() const;
+
+            /// \brief access a shape
+            /// \param index: index of the shape, in the order of the descriptions it was created from
+            /// \returns reference to shape
+            CollisionPolygon& operator[](size_t index);
+
+            /// \brief access a shape
+            /// \param index: index of the shape, in the order of the descriptions it was created from
+            /// \returns const reference to shape
+            const CollisionPolygon& operator[](size_t index) const;
+
+            // no docs, iteration
+            CollisionPolygon* begin();
+            CollisionPolygon* end();
+            const CollisionPolygon* begin() const;
+            const CollisionPolygon* end() const;
+
+        private:
+            friend class PhysicsWorld;
+
+            // allocates storage for n shapes, they are constructed in place by ts::PhysicsWorld::create_polygons
+            explicit CollisionPolygonBatch(size_t capacity);
+
+            CollisionPolygon* _data = nullptr;
+            size_t _size = 0;
+            size_t _capacity = 0;
+    };
 }
\ No newline at end of file
@@ -10,17 +10,32 @@
 #include <include/collision_line_sequence.hpp>
 #include <include/collision_polygon.hpp>
 #include <include/collision_circle.hpp>
+#include <include/polyline_shape.hpp>
 
 namespace ts
 {
     /// \brief renderable collision shape
     struct CollisionRenderShape
     {
-        /// \brief synchronize the hitbox and render shape
+        /// \brief synchronize the hitbox and render shape. Does nothing if the body did not move since the last call
         virtual void update() = 0;
 
+        /// \brief synchronize all render shapes in the world whose body was awake during the last step, c.f. ts::PhysicsWorld::get_awake_shapes. Sleeping bodies do not move, so this is equivalent to calling ts::CollisionRenderShape::update on all render shapes, while only costing as much as the number of awake bodies
+        /// \param world: physics world
+        /// \note shapes whose native box2d body was moved directly while asleep are not included, call ts::CollisionRenderShape::update on them manually
+        static void update_awake(PhysicsWorld*);
+
         protected:
             Angle _rotation = degrees(0);
+
+            /// \brief check whether the body moved since the last sync, updates the last synced transform
+            /// \param body: native body
+            /// \returns true if the render shape needs to be updated, false otherwise
+            bool should_update(const b2Body*);
+
+        private:
+            b2Transform _last_transform;
+            bool _is_synced = false;
     };
 
     /// \brief triangle shape with identically sized hitbox
@@ -125,19 +140,21 @@ namespace ts
             /// \param type: collision type
             /// \param vertex_positions: positions of vertices
             /// \param is_two_sided
-            CollisionLineSequenceShape(PhysicsWorld*, CollisionType, const std::vector<Vector2f>&, bool is_two_sided = true);
+            /// \param simplification_tolerance: if larger than 0, the vertices are simplified before the lines are created, c.f. ts::CollisionLineSequence::simplify
+            CollisionLineSequenceShape(PhysicsWorld*, CollisionType, const std::vector<Vector2f>&, bool is_two_sided = true, float simplification_tolerance = 0);
 
             /// \brief synchronize the position of the shape with that of the hitbox
             void update() override;
 
-            /// \brief expose render shapes
-            /// \returns shapes
-            std::vector<RectangleShape>& get_shapes();
+            /// \brief expose render shape, all lines are drawn as a single ts::PolylineShape
+            /// \returns polyline
+            PolylineShape& get_polyline();
 
         protected:
             void render(RenderTarget *target, Transform transform) const;
 
         private:
-            std::vector<RectangleShape> _lines;
+            PolylineShape _polyline;
+            Vector2f _initial_origin;
     };
 }
\ No newline at end of file
@@ -27,6 +27,8 @@ namespace ts
 {
     class PhysicsWorld;
     class CollisionHandler;
+    template<typename> class CollisionShapePool;
+    class RegionedPhysicsWorld;
     namespace detail { struct ContactListener; }
 
     /// \brief collision group index
@@ -107,11 +109,24 @@ namespace ts
         friend class detail::ContactListener;
 
         public:
-            /// \brief destruct, this also deallocates the box2d fixture. The user is responsible for keeping the shape in memory while it is attached to a PhysicsObject
+            /// \brief destruct, this also destroys the box2d body if ts::CollisionShape::destroy was not called before. The world the shape is in has to outlive it, or be destroyed first
             virtual ~CollisionShape();
 
+            /// \brief shapes cannot be copied or moved, the box2d body and the world refer to them by address. Store them in containers that never relocate their elements, such as std::deque or std::vector<std::unique_ptr<...>>
+            CollisionShape(const CollisionShape&) = delete;
+
+            // no docs, c.f. copy ctor
+            CollisionShape(CollisionShape&&) = delete;
+
+            // no docs, c.f. copy ctor
+            CollisionShape& operator=(const CollisionShape&) = delete;
+
+            // no docs, c.f. copy ctor
+            CollisionShape& operator=(CollisionShape&&) = delete;
+
             /// \brief set the density of this shape. This governs mass
             /// \param density
+            /// \note for shapes consisting of more than one fixture, such as ts::CollisionCompound, this and all other fixture properties apply to all fixtures
             void set_density(float);
 
             /// \brief access the density of this shape
@@ -134,7 +149,15 @@ namespace ts
             /// \returns restitution
             float get_restitution() const;
 
-            /// \brief compute the axis-aligned bounding box of the shape
+            /// \brief make the shape a sensor. Sensors detect overlap but do not collide, no contact forces are computed for them. c.f. ts::PhysicsWorld::add_trigger
+            /// \param value: true if the shape should be a sensor, false otherwise
+            void set_is_sensor(bool);
+
+            /// \brief is the shape a sensor
+            /// \returns true if sensor, false otherwise
+            bool get_is_sensor() const;
+
+            /// \brief compute the axis-aligned bounding box of the shape, including all of its fixtures
             /// \returns rectangle that is the bounding box
             Rectangle get_bounding_box() const;
 
@@ -271,7 +294,7 @@ namespace ts
                 const std::vector<CollisionFilterGroup>& does_not_collide_with_group,
                 const std::vector<CollisionFilterGroup>& is_in_group);
 
-            /// \brief deallocate the hitbox, this permanently removes it from the simulation
+            /// \brief deallocate the hitbox, this permanently removes it from the simulation. Calling this more than once has no effect. Called by the destructor, if it was not called before
             void destroy();
 
         private:
@@ -279,12 +302,24 @@ namespace ts
             friend class CollisionPolygon;
             friend class CollisionLine;
             friend class CollisionLineSequence;
+            friend class CollisionCompound;
+            template<typename> friend class CollisionShapePool;
+            friend class RegionedPhysicsWorld;
+            friend class PhysicsWorld;
                 // sic, exposing private members like this prevents users from subclassing this class
                 // while still giving the ts-defined subclasses access to would-be protected members
 
             CollisionShape(PhysicsWorld*, CollisionType, Vector2f initial_center);
 
             b2FixtureDef create_fixture_def(b2Shape* shape) const;
+            b2AABB compute_aabb() const; // union of all fixtures
+
+            // recreate the body with identical state and fixtures in another world, then destroy the old body
+            void move_to(PhysicsWorld*);
+
+            // called by move_to, such that subclasses can update the fixture pointers they hold
+            using FixtureMap = std::vector<std::pair<b2Fixture*, b2Fixture*>>; // old, new
+            virtual void on_fixtures_moved(const FixtureMap&) {}
 
             // which collision group does this fixture belong to
             uint16_t _is_in_collision_group_bits = (uint16_t) CollisionFilterGroup::_01;
@@ -295,6 +330,12 @@ namespace ts
             PhysicsWorld* _world;
             bool _was_destroyed = false;
 
+            // position in the awake lists of the world, c.f. ts::PhysicsWorld::update_awake_shapes
+            size_t _awake_epoch = 0;
+            size_t _awake_shape_index = -1;
+            size_t _awake_body_index = -1;
+            size_t _woken_index = -1;
+
             b2Body* _body;
             b2Fixture* _fixture;
 
@@ -0,0 +1,121 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <functional>
+#include <type_traits>
+
+#include <include/collision_shape.hpp>
+#include <include/physics_world.hpp>
+#include <include/angle.hpp>
+
+namespace ts
+{
+    /// \brief handle to a shape owned by a ts::CollisionShapePool. A handle becomes invalid once its shape is released, even if the shape is later handed out again
+    struct CollisionShapeHandle
+    {
+        /// \brief index of the slot in the pool
+        uint32_t index = uint32_t(-1);
+
+        /// \brief generation of the slot at the time the handle was created
+        uint32_t generation = 0;
+
+        /// \brief compare two handles
+        /// \param other: other handle
+        /// \returns true if both handles refer to the same shape, false otherwise
+        bool operator==(const CollisionShapeHandle& other) const
+        {
+            return index == other.index and generation == other.generation;
+        }
+    };
+
+    /// \brief pool of collision shapes of the same type and size, for objects that are spawned and despawned frequently, such as projectiles. Released shapes are disabled and kept in the world, acquiring one re-enables it instead of allocating a new body
+    /// \tparam Shape_t: shape type, has to inherit from ts::CollisionShape
+    template<typename Shape_t>
+    class CollisionShapePool
+    {
+        static_assert(std::is_base_of_v<CollisionShape, Shape_t>, "In ts::CollisionShapePool: Shape_t has to inherit from ts::CollisionShape");
+
+        public:
+            /// \brief function creating a new shape, only invoked if the pool has no shapes left to recycle
+            using Factory = std::function<std::unique_ptr<Shape_t>(PhysicsWorld*)>;
+
+            /// \brief construct
+            /// \param world: world all shapes are created in
+            /// \param factory: function creating a new shape in the given world
+            CollisionShapePool(PhysicsWorld* world, Factory factory);
+
+            /// \brief destruct, destroys the bodies of all shapes. The pool has to be destroyed before its world
+            ~CollisionShapePool();
+
+            /// \brief hand out a shape, recycling a released one if possible
+            /// \param origin: new origin of the shape, c.f. ts::CollisionShape::get_origin
+            /// \param angle: new rotation of the shape
+            /// \param linear_velocity: new linear velocity of the shape
+            /// \returns handle to the shape
+            CollisionShapeHandle acquire(Vector2f origin, Angle angle = degrees(0), Vector2f linear_velocity = Vector2f(0, 0));
+
+            /// \brief return a shape to the pool, it is disabled and removed from the simulation until it is handed out again. All collision callbacks registered for the shape are removed, and if it was a trigger, it is no longer tracked and no longer a sensor
+            /// \param handle: handle returned by ts::CollisionShapePool::acquire
+            /// \returns true if the handle was valid, false otherwise
+            bool release(CollisionShapeHandle);
+
+            /// \brief access the shape a handle refers to
+            /// \param handle: handle
+            /// \returns pointer to shape, or nullptr if the handle is no longer valid
+            Shape_t* get(CollisionShapeHandle) const;
+
+            /// \brief check whether a handle still refers to an acquired shape
+            /// \param handle: handle
+            /// \returns true if valid, false otherwise
+            bool is_valid(CollisionShapeHandle) const;
+
+            /// \brief create shapes ahead of time, such that the next acquisitions do not need to allocate
+            /// \param n_pooled: number of released shapes the pool should hold
+            void reserve(size_t n_pooled);
+
+            /// \brief destroy released shapes until at most the given number remain
+            /// \param n_pooled: maximum number of released shapes
+            void shrink_to(size_t n_pooled);
+
+            /// \brief destroy all shapes, released or not. Handles of shapes that were still acquired become invalid and are counted as leaked
+            void clear();
+
+            /// \brief get the number of shapes that are currently acquired
+            /// \returns number of shapes
+            size_t get_n_live() const;
+
+            /// \brief get the number of released shapes that are waiting to be recycled
+            /// \returns number of shapes
+            size_t get_n_pooled() const;
+
+            /// \brief get the number of handles that were never released: shapes that were still acquired when the pool was cleared or destroyed. Acquired shapes, including hidden ones, are not counted until then
+            /// \returns number of shapes
+            size_t get_n_leaked() const;
+
+        private:
+            PhysicsWorld* _world;
+            Factory _factory;
+
+            struct Slot
+            {
+                std::unique_ptr<Shape_t> shape;
+                uint32_t generation = 0;
+                bool is_live = false;
+            };
+
+            std::vector<Slot> _slots;
+            std::vector<uint32_t> _free; // indices of released slots, the shape may have been destroyed by shrink_to
+
+            size_t _n_live = 0;
+            size_t _n_pooled = 0;
+            size_t _n_leaked_on_clear = 0;
+    };
+}
+
+#include <src/collision_shape_pool.inl>
@@ -7,12 +7,14 @@
 
 #include <include/window.hpp>
 #include <include/time.hpp>
+#include <include/audio_device.hpp>
 
 namespace ts
 {
     /// \brief initialize all components of telescope
+    /// \param audio: configuration of the audio device, c.f. ts::AudioDevice
     /// \returns true if successfull, otherwise an exception will be thrown and false is returned
-    [[nodiscard]] bool initialize();
+    [[nodiscard]] bool initialize(AudioConfig audio = AudioConfig());
 
     /// \brief set the fps limit for all windows
     /// \param frames_per_second: integer
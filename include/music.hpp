@@ -8,6 +8,8 @@
 #include <SDL2/SDL_mixer.h>
 
 #include <string>
+#include <mutex>
+#include <unordered_set>
 
 #include <include/time.hpp>
 
@@ -32,7 +34,7 @@ namespace ts
             /// \returns true if load successfully, false otherwise
             bool load(const std::string& path);
 
-            /// \brief deallocate memory
+            /// \brief deallocate memory. Audio commands issued so far are applied first, such that they do not refer to freed music
             void unload();
 
             /// \brief get internal id
@@ -45,8 +47,15 @@ namespace ts
 
         private:
             friend class MusicHandler;
+            friend class AudioDevice;
 
             size_t _id;
             Mix_Music* _music;
+            std::string _path;
+
+            // all loaded music, such that it can be opened again when the output format changes
+            static void reload_all();
+            static inline std::mutex _loaded_lock;
+            static inline std::unordered_set<Music*> _loaded;
     };
 }
\ No newline at end of file
@@ -5,15 +5,14 @@
 
 #pragma once
 
-#include <mutex>
+#include <atomic>
 
+#include <include/audio_command_queue.hpp>
 #include <include/music.hpp>
 
 namespace ts
 {
-    namespace detail { union MusicFunctionHook; }
-
-    /// \brief manage music playback. Unlike sounds, only one music track can be active at the same time
+    /// \brief manage music playback. Unlike sounds, only one music track can be active at the same time. Like ts::SoundHandler, commands are queued and applied by ts::flush_audio_commands
     class MusicHandler
     {
         public:
@@ -82,14 +81,26 @@ namespace ts
             static double get_volume();
 
         private:
-            friend union detail::MusicFunctionHook;
+            friend class detail::AudioCommandQueue;
 
-            static inline double _volume = 1;
-            static inline Music* _active = nullptr;
-            static inline Music* _next = nullptr;
+            static void push_play(Music&, bool should_loop, Time fade_in_duration);
 
-            static inline std::mutex _lock = std::mutex();
-    };
-}
+            // invoked by SDL_mixer on the audio thread, only sets a flag because SDL_mixer may not be called from there
+            static void on_music_finished();
+
+            // called by the audio command queue after applying all commands, starts the next track if the current one finished
+            // returns true if it issued any commands
+            static bool update();
 
-#include <src/music.inl>
\ No newline at end of file
+            static inline std::atomic<double> _volume = 1;
+            static inline std::atomic<bool> _is_paused = false;
+            static inline std::atomic<Music*> _active = nullptr;
+
+            static inline std::atomic<Music*> _next = nullptr;
+            static inline std::atomic<bool> _next_should_loop = false;
+            static inline std::atomic<int32_t> _next_fade_in_ms = 0;
+
+            static inline std::atomic<bool> _music_finished = false;
+            static inline bool _hook_registered = false; // only accessed while flushing
+    };
+}
\ No newline at end of file
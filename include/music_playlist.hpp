@@ -0,0 +1,151 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <include/audio_command_queue.hpp>
+#include <include/time.hpp>
+
+struct Mix_Chunk;
+
+namespace ts
+{
+    namespace detail
+    {
+        // fully decoded track, in the output format of the audio device
+        struct PlaylistTrack
+        {
+            Mix_Chunk* chunk = nullptr;
+            const int16_t* samples = nullptr; // interleaved stereo
+            size_t n_frames = 0;
+            size_t n_crossfade_frames = 0;    // overlap with the previous track
+            size_t index = 0;                 // in the playlist
+            size_t generation = 0;            // tracks decoded before the playlist was stopped are discarded
+        };
+
+        // decodes one track at a time, joined before the next one is started
+        struct PlaylistLoader
+        {
+            ~PlaylistLoader();
+
+            std::thread thread;
+            std::atomic<bool> is_done = false;
+            PlaylistTrack* result = nullptr;
+            bool is_running = false;
+        };
+    }
+
+    /// \brief list of music tracks that play back to back without gaps, or crossfaded. Unlike ts::MusicHandler, tracks are decoded ahead of time on a worker thread, such that the next track is ready before the current one ends
+    class MusicPlaylist
+    {
+        public:
+            /// \brief append a track, it is decoded shortly before the previous track ends
+            /// \param path: absolute path, supports .wav, .mp3, .ogg, .flac
+            /// \param crossfade: duration over which this track fades in while the previous one fades out, or 0 for a gapless transition
+            static void add(const std::string& path, Time crossfade = seconds(0));
+
+            /// \brief stop playback and remove all tracks
+            static void clear();
+
+            /// \brief start playback from the first track. ts::MusicHandler is stopped, only one of them can play at the same time
+            static void play();
+
+            /// \brief stop playback, the next call to ts::MusicPlaylist::play starts from the first track again
+            static void stop();
+
+            /// \brief cut the current track short and continue with the next one, without a crossfade
+            static void skip();
+
+            /// \brief set whether playback continues with the first track once the last track ended
+            /// \param should_loop: true to loop, false otherwise
+            static void set_should_loop(bool);
+
+            /// \brief get whether playback continues with the first track once the last track ended
+            /// \returns true if looping, false otherwise
+            static bool get_should_loop();
+
+            /// \brief set the volume of the playlist
+            /// \param zero_to_one: volume level, clamped to [0, 1]
+            static void set_volume(float zero_to_one);
+
+            /// \brief get the volume of the playlist
+            /// \returns volume in [0, 1]
+            static float get_volume();
+
+            /// \brief is the playlist playing, true until the last track ended unless looping
+            /// \returns true if playing, false otherwise
+            static bool is_playing();
+
+            /// \brief get the number of tracks
+            /// \returns number of tracks
+            static size_t get_n_tracks();
+
+            /// \brief get the index of the track currently playing
+            /// \returns index in the order tracks were added, or -1 if none is playing
+            static size_t get_current_track();
+
+            /// \brief get the position in the current track
+            /// \returns time since the start of the track
+            static Time get_position();
+
+            /// \brief get the number of transitions that had a gap, because the next track was not decoded in time
+            /// \returns number of gaps since the start of the program
+            static size_t get_n_late_tracks();
+
+        private:
+            friend class detail::AudioCommandQueue;
+
+            struct Entry
+            {
+                std::string path;
+                Time crossfade;
+            };
+
+            // game thread
+            static inline detail::SpinLock _entry_lock;
+            static inline std::vector<Entry> _entries;
+            static inline size_t _prepare_index = 0; // next entry to decode
+            static inline size_t _generation = 0;
+            static inline size_t _n_failed = 0;      // consecutive tracks that could not be decoded
+            static inline detail::PlaylistLoader _loader;
+
+            static void load(Entry, size_t index, size_t generation);
+            static void free_track(detail::PlaylistTrack*);
+
+            // applied by ts::detail::AudioCommandQueue, while holding the audio device lock
+            static void apply_start();
+            static void apply_stop();
+            static void apply_skip();
+            static void update();
+
+            // audio thread, only runs while the audio device lock is not held, so it shares all state below with the functions above
+            static void on_mix(void*, uint8_t* stream, int length);
+            static void retire(detail::PlaylistTrack*);
+
+            static inline bool _is_hooked = false;
+            static inline bool _has_pending = false; // another track will be decoded
+            static inline detail::PlaylistTrack* _current = nullptr;
+            static inline detail::PlaylistTrack* _next = nullptr;
+            static inline size_t _fade_start = -1;
+
+            static inline std::array<detail::PlaylistTrack*, 16> _retired = {};
+            static inline size_t _n_retired = 0;
+
+            // queries
+            static inline std::atomic<bool> _should_loop = false;
+            static inline std::atomic<float> _volume = 1;
+            static inline std::atomic<bool> _is_playing = false;
+            static inline std::atomic<size_t> _current_index = -1;
+            static inline std::atomic<size_t> _position = 0; // in frames
+            static inline std::atomic<int> _frequency = 0;
+            static inline std::atomic<size_t> _n_late = 0;
+    };
+}
@@ -12,5 +12,12 @@
 #include <include/collision_polygon.hpp>
 #include <include/collision_circle.hpp>
 #include <include/collision_line_sequence.hpp>
+#include <include/collision_compound.hpp>
+#include <include/collision_shape_pool.hpp>
+
+#include <include/world_scheduler.hpp>
+#include <include/regioned_physics_world.hpp>
 
 #include <include/collision_render_shape.hpp>
+#include <include/physics_debug_draw.hpp>
+#include <include/alpha_contours.hpp>
@@ -0,0 +1,128 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#pragma once
+
+#include <vector>
+
+#include <box2d/b2_draw.h>
+
+#include <include/renderable.hpp>
+#include <include/color.hpp>
+#include <include/geometric_shapes.hpp>
+
+namespace ts
+{
+    class PhysicsWorld;
+
+    /// \brief debug overlay for a physics world, draws all fixtures, bounding boxes, contacts and joints without needing a render shape for each collision object
+    class PhysicsDebugDraw : public Renderable, protected b2Draw
+    {
+        public:
+            /// \brief parts of the world that can be drawn, can be combined using |
+            enum Category : uint8_t
+            {
+                /// \brief fixtures, colored by state of their body
+                SHAPES = 1 << 0,
+
+                /// \brief axis-aligned bounding boxes of all broadphase proxies
+                AABBS = 1 << 1,
+
+                /// \brief points of all touching contacts, and their normals
+                CONTACTS = 1 << 2,
+
+                /// \brief joints, connecting their anchors
+                JOINTS = 1 << 3,
+
+                /// \brief center of mass and local axes of each body
+                CENTERS_OF_MASS = 1 << 4
+            };
+
+            /// \brief construct
+            /// \param world: physics world to draw
+            /// \param categories: categories that are drawn, c.f. ts::PhysicsDebugDraw::Category
+            PhysicsDebugDraw(PhysicsWorld* world, uint8_t categories = SHAPES | CONTACTS | JOINTS);
+
+            /// \brief collect the current state of the world, should be called once per frame after stepping the world. Only this function walks the world, rendering only submits the collected geometry
+            void update();
+
+            /// \brief enable or disable drawing of a category
+            /// \param category: category
+            /// \param enabled: true to draw the category, false otherwise
+            void set_category_enabled(Category, bool);
+
+            /// \brief check whether a category is drawn
+            /// \param category: category
+            /// \returns true if drawn, false otherwise
+            bool get_category_enabled(Category) const;
+
+            /// \brief only collect geometry that overlaps the given area, usually the area visible to the camera. Reduces the size of the buffer for large worlds, though all fixtures are still visited
+            /// \param area: rectangle, in world coordinates
+            void set_culling_area(Rectangle);
+
+            /// \brief collect geometry regardless of its position
+            void unset_culling_area();
+
+            /// \brief set the width of lines, in pixels
+            /// \param thickness: width
+            void set_line_thickness(float);
+
+            /// \brief set the number of vertices used to approximate a circle
+            /// \param n_vertices: number of vertices on the outer edge, at least 3
+            void set_circle_resolution(size_t);
+
+            /// \brief set the alpha of filled shapes, outlines are always opaque
+            /// \param alpha: in [0, 1]
+            void set_fill_alpha(float);
+
+            /// \brief get the number of vertices collected by the last call to ts::PhysicsDebugDraw::update
+            /// \returns number of vertices
+            size_t get_n_vertices() const;
+
+            /// \brief get the number of triangles collected by the last call to ts::PhysicsDebugDraw::update
+            /// \returns number of triangles
+            size_t get_n_triangles() const;
+
+        protected:
+            /// \copydoc Renderable::render
+            void render(RenderTarget*, Transform) const override;
+
+            // b2Draw, all positions in native coordinates
+            void DrawPolygon(const b2Vec2* vertices, int32 n_vertices, const b2Color& color) override;
+            void DrawSolidPolygon(const b2Vec2* vertices, int32 n_vertices, const b2Color& color) override;
+            void DrawCircle(const b2Vec2& center, float radius, const b2Color& color) override;
+            void DrawSolidCircle(const b2Vec2& center, float radius, const b2Vec2& axis, const b2Color& color) override;
+            void DrawSegment(const b2Vec2& a, const b2Vec2& b, const b2Color& color) override;
+            void DrawTransform(const b2Transform& transform) override;
+            void DrawPoint(const b2Vec2& point, float size, const b2Color& color) override;
+
+        private:
+            PhysicsWorld* _world;
+            uint8_t _categories;
+
+            bool _culling_enabled = false;
+            Rectangle _culling_area;
+
+            float _line_thickness = 1;
+            size_t _circle_resolution = 16;
+            float _fill_alpha = 0.5;
+
+            std::vector<float> _circle_unit; // cos, sin of each vertex of the unit circle
+            std::vector<float> _polygon_scratch;
+
+            // persistent buffers, cleared but not deallocated each update
+            std::vector<float> _local_xy;
+            std::vector<SDL_Color> _colors;
+            std::vector<int> _indices;
+
+            mutable std::vector<float> _xy; // scratch, transformed positions
+
+            bool is_culled(float min_x, float min_y, float max_x, float max_y) const;
+            int push_vertex(float x, float y, SDL_Color);
+            void push_point(float x, float y, float size, SDL_Color);
+            void push_line(float ax, float ay, float bx, float by, SDL_Color);
+            void collect_contacts();
+    };
+}
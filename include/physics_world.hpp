@@ -7,11 +7,17 @@
 
 #include <mutex>
 #include <deque>
+#include <vector>
+#include <array>
+#include <memory>
+#include <functional>
+#include <unordered_map>
 
 #include <box2d/b2_world.h>
 
 #include <include/vector.hpp>
 #include <include/time.hpp>
+#include <include/geometric_shapes.hpp>
 
 #undef b2_maxPolygonVertices
 #define b2_maxPolygonVertices 32
@@ -20,6 +26,10 @@ namespace ts
 {
     class Window;
     class CollisionShape;
+    class CollisionPolygon;
+    class CollisionPolygonBatch;
+    enum CollisionType : size_t;
+    enum class CollisionFilterGroup : uint16_t;
 
     /// \brief object returned by ts::PhysicsWorld::ray_cast
     struct RayCastInformation
@@ -69,6 +79,78 @@ namespace ts
         CollisionShape* shape_b;
     };
 
+    /// \brief function called with a collision event, c.f. ts::PhysicsWorld::add_collision_callback
+    using CollisionCallback = std::function<void(CollisionEvent)>;
+
+    /// \brief id of a registered collision callback, used to remove it
+    using CollisionCallbackID = size_t;
+
+    /// \brief statistics about collision callback dispatch, c.f. ts::PhysicsWorld::get_dispatch_statistics
+    struct CollisionDispatchStatistics
+    {
+        /// \brief number of events that were handed to the dispatcher during the last step
+        size_t n_events_dispatched = 0;
+
+        /// \brief number of callback invocations during the last step
+        size_t n_callbacks_invoked = 0;
+
+        /// \brief time spent dispatching events to callbacks during the last step
+        Time dispatch_duration = nanoseconds(0);
+
+        /// \brief number of events currently waiting in the queue polled by ts::PhysicsWorld::next_event
+        size_t queue_depth = 0;
+
+        /// \brief largest queue depth observed since the world was created
+        size_t max_queue_depth = 0;
+    };
+
+    /// \brief timings and counters of a single ts::PhysicsWorld::step, c.f. ts::PhysicsWorld::get_last_step_profile
+    struct PhysicsStepProfile
+    {
+        /// \brief total duration of the step, as measured by box2d
+        Time step = nanoseconds(0);
+
+        /// \brief time spent updating contacts and calling the narrowphase
+        Time collide = nanoseconds(0);
+
+        /// \brief time spent in the constraint solver, including island construction and integration
+        Time solve = nanoseconds(0);
+
+        /// \brief time spent resolving time of impact events of fast bodies
+        Time solve_toi = nanoseconds(0);
+
+        /// \brief time spent updating the broadphase tree and finding new pairs
+        Time broadphase = nanoseconds(0);
+
+        /// \brief time spent in the worlds contact listener, that is, queueing events
+        Time contact_listener = nanoseconds(0);
+
+        /// \brief time spent invoking collision callbacks after the step
+        Time dispatch = nanoseconds(0);
+
+        /// \brief number of bodies in the world
+        size_t n_bodies = 0;
+
+        /// \brief number of awake bodies in the world
+        size_t n_awake_bodies = 0;
+
+        /// \brief number of contacts, including contacts whose fixtures only have overlapping bounding boxes
+        size_t n_contacts = 0;
+
+        /// \brief number of proxies in the broadphase, one per fixture child
+        size_t n_proxies = 0;
+    };
+
+    /// \brief description of a convex polygon, c.f. ts::PhysicsWorld::create_polygons
+    struct CollisionPolygonDescription
+    {
+        /// \brief vertex positions, in world coordinates. Only the first n_vertices are used
+        std::array<Vector2f, 8> vertices;
+
+        /// \brief number of vertices, in [3, 8]
+        uint8_t n_vertices = 0;
+    };
+
     /// \brief world instance, contains all physics objects. Only objects within the same world can interact
     class PhysicsWorld
     {
@@ -85,19 +167,19 @@ namespace ts
             /// \param position_iterations: iterations, dictate velocity step resolution
             void step(Time timestep, int32_t velocity_iterations = 8, int32_t position_iterations = 3);
 
-            /// \brief get the minimum distance between two shapes in the world
+            /// \brief get the minimum distance between two shapes in the world, over all fixtures of both shapes
             /// \param a: first shape
             /// \param b: second shape
             /// \returns object of type ts::DistanceInformation
             DistanceInformation distance_between(CollisionShape* a, CollisionShape* b);
 
-            /// \brief is a point located inside a shape in the world
+            /// \brief is a point located inside a shape in the world, considering all fixtures of the shape
             /// \param a: shape
             /// \param point: 2d coordinate
             /// \returns true if point is inside shape, false otherwise
             bool is_point_in_shape(CollisionShape* a, Vector2f point);
 
-            /// \brief perform a ray cast at a shape
+            /// \brief perform a ray cast at a shape, reports the earliest hit over all fixtures of the shape
             /// \param a: shape to be cast at
             /// \param ray_start: starting point of the ray
             /// \param ray_end: ending point of the ray
@@ -113,6 +195,110 @@ namespace ts
             /// \brief clear the event queue
             void clear_events();
 
+            /// \brief register a callback that is invoked at the end of ts::PhysicsWorld::step for every event involving a specific shape
+            /// \param shape: shape to listen to, the events `shape_a` will always be this shape
+            /// \param callback: function to invoke
+            /// \returns id of the callback, used to remove it
+            /// \note callbacks are invoked in addition to the event being queued for ts::PhysicsWorld::next_event. Callbacks should not add or remove callbacks themselves
+            CollisionCallbackID add_collision_callback(CollisionShape* shape, CollisionCallback callback);
+
+            /// \brief register a callback that is invoked at the end of ts::PhysicsWorld::step for every event between a shape in group a and a shape in group b
+            /// \param group_a: group of the first shape, the events `shape_a` will always be in this group
+            /// \param group_b: group of the second shape, the events `shape_b` will always be in this group
+            /// \param callback: function to invoke
+            /// \returns id of the callback, used to remove it
+            CollisionCallbackID add_collision_callback(CollisionFilterGroup group_a, CollisionFilterGroup group_b, CollisionCallback callback);
+
+            /// \brief remove a callback, it will not be invoked for any further events. The id may be returned by a later call to ts::PhysicsWorld::add_collision_callback
+            /// \param id: id returned by ts::PhysicsWorld::add_collision_callback
+            void remove_collision_callback(CollisionCallbackID);
+
+            /// \brief remove all callbacks registered for a specific shape, called by ts::CollisionShape when it is destroyed
+            /// \param shape: shape
+            void remove_collision_callbacks(CollisionShape*);
+
+            /// \brief track which shapes overlap a shape, making it a sensor. Contacts of a trigger are not queued as ts::CollisionEvent and invoke no callbacks, instead, overlaps are collected per trigger and reported as sets of entered and exited shapes after each step
+            /// \param shape: shape, shapes overlapping it at the time of registration are part of its overlaps but are not reported as entered
+            void add_trigger(CollisionShape*);
+
+            /// \brief stop tracking the overlaps of a shape, it stays a sensor
+            /// \param shape: shape
+            /// \returns true if the shape was a trigger, false otherwise
+            bool remove_trigger(CollisionShape*);
+
+            /// \brief get all triggers that had shapes enter or exit during the last step
+            /// \returns reference to vector of triggers, valid until the next step
+            const std::vector<CollisionShape*>& get_changed_triggers() const;
+
+            /// \brief get the shapes that started to overlap a trigger during the last step
+            /// \param trigger: shape registered with ts::PhysicsWorld::add_trigger
+            /// \returns reference to vector of shapes, sorted by id, valid until the next step
+            const std::vector<CollisionShape*>& get_trigger_entered(CollisionShape* trigger) const;
+
+            /// \brief get the shapes that stopped overlapping a trigger during the last step, shapes that were destroyed are included
+            /// \param trigger: shape registered with ts::PhysicsWorld::add_trigger
+            /// \returns reference to vector of shapes, sorted by id, valid until the next step
+            const std::vector<CollisionShape*>& get_trigger_exited(CollisionShape* trigger) const;
+
+            /// \brief get all shapes currently overlapping a trigger
+            /// \param trigger: shape registered with ts::PhysicsWorld::add_trigger
+            /// \returns reference to vector of shapes, sorted by id, valid until the next step
+            const std::vector<CollisionShape*>& get_trigger_overlaps(CollisionShape* trigger) const;
+
+            /// \brief create many polygons at once, such as when loading a level. Produces the same shapes as constructing each ts::CollisionPolygon individually, but without allocating any temporary buffers per shape, and with all shapes in a single allocation
+            /// \param type: collision type of all shapes
+            /// \param descriptions: vertices of each polygon
+            /// \returns batch holding the shapes in the order of their descriptions, allocated as one block
+            /// \note if any description has less than 3 or more than 8 vertices, or its vertices span no area because they are collinear or too close to each other, an exception is thrown before any shape is created
+            CollisionPolygonBatch create_polygons(CollisionType type, const std::vector<CollisionPolygonDescription>& descriptions);
+
+            /// \brief create many axis-aligned rectangles at once, c.f. ts::PhysicsWorld::create_polygons
+            /// \param type: collision type of all shapes
+            /// \param rectangles: bounds of each shape, in world coordinates
+            /// \returns batch holding the shapes in the order of the rectangles, allocated as one block
+            CollisionPolygonBatch create_polygons(CollisionType type, const std::vector<Rectangle>& rectangles);
+
+            /// \brief get statistics about the last callback dispatch and the event queue
+            /// \returns object of type ts::CollisionDispatchStatistics
+            CollisionDispatchStatistics get_dispatch_statistics();
+
+            /// \brief get all shapes whose body was awake during the last call to ts::PhysicsWorld::step, including bodies that fell asleep at its end, static bodies are never included. Only these shapes can have moved during the step. Costs as much as the number of awake bodies, not the number of bodies in the world
+            /// \note bodies woken through their native box2d body directly, c.f. ts::CollisionShape::get_native_body, are only included once they touch a body that is
+            /// \returns reference to vector of shapes, valid until the next step
+            const std::vector<CollisionShape*>& get_awake_shapes() const;
+
+            /// \brief get timings and counters of the last call to ts::PhysicsWorld::step
+            /// \returns object of type ts::PhysicsStepProfile
+            PhysicsStepProfile get_last_step_profile() const;
+
+            /// \brief get timings and counters averaged over the last n steps, c.f. ts::PhysicsWorld::set_profile_window_size
+            /// \returns object of type ts::PhysicsStepProfile
+            PhysicsStepProfile get_average_step_profile() const;
+
+            /// \brief get the maximum of each timing and counter over the last n steps, c.f. ts::PhysicsWorld::set_profile_window_size
+            /// \returns object of type ts::PhysicsStepProfile
+            PhysicsStepProfile get_max_step_profile() const;
+
+            /// \brief set the number of steps the average and maximum step profile are computed over, clears all profiles
+            /// \param n_steps: window size, 60 by default
+            void set_profile_window_size(size_t n_steps);
+
+            /// \brief version of the binary format written by ts::PhysicsWorld::snapshot
+            static inline constexpr uint32_t snapshot_version = 2;
+
+            /// \brief write the dynamic state of all bodies (transform, velocities, sleep state) and all contacts into a binary buffer
+            /// \param buffer: [out] buffer, only resized if it is too small. Reusing the same buffer avoids allocation
+            /// \returns number of bytes written
+            size_t snapshot(std::vector<uint8_t>& buffer);
+
+            /// \brief restore the state written by ts::PhysicsWorld::snapshot. Bodies are matched by the id of their shape, bodies not present in the snapshot are left untouched. Clears the event queue and forces applied since the last step
+            /// \param buffer: snapshot
+            /// \returns true if the snapshot was valid, false otherwise
+            /// \note contacts are matched by the ids of both shapes. Contacts present in the snapshot regain their accumulated impulses, all other contacts start from zero, as if they were new
+            /// \note contacts that begin or end because of the restore are not reported: they are not queued as events, invoke no callbacks, and do not appear as entered or exited shapes of a trigger. Trigger overlaps reflect the restored state
+            /// \note the world continues from the restored state, but is not guaranteed to follow the original trajectory exactly: box2d does not expose how long a body has been resting, which decides when it falls asleep, and solves contacts in an order that depends on the history of the world
+            bool restore(const std::vector<uint8_t>& buffer);
+
             /// \brief set all forces in the world to zero
             void clear_forces();
 
@@ -125,6 +311,7 @@ namespace ts
 
             /// \brief access the native box2d world
             /// \returns pointer to world
+            /// \note bodies created on the native world directly are simulated, but their contacts are not reported as ts::CollisionEvent and do not enter triggers
             b2World* get_native();
 
             /// no docs
@@ -140,12 +327,128 @@ namespace ts
             float get_skin_radius() const;
 
         private:
-            static inline b2Vec2 _default_gravity = {0, 0};
+            friend class CollisionShape;
+
+            static inline const b2Vec2 _default_gravity = {0, 0}; // const, worlds share no mutable state
             b2World _world;
 
             std::mutex _queue_lock;
             std::deque<CollisionEvent> _event_queue;
 
+            // collision callbacks, lookup is done by shape id and by collision group bit index,
+            // such that each event only visits the handlers that are actually interested in it
+
+            struct CallbackEntry
+            {
+                CollisionCallbackID id;
+                bool swap_shapes;
+            };
+
+            struct DispatchEntry
+            {
+                CollisionEvent event;
+                size_t id_a, id_b;
+                uint16_t groups_a, groups_b;
+            };
+
+            static inline constexpr size_t _n_groups = 16;
+
+            void dispatch_events();
+            void remove_events(CollisionShape*); // called by ts::CollisionShape::destroy, such that no event refers to the destroyed shape
+            void construct_batch(CollisionPolygonBatch&, const std::function<void(CollisionPolygon*, size_t)>& construct); // used by create_polygons, constructs each shape in place
+            std::vector<CollisionCallback> take_collision_callbacks(CollisionShape*); // unregisters the callbacks of a shape and returns them in order of registration, used by ts::CollisionShape::move_to
+            void invoke_callback(CallbackEntry, const CollisionEvent&, size_t event_index);
+
+            std::vector<CollisionCallback> _callbacks;
+            std::vector<size_t> _callback_last_event; // prevents invoking a callback twice for the same event
+            std::vector<size_t> _callback_shape; // shape id, or 0 for group callbacks
+            std::vector<CollisionCallbackID> _free_callbacks; // slots of removed callbacks
+            CollisionCallbackID allocate_callback(CollisionCallback, size_t shape_id);
+
+            std::unordered_map<size_t, std::vector<CallbackEntry>> _shape_to_callbacks;
+            std::array<std::vector<CallbackEntry>, _n_groups * _n_groups> _group_pair_to_callbacks;
+            size_t _n_shape_callbacks = 0;
+            size_t _n_group_callbacks = 0;
+
+            // snapshot / restore
+
+            struct SnapshotContact
+            {
+                uint64_t id_a, id_b;
+                int32_t child_a, child_b;
+                uint32_t feature_keys[2];
+                float normal_impulses[2];
+                float tangent_impulses[2];
+                uint32_t n_points;
+            };
+
+            std::vector<SnapshotContact> _snapshot_contacts; // scratch, reused
+            std::unordered_map<size_t, CollisionShape*> _id_to_shape; // all shapes in the world, kept up to date by on_shape_created and on_shape_destroyed
+            std::vector<b2Body*> _sleeping_bodies; // scratch, reused
+
+            // awake set, kept up to date without walking the body list: the shapes awake at the end of the last step,
+            // plus those woken through ts::CollisionShape since, are expanded along touching contacts like the solver does
+            void update_awake_shapes();
+            void on_shape_woken(CollisionShape*);     // called by ts::CollisionShape when it creates, wakes or teleports its body
+            void on_shape_created(CollisionShape*);   // called by ts::CollisionShape once its body was created in this world
+            void on_shape_destroyed(CollisionShape*); // called by ts::CollisionShape before its body is destroyed or moved to another world
+
+            std::vector<CollisionShape*> _awake_shapes;  // moved during the last step, including shapes that fell asleep during it
+            std::vector<CollisionShape*> _awake_bodies;  // awake at the end of the last step
+            std::vector<CollisionShape*> _woken_shapes;  // woken since the last step
+            std::vector<CollisionShape*> _awake_stack;   // scratch, reused
+            size_t _awake_epoch = 0;
+            size_t _n_awake_bodies = 0;
+
+            // triggers, overlaps are kept as sorted parallel arrays, such that deltas
+            // of a step can be applied in a single merge without allocating per event
+
+            struct Trigger
+            {
+                CollisionShape* shape;
+                std::vector<size_t> overlap_ids;
+                std::vector<CollisionShape*> overlaps;
+                std::vector<int32_t> overlap_counts; // number of touching fixture pairs
+
+                std::vector<CollisionShape*> entered;
+                std::vector<CollisionShape*> exited;
+            };
+
+            struct TriggerContact
+            {
+                uint32_t trigger_index;
+                uint32_t order;
+                size_t other_id;
+                CollisionShape* other;
+                int32_t delta;
+            };
+
+            bool push_trigger_contact(b2Contact*, int32_t delta); // returns true if the contact involved a trigger
+            void update_triggers();
+            const Trigger* find_trigger(CollisionShape*) const;
+
+            std::vector<Trigger> _triggers;
+            std::unordered_map<size_t, uint32_t> _shape_to_trigger; // shape id to index in _triggers
+            std::vector<TriggerContact> _trigger_contacts; // since the last step
+            std::vector<CollisionShape*> _changed_triggers;
+
+            std::vector<size_t> _merge_ids; // scratch, reused
+            std::vector<CollisionShape*> _merge_shapes;
+            std::vector<int32_t> _merge_counts;
+
+            // step profiles, ring buffer of the last n steps
+
+            void update_profile();
+
+            std::vector<PhysicsStepProfile> _profiles = std::vector<PhysicsStepProfile>(60);
+            size_t _profile_index = 0; // index of the last profile
+            size_t _n_profiles = 0;
+            size_t _contact_listener_ns = 0;
+
+            std::vector<DispatchEntry> _dispatch_buffer;
+            size_t _n_events_seen = 0;
+            CollisionDispatchStatistics _dispatch_statistics;
+
             struct ContactListener : public b2ContactListener
             {
                 ContactListener(PhysicsWorld*);
@@ -156,6 +459,8 @@ namespace ts
                 void PreSolve(b2Contact*, const b2Manifold*) override;
                 void PostSolve(b2Contact*, const b2ContactImpulse*) override;
 
+                void push_event(CollisionEvent::CollisionEventType, b2Contact*);
+
                 PhysicsWorld* _world;
             };
             ContactListener _contact_listener;
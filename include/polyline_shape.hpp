@@ -0,0 +1,114 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#pragma once
+
+#include <vector>
+
+#include <include/renderable.hpp>
+#include <include/color.hpp>
+#include <include/angle.hpp>
+#include <include/geometric_shapes.hpp>
+
+namespace ts
+{
+    /// \brief how two neighboring segments of a ts::PolylineShape are connected
+    enum class PolylineJoin : bool
+    {
+        /// \brief extend the outer edges until they meet, falls back to ts::PolylineJoin::BEVEL for very sharp angles
+        MITER = true,
+
+        /// \brief cut off the outer corner
+        BEVEL = false
+    };
+
+    /// \brief a sequence of connected line segments of constant thickness, rendered as a single mesh
+    class PolylineShape : public Renderable
+    {
+        public:
+            /// \brief construct
+            /// \param vertices: positions of the vertices, in order. If the first and last vertex are equal, the polyline is closed
+            /// \param thickness: width of the line, in pixels
+            /// \param join: how neighboring segments are connected
+            PolylineShape(const std::vector<Vector2f>& vertices, float thickness = 1, PolylineJoin join = PolylineJoin::MITER);
+
+            /// \brief replace all vertices, rebuilds the mesh
+            /// \param vertices: positions of the vertices, in order
+            void set_vertices(const std::vector<Vector2f>& vertices);
+
+            /// \brief get the vertices, not including the model transform
+            /// \returns vector of positions
+            const std::vector<Vector2f>& get_vertices() const;
+
+            /// \brief set the thickness, rebuilds the mesh
+            /// \param thickness: width of the line, in pixels
+            void set_thickness(float);
+
+            /// \brief get the thickness
+            /// \returns width of the line, in pixels
+            float get_thickness() const;
+
+            /// \brief set how neighboring segments are connected, rebuilds the mesh
+            /// \param join: join type
+            void set_join(PolylineJoin);
+
+            /// \brief get how neighboring segments are connected
+            /// \returns join type
+            PolylineJoin get_join() const;
+
+            /// \brief set the color of the entire line
+            /// \param color
+            void set_color(RGBA);
+
+            /// \brief get the color of the line
+            /// \returns color
+            RGBA get_color() const;
+
+            /// \brief set the transform applied to the mesh when rendering: first rotate around the origin, then translate. Does not rebuild the mesh
+            /// \param translation: offset, in pixels
+            /// \param rotation: angle, positive for clockwise
+            /// \param origin: origin of rotation, in the same coordinates as the vertices
+            void set_model_transform(Vector2f translation, Angle rotation, Vector2f origin = Vector2f(0, 0));
+
+            /// \brief get the number of segments
+            /// \returns number of segments
+            size_t get_n_segments() const;
+
+            /// \brief get the number of triangles of the mesh
+            /// \returns number of triangles
+            size_t get_n_triangles() const;
+
+            /// \brief get the axis-aligned bounding box of the mesh, not including the model transform
+            /// \returns rectangle
+            Rectangle get_bounding_box() const;
+
+            /// \brief maximum length of a miter, relative to half the thickness. Sharper corners are beveled instead
+            static inline constexpr float miter_limit = 4;
+
+        protected:
+            /// \copydoc Renderable::render
+            void render(RenderTarget*, Transform) const override;
+
+        private:
+            void update_mesh();
+
+            std::vector<Vector2f> _vertices;
+            float _thickness;
+            PolylineJoin _join;
+            RGBA _color = RGBA(1, 1, 1, 1);
+
+            Vector2f _translation = Vector2f(0, 0);
+            Angle _rotation = degrees(0);
+            Vector2f _origin = Vector2f(0, 0);
+
+            // mesh, triangle strip stored as an indexed triangle list
+            std::vector<float> _local_xy;
+            std::vector<SDL_Color> _colors;
+            std::vector<int> _indices;
+            Rectangle _bounds;
+
+            mutable std::vector<float> _xy; // scratch, transformed positions
+    };
+}
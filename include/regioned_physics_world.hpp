@@ -0,0 +1,173 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <include/physics_world.hpp>
+#include <include/geometric_shapes.hpp>
+
+namespace ts
+{
+    /// \brief index of a region of a ts::RegionedPhysicsWorld, region (x, y) covers [x * size, (x + 1) * size) along each axis
+    struct RegionCoordinate
+    {
+        /// \brief index along the x-axis
+        int32_t x = 0;
+
+        /// \brief index along the y-axis
+        int32_t y = 0;
+
+        /// \brief compare two coordinates
+        /// \param other: other coordinate
+        /// \returns true if both refer to the same region, false otherwise
+        bool operator==(const RegionCoordinate& other) const
+        {
+            return x == other.x and y == other.y;
+        }
+
+        // no docs, row-major order, used to iterate regions deterministically
+        bool operator<(const RegionCoordinate& other) const
+        {
+            return y != other.y ? y < other.y : x < other.x;
+        }
+    };
+
+    /// \brief id of an anchor, c.f. ts::RegionedPhysicsWorld::add_anchor
+    using RegionAnchorID = size_t;
+
+    /// \brief physics world for large levels, space is tiled into square regions each simulated by their own ts::PhysicsWorld. Only regions close to an anchor, such as a camera or player, are stepped, all other regions are frozen
+    /// \note frozen regions are not stepped but stay in memory, their bodies keep their state and can still be queried. To write a region to disk, use ts::PhysicsWorld::snapshot on ts::RegionedPhysicsWorld::get_region
+    /// \note bodies in different regions never collide with each other, even if they overlap across a border. Static geometry crossing a border has to be created in each region it overlaps
+    /// \note when a shape is handed off to another region, its collision callbacks and trigger registration are carried over. The callbacks are registered in the new region's world, so ids returned by ts::PhysicsWorld::add_collision_callback for them are no longer valid, ts::PhysicsWorld::remove_collision_callbacks still removes them. Group callbacks are per world and have to be registered with each region
+    class RegionedPhysicsWorld
+    {
+        public:
+            /// \brief construct
+            /// \param region_size: width and height of each region, in world units
+            /// \param activation_radius: regions at most this many regions away from an anchor along each axis are simulated
+            RegionedPhysicsWorld(float region_size = 2048, size_t activation_radius = 1);
+
+            /// \brief destruct, all shapes in any region have to be destroyed before
+            ~RegionedPhysicsWorld();
+
+            /// \brief advance the simulation of all active regions, then hand off bodies that left their region
+            /// \param timestep: time to advance
+            /// \param velocity_iterations: iterations, dictate velocity step resolution
+            /// \param position_iterations: iterations, dictate velocity step resolution
+            void step(Time timestep, int32_t velocity_iterations = 8, int32_t position_iterations = 3);
+
+            /// \brief get the region a position lies in
+            /// \param position: world coordinates
+            /// \returns coordinate of the region
+            RegionCoordinate get_region_coordinate(Vector2f position) const;
+
+            /// \brief get the bounds of a region
+            /// \param region: coordinate of the region
+            /// \returns rectangle, in world coordinates
+            Rectangle get_region_bounds(RegionCoordinate) const;
+
+            /// \brief access the world simulating a region, it is created if it does not exist yet. Shapes that start inside the region should be created in this world
+            /// \param region: coordinate of the region
+            /// \returns pointer to world, stays valid until the regioned world is destroyed
+            PhysicsWorld* get_region(RegionCoordinate);
+
+            /// \brief access the world simulating the region a position lies in, it is created if it does not exist yet
+            /// \param position: world coordinates
+            /// \returns pointer to world, stays valid until the regioned world is destroyed
+            PhysicsWorld* get_region_at(Vector2f position);
+
+            /// \brief get the worlds of all regions that are currently simulated, in row-major order of their coordinates
+            /// \returns vector of worlds, valid until the next step
+            const std::vector<PhysicsWorld*>& get_active_regions() const;
+
+            /// \brief is a region currently simulated
+            /// \param region: coordinate of the region
+            /// \returns true if the region exists and is active, false otherwise
+            bool get_is_active(RegionCoordinate) const;
+
+            /// \brief add a point of interest, regions around it are simulated. Takes effect at the next step
+            /// \param position: world coordinates
+            /// \returns id of the anchor
+            RegionAnchorID add_anchor(Vector2f position);
+
+            /// \brief move an anchor, usually once per frame to follow a camera or player
+            /// \param id: id returned by ts::RegionedPhysicsWorld::add_anchor
+            /// \param position: new position, world coordinates
+            void set_anchor_position(RegionAnchorID, Vector2f);
+
+            /// \brief remove an anchor
+            /// \param id: id returned by ts::RegionedPhysicsWorld::add_anchor
+            void remove_anchor(RegionAnchorID);
+
+            /// \brief set the gravity of all regions, including regions that are created later
+            /// \param force_vector: where +x: screen-right, -x: screen-left, +y: screen-down, -y: screen-up
+            void set_gravity(Vector2f);
+
+            /// \brief get the gravity shared by all regions
+            /// \returns force vector
+            Vector2f get_gravity() const;
+
+            /// \brief set how far a body has to leave its region before it is handed off to the neighboring region. Prevents bodies resting on a border from being moved back and forth every step
+            /// \param margin: distance, in world units
+            void set_handoff_margin(float);
+
+            /// \brief get the number of regions that were created
+            /// \returns number of regions
+            size_t get_n_regions() const;
+
+            /// \brief get the number of bodies in all active regions
+            /// \returns number of bodies
+            size_t get_n_active_bodies() const;
+
+            /// \brief get the number of bodies in all frozen regions
+            /// \returns number of bodies
+            size_t get_n_frozen_bodies() const;
+
+            /// \brief get the number of bodies that were handed off to another region during the last step
+            /// \returns number of bodies
+            size_t get_n_handoffs() const;
+
+            // no docs, equal for all regions, c.f. ts::PhysicsWorld::world_to_native
+            Vector2f world_to_native(Vector2f) const;
+
+            // no docs, equal for all regions, c.f. ts::PhysicsWorld::native_to_world
+            Vector2f native_to_world(Vector2f) const;
+
+        private:
+            struct Region
+            {
+                std::unique_ptr<PhysicsWorld> world;
+                bool is_active = false;
+            };
+
+            void update_activation();
+            void hand_off();
+
+            float _region_size;
+            int32_t _activation_radius;
+            float _handoff_margin;
+            Vector2f _gravity = Vector2f(0, 0);
+
+            std::map<RegionCoordinate, Region> _regions;
+            std::vector<PhysicsWorld*> _active_regions;
+
+            std::map<RegionAnchorID, Vector2f> _anchors;
+            RegionAnchorID _current_anchor_id = 1;
+
+            struct Handoff
+            {
+                size_t shape_id;
+                CollisionShape* shape;
+                RegionCoordinate to;
+            };
+
+            std::vector<Handoff> _handoffs; // scratch, reused
+            size_t _n_handoffs = 0;
+    };
+}
@@ -8,6 +8,8 @@
 #include <SDL2/SDL_mixer.h>
 
 #include <string>
+#include <mutex>
+#include <unordered_set>
 
 namespace ts
 {
@@ -33,26 +35,37 @@ namespace ts
             /// \returns float in [0, 1]
             float get_volume() const;
 
-            /// \brief load from path
+            /// \brief load from path, or from ts::SoundCache if enabled
             /// \param path: absolute path
             bool load(const std::string& path);
 
-            /// \brief safely deallocate memory
+            /// \brief safely deallocate memory. Audio commands issued so far are applied first, such that channels playing the sound are halted
             void unload();
 
             /// \brief get internal id
             /// \returns uint64
             size_t get_id() const;
 
+            /// \brief get the size of the decoded audio
+            /// \returns number of bytes, 0 if not loaded
+            size_t get_n_bytes() const;
+
             /// \brief get native SDL object
             /// \returns pointer
             Mix_Chunk* get_native();
 
         private:
             friend class SoundHandler;
+            friend class AudioDevice;
 
             size_t _id;
             Mix_Chunk* _chunk;
             float _volume = 1;
+            std::string _path;
+
+            // all loaded sounds, such that they can be decoded again when the output format changes
+            static void reload_all();
+            static inline std::mutex _loaded_lock;
+            static inline std::unordered_set<Sound*> _loaded;
     };
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include <include/sound.hpp>
+
+namespace ts
+{
+    /// \brief shared storage for sounds, each file is decoded at most once, no matter how many objects use it. Sounds that are no longer used are kept in memory until the memory budget is exceeded
+    class SoundBank
+    {
+        public:
+            /// \brief construct
+            /// \param memory_budget: maximum number of bytes of decoded audio kept in memory, or 0 for no limit
+            SoundBank(size_t memory_budget = 0);
+
+            /// \brief destruct, stops preloading and frees all sounds. No sound of the bank may be playing
+            ~SoundBank();
+
+            /// \brief get a sound, decoding it if it is not in memory yet. If the path is currently being preloaded, waits for it to finish instead of decoding it again
+            /// \param path: absolute path, supports the same formats as ts::Sound::load
+            /// \returns pointer to sound, valid until it is released and evicted, or nullptr if the file could not be loaded
+            Sound* acquire(const std::string& path);
+
+            /// \brief stop using a sound, once no user is left it may be evicted to stay within the memory budget
+            /// \param sound: sound returned by ts::SoundBank::acquire
+            void release(Sound*);
+
+            /// \brief decode sounds on a worker thread ahead of time, such as all sounds of a scene during a loading screen. Preloaded sounds count as unused until they are acquired
+            /// \param paths: absolute paths, paths that are already in memory are skipped
+            void preload(const std::vector<std::string>& paths);
+
+            /// \brief block until all paths queued by ts::SoundBank::preload are decoded
+            void wait_for_preload();
+
+            /// \brief is the worker thread still decoding
+            /// \returns true if paths are queued or being decoded, false otherwise
+            bool get_is_preloading() const;
+
+            /// \brief is a sound decoded and in memory
+            /// \param path: absolute path
+            /// \returns true if in memory, false if it was never loaded, is still being decoded or was evicted
+            bool get_is_loaded(const std::string& path) const;
+
+            /// \brief set the maximum number of bytes of decoded audio kept in memory. If exceeded, unused sounds are freed, least recently used first
+            /// \param n_bytes: budget, or 0 for no limit
+            /// \note sounds in use are never evicted, so the budget may be exceeded if all sounds are in use
+            void set_memory_budget(size_t n_bytes);
+
+            /// \brief get the memory budget
+            /// \returns number of bytes, or 0 for no limit
+            size_t get_memory_budget() const;
+
+            /// \brief get the number of bytes of decoded audio currently in memory
+            /// \returns number of bytes
+            size_t get_memory_usage() const;
+
+            /// \brief get the number of sounds in memory, used or unused
+            /// \returns number of sounds
+            size_t get_n_sounds() const;
+
+            /// \brief get the number of times ts::SoundBank::acquire returned a sound that was already in memory
+            /// \returns number of hits
+            size_t get_n_hits() const;
+
+            /// \brief free all sounds that are not in use, regardless of the memory budget
+            void evict_unused();
+
+        private:
+            friend class AudioDevice;
+
+            struct Entry
+            {
+                std::unique_ptr<Sound> sound; // nullptr while loading
+                size_t n_bytes = 0;           // as accounted in the memory usage
+                size_t n_references = 0;
+                size_t last_used = 0;
+                bool is_loading = true;
+            };
+
+            // decodes without holding the lock, the entry has to be inserted and marked as loading before, with the reference of an acquiring caller already taken
+            void load(const std::string& path, std::unique_lock<std::mutex>&);
+            void enforce_budget();
+            void evict(std::unordered_map<std::string, Entry>::iterator);
+            void worker_loop();
+
+            // sounds are decoded again when the output format changes, which changes their size
+            void update_memory_usage();
+            static void update_all_memory_usage(); // called by ts::AudioDevice::reopen
+
+            static inline std::mutex _banks_lock;
+            static inline std::unordered_set<SoundBank*> _banks;
+
+            mutable std::mutex _mutex;
+            std::condition_variable _loaded;
+
+            std::unordered_map<std::string, Entry> _entries;
+            std::unordered_map<const Sound*, std::string> _sound_to_path;
+
+            size_t _memory_budget;
+            size_t _memory_usage = 0;
+            size_t _n_hits = 0;
+            size_t _current_tick = 0; // incremented on every use, used to find the least recently used sound
+
+            std::deque<std::string> _preload_queue;
+            std::thread _worker;
+            bool _worker_running = false;
+            bool _shutdown = false;
+    };
+}
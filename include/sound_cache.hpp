@@ -0,0 +1,97 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <include/time.hpp>
+
+struct Mix_Chunk;
+
+namespace ts
+{
+    /// \brief optional cache of decoded sounds on disk. Once enabled, each sound is decoded only once, later calls to ts::Sound::load map the decoded samples into memory instead
+    class SoundCache
+    {
+        public:
+            /// \brief enable the cache, applies to all sounds loaded afterwards
+            /// \param directory: absolute path of the cache directory, created if it does not exist
+            /// \returns true if successful, false if the directory could not be created
+            static bool enable(const std::string& directory);
+
+            /// \brief disable the cache, sounds loaded from it stay valid
+            static void disable();
+
+            /// \brief is the cache enabled
+            /// \returns true if enabled, false otherwise
+            static bool is_enabled();
+
+            /// \brief get the cache directory
+            /// \returns absolute path, empty if the cache is disabled
+            static std::string get_directory();
+
+            /// \brief delete all cached sounds in the cache directory. Sounds loaded from it stay valid
+            static void clear();
+
+            /// \brief get the number of sounds loaded from the cache since the last reset
+            /// \returns number of hits
+            static size_t get_n_hits();
+
+            /// \brief get the number of sounds that had to be decoded since the last reset, including all sounds loaded while the cache is disabled
+            /// \returns number of misses
+            static size_t get_n_misses();
+
+            /// \brief get the average duration of ts::Sound::load for sounds loaded from the cache
+            /// \returns duration, 0 if there were no hits
+            static Time get_average_hit_load_time();
+
+            /// \brief get the average duration of ts::Sound::load for sounds that had to be decoded
+            /// \returns duration, 0 if there were no misses
+            static Time get_average_miss_load_time();
+
+            /// \brief get the total duration of all calls to ts::Sound::load since the last reset
+            /// \returns duration
+            static Time get_total_load_time();
+
+            /// \brief reset hit, miss and load time statistics
+            static void reset_statistics();
+
+        private:
+            friend class Sound;
+            friend class StreamingSound;
+
+            // decode or map the sound at path, in the current output format of the audio device
+            static Mix_Chunk* load(const std::string& path);
+
+            // free a chunk returned by load
+            static void free(Mix_Chunk*);
+
+            // path of the decoded samples in the current output format, empty if the device is closed or the file does not exist
+            static std::string get_cache_path(const std::string& path, const std::string& directory);
+
+            static Mix_Chunk* load_cached(const std::string& cache_path);
+            static void store(const std::string& cache_path, const Mix_Chunk*);
+
+            struct Mapping
+            {
+                void* data;
+                size_t n_bytes;
+            };
+
+            static inline std::mutex _lock;
+            static inline std::string _directory;
+            static inline std::unordered_map<Mix_Chunk*, Mapping> _mappings;
+
+            static inline std::atomic<size_t> _n_stored = 0; // for unique temporary file names
+            static inline std::atomic<size_t> _n_hits = 0;
+            static inline std::atomic<size_t> _n_misses = 0;
+            static inline std::atomic<uint64_t> _hit_ns = 0;
+            static inline std::atomic<uint64_t> _miss_ns = 0;
+    };
+}
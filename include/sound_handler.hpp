@@ -5,26 +5,69 @@
 
 #pragma once
 
-#include <mutex>
 #include <array>
+#include <atomic>
+#include <unordered_map>
 
+#include <include/audio_command_queue.hpp>
 #include <include/sound.hpp>
+#include <include/streaming_sound.hpp>
 #include <include/time.hpp>
 #include <include/angle.hpp>
 
 namespace ts
 {
-    /// \brief class for handling shorter sound bites, supports 256 channels
+    namespace detail
+    {
+        // state of a channel, c.f. ts::SoundHandler::play
+        struct Voice
+        {
+            bool is_free = true;
+            bool is_allocated = false; // false for channels played on directly by index
+            int32_t priority = 0;
+            size_t age = 0;
+            size_t sound_id = size_t(-1);
+        };
+
+        struct Polyphony
+        {
+            size_t max = 0;
+            size_t n_active = 0;
+        };
+
+        // state as of the last command issued, such that queries do not need to wait for the commands to be applied
+        struct ChannelState
+        {
+            std::atomic<uint32_t> n_started = 0;  // incremented when a play command is issued
+            std::atomic<uint32_t> n_finished = 0; // incremented by SDL_mixer, the channel is busy while they differ
+            std::atomic<bool> is_paused = false;
+            std::atomic<float> volume = 1;
+            std::atomic<float> panning = 0; // in degrees
+        };
+    }
+
+    /// \brief class for handling shorter sound bites, supports 256 channels. All functions are thread-safe, commands are queued and applied in one batch by ts::flush_audio_commands, queries return the state as of the last command issued
     class SoundHandler
     {
         public:
             /// \brief maximum number of channels
             static inline constexpr size_t n_channels = 256;
 
-            /// \brief get a currently inactive channel
+            /// \brief returned by ts::SoundHandler::play if no channel could be allocated
+            static inline constexpr size_t no_channel = size_t(-1);
+
+            /// \brief get a currently inactive channel. If all channels are busy, returns the channel that would be stolen by ts::SoundHandler::play at priority 0
             /// \returns channel index
             static size_t next_free_channel();
 
+            /// \brief play sample on any free channel. If all channels are busy, the voice with the lowest priority is stolen, oldest first, as long as its priority is not higher than that of the new sound
+            /// \param sound: sound to play, user is responsible for the sound staying in memory
+            /// \param priority: priority of the voice, voices with a lower priority are stolen first
+            /// \param n_loops: number of times the sample will be repeated, set to 0 if sample should only be played once
+            /// \param fade_in_duration: duration of fade-in, set to 0 for no fade-in
+            /// \returns channel the sound is played on, or ts::SoundHandler::no_channel if all channels play sounds of higher priority
+            static size_t play(Sound&, int32_t priority = 0, size_t n_loops = 0, Time fade_in_duration = milliseconds(0));
+
             /// \brief play sample on specified channel
             /// \param channel: channel index, [0, 255]
             /// \param sound: sound to play, user is responsible for the sound staying in memory
@@ -32,6 +75,19 @@ namespace ts
             /// \param fade_in_duration: duration of fade-in, set to 0 for no fade-in
             static void play(size_t channel, Sound&, size_t n_loops = 0, Time fade_in_duration = milliseconds(0));
 
+            /// \brief play a streamed sound on any free channel, c.f. ts::SoundHandler::play. A streamed sound plays on one channel at a time, playing it again moves it to the new channel and starts it over
+            /// \param sound: streamed sound, whether it loops is set by ts::StreamingSound::set_should_loop
+            /// \param priority: priority of the voice, voices with a lower priority are stolen first
+            /// \param fade_in_duration: duration of fade-in, set to 0 for no fade-in
+            /// \returns channel the sound is played on, or ts::SoundHandler::no_channel if all channels play sounds of higher priority
+            static size_t play(StreamingSound&, int32_t priority = 0, Time fade_in_duration = milliseconds(0));
+
+            /// \brief play a streamed sound on specified channel
+            /// \param channel: channel index, [0, 255]
+            /// \param sound: streamed sound, whether it loops is set by ts::StreamingSound::set_should_loop
+            /// \param fade_in_duration: duration of fade-in, set to 0 for no fade-in
+            static void play(size_t channel, StreamingSound&, Time fade_in_duration = milliseconds(0));
+
             /// \brief play sample on specified channel
             /// \param sound: sound to play, user is responsible for the sound staying in memory
             /// \param channel: channel index, [0, 255]
@@ -77,17 +133,70 @@ namespace ts
             /// \param zero_to_360_degree: angle, clockwise: 0° is no panning, +90° is full right, 180° is no panning, +270° is full left
             static void set_panning(size_t channel, Angle angle);
 
+            /// \brief set panning and distance attenuation of a channel at once
+            /// \param channel: channel index, [0, 255]
+            /// \param angle: angle, clockwise: 0° is no panning, +90° is full right, 180° is no panning, +270° is full left
+            /// \param distance: in [0, 1], where 0 is no attenuation and 1 is the maximum attenuation
+            static void set_position(size_t channel, Angle angle, float distance);
+
             /// \brief get panning of channel
             /// \param channel: channel index, [0, 255]
             /// \returns angle in degree, clockwise: 0° is no panning, +90° is full right, 180° is no panning, +270° is full left
             static Angle get_panning(size_t channel);
 
-        private:
-            static int32_t forward_index(size_t channel, const std::string function_name);
+            /// \brief limit the number of channels a sound can play on at the same time. If the limit is reached, ts::SoundHandler::play steals the oldest voice of that sound instead of using another channel
+            /// \param sound: sound
+            /// \param n_voices: maximum number of voices, or 0 for no limit
+            static void set_max_polyphony(const Sound&, size_t n_voices);
 
-            static inline std::array<float, n_channels> _volume = {1};
-            static inline std::array<size_t, n_channels> _panning = {0};
+            /// \brief get the polyphony limit of a sound
+            /// \param sound: sound
+            /// \returns maximum number of voices, or 0 if there is no limit
+            static size_t get_max_polyphony(const Sound&);
 
-            static inline std::mutex _lock = std::mutex();
+            /// \brief get the number of channels allocated by ts::SoundHandler::play that have not finished yet
+            /// \returns number of voices
+            static size_t get_n_active_voices();
+
+            /// \brief get the number of voices that were cut off to play another sound, since initialization
+            /// \returns number of voices
+            static size_t get_n_stolen_voices();
+
+        private:
+            friend class detail::AudioCommandQueue;
+            friend class AudioDevice;
+            friend class AudioEmitterSystem;
+            friend class AudioStatistics;
+
+            static int32_t forward_index(size_t channel, const std::string function_name);
+            static bool is_busy(size_t channel);
+            static void issue_play(size_t channel, Mix_Chunk*, uint8_t bus, int32_t n_loops, Time fade_in_duration, uint32_t stream = 0);
+
+            // voice allocation: free channels are kept in a stack, channels that finished are reported
+            // by the audio thread and returned to the stack on the next allocation
+
+            static void on_channel_finished(int channel); // invoked by SDL_mixer, possibly from the audio thread, registered by ts::AudioDevice::open
+            static void collect_finished_channels();
+            static size_t find_victim(int32_t max_priority, size_t sound_id);
+            static void free_voice(size_t channel);
+            static size_t allocate_voice(int32_t priority, size_t sound_id);
+
+            static inline detail::SpinLock _voice_lock; // guards all voice allocation state
+            static inline std::array<detail::Voice, n_channels> _voices = {};
+            static inline std::array<uint16_t, n_channels> _free_channels = {};
+            static inline size_t _n_free = 0;
+            static inline bool _voices_initialized = false;
+            static inline size_t _current_age = 0;
+            static inline size_t _n_active_voices = 0;
+            static inline size_t _n_stolen_voices = 0;
+            static inline std::unordered_map<size_t, detail::Polyphony> _polyphony;
+
+            // written by on_channel_finished
+            static inline detail::SpinLock _finished_lock;
+            static inline std::array<uint16_t, n_channels> _finished = {};
+            static inline std::array<bool, n_channels> _is_finished = {};
+            static inline size_t _n_finished = 0;
+
+            static inline std::array<detail::ChannelState, n_channels> _channels;
     };
 }
\ No newline at end of file
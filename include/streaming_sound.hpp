@@ -0,0 +1,205 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+
+#include <include/audio_command_queue.hpp>
+#include <include/time.hpp>
+
+namespace ts
+{
+    namespace detail
+    {
+        // samples of one streamed sound, decoded ahead of the audio thread into a ring buffer in the output format of the audio device
+        struct SoundStream
+        {
+            ~SoundStream();
+
+            std::string path;
+            uint32_t serial = 0; // identifies the stream in queued commands, never reused
+
+            // source, only accessed while holding decode_lock
+            std::mutex decode_lock;
+            FILE* file = nullptr;
+            SDL_AudioStream* converter = nullptr; // nullptr if the file is already in the output format
+            size_t data_begin = 0;                // byte range of the samples in file
+            size_t data_end = 0;
+            size_t position = 0;
+            size_t source_bytes_per_frame = 1;
+            bool is_flushed = false;
+            std::atomic<bool> needs_transcode = false; // compressed, decoded into ts::SoundCache or a temporary file before streaming
+            bool transcode_failed = false;
+            uint32_t source_serial = 0;           // incremented each time the source is opened, a transcode of an older source is discarded
+            uint32_t decoded_generation = 0;
+
+            // ring buffer, written by the worker, read by the audio thread. Positions only increase, in bytes
+            std::vector<uint8_t> ring;
+            size_t bytes_per_frame = 4;
+            std::atomic<size_t> write = 0;
+            std::atomic<size_t> read = 0;
+            std::atomic<size_t> end = size_t(-1);           // write position at which the source ended, if not looping
+
+            // each play restarts the stream, the audio thread skips to start once the worker rewound the source
+            std::atomic<uint32_t> requested_generation = 0;
+            std::atomic<uint32_t> start_generation = 0;
+            std::atomic<size_t> start = 0;
+            uint32_t consumer_generation = 0;
+
+            std::atomic<bool> should_loop = true;
+            std::atomic<bool> has_output = false;
+            std::atomic<bool> is_finished = false;
+            std::atomic<int> channel = -1;
+            int frequency = 0;
+
+            // compressed files are decoded as a whole on their own thread, such that the worker keeps filling all other streams
+            std::thread transcoder;
+            std::atomic<bool> is_transcoding = false;
+
+            // statistics
+            std::atomic<uint64_t> transcode_ns = 0;
+            std::atomic<uint64_t> decode_ns = 0;
+            std::atomic<uint64_t> n_decoded_frames = 0;
+            std::atomic<size_t> n_underruns = 0;
+        };
+
+        // one thread that keeps the ring buffers of all streams filled
+        struct StreamWorker
+        {
+            ~StreamWorker();
+
+            std::thread thread;
+            std::mutex lock;
+            std::condition_variable wake;
+            bool should_stop = false;
+        };
+    }
+
+    /// \brief long sound that is decoded while it plays instead of when it is loaded, such that it only occupies a small, constant amount of memory. Played on a channel of ts::SoundHandler, like any other sound
+    class StreamingSound
+    {
+        public:
+            /// \brief number of frames decoded ahead, about 370ms at 44100Hz
+            static inline constexpr size_t buffer_n_frames = 16384;
+
+            /// \brief construct, does not perform any allocation
+            StreamingSound();
+
+            /// \brief construct, then load from path
+            /// \param path: absolute path
+            StreamingSound(const std::string& path);
+
+            /// \brief dtor, stops the channel the sound is playing on
+            ~StreamingSound();
+
+            StreamingSound(const StreamingSound&) = delete;
+            StreamingSound& operator=(const StreamingSound&) = delete;
+
+            /// \brief open the file and start decoding its beginning. Uncompressed .wav files are streamed directly, other formats are decoded once into the ts::SoundCache directory, or into an anonymous temporary file if the cache is disabled, then streamed from there
+            /// \note SDL_mixer can only decode compressed files as a whole. This happens on a separate thread, the sound stays silent until it is done, other sounds keep streaming meanwhile. During that time, the thread holds the entire decoded file in memory until it is written to disk, about 10MB per minute of 44100Hz 16-bit stereo audio, twice that for a float output format. With the cache enabled, this happens once per file, otherwise once per call to load. The temporary file is deleted by the system once the sound is unloaded or the application exits
+            /// \param path: absolute path, supports .wav, .mp3, .ogg, .flac
+            /// \returns true if successful, false otherwise
+            bool load(const std::string& path);
+
+            /// \brief stop playback and close the file. If a compressed file is still being decoded, waits until that is done
+            void unload();
+
+            /// \brief get internal id, shared with ts::Sound loaded from the same path
+            /// \returns uint64
+            size_t get_id() const;
+
+            /// \brief set whether the sound starts over once it ended, true by default
+            /// \param should_loop: true to loop, false otherwise
+            void set_should_loop(bool);
+
+            /// \brief get whether the sound starts over once it ended
+            /// \returns true if looping, false otherwise
+            bool get_should_loop() const;
+
+            /// \brief get the channel the sound is playing on, a streamed sound plays on at most one channel at a time
+            /// \returns channel index, or ts::SoundHandler::no_channel
+            size_t get_channel() const;
+
+            /// \brief get the memory used by the ring buffer, which does not depend on the length of the sound
+            /// \returns number of bytes, 0 if not loaded
+            size_t get_n_bytes() const;
+
+            /// \brief get the cpu time the worker thread spent decoding this sound since it was loaded, excluding transcoding
+            /// \returns duration
+            Time get_decode_cpu_time() const;
+
+            /// \brief get the cpu time spent decoding a compressed file as a whole before it can be streamed, c.f. ts::StreamingSound::load. Not included in ts::StreamingSound::get_decode_cpu_time
+            /// \returns duration, 0 for uncompressed files or if the file was already in the ts::SoundCache
+            Time get_transcode_cpu_time() const;
+
+            /// \brief get the cpu time spent decoding while streaming, relative to the duration of audio decoded. Does not include the time spent transcoding compressed files, c.f. ts::StreamingSound::get_transcode_cpu_time
+            /// \returns fraction of one core, for example 0.01 if decoding one second of audio took 10ms
+            float get_decode_load() const;
+
+            /// \brief get the number of buffers in which the audio thread ran out of decoded samples
+            /// \returns number of underruns, each is heard as a gap
+            size_t get_n_underruns() const;
+
+            /// \brief get the number of loaded streamed sounds
+            /// \returns number of streams
+            static size_t get_n_streams();
+
+        private:
+            friend class SoundHandler;
+            friend class AudioDevice;
+            friend class detail::AudioCommandQueue;
+
+            size_t _id = -1;
+            std::shared_ptr<detail::SoundStream> _stream;
+
+            // channels play a looping silent chunk, the effect replaces it with the stream
+            static Mix_Chunk* get_silence();
+
+            // worker thread, while holding the decode lock of the stream
+            static void run_worker();
+            static bool open_source(detail::SoundStream&);
+            static void start_transcode(detail::SoundStream&);
+            static FILE* transcode(const std::string& path); // transcoding thread, does not access the stream
+            static void rewind(detail::SoundStream&);
+            static size_t read_source(detail::SoundStream&, uint8_t* out, size_t n_bytes);
+            static void fill(detail::SoundStream&);
+            static void close_source(detail::SoundStream&);
+            static void wake_worker();
+
+            // applied by ts::detail::AudioCommandQueue, while holding the audio device lock
+            static void on_play(size_t channel, uint32_t serial);
+            static void update();
+
+            // called by ts::AudioDevice::reopen, once the output format changed
+            static void reload_all();
+
+            // audio thread
+            static void on_channel_effect(int channel, void* stream, int length, void* data);
+            static void on_channel_effect_done(int channel, void* data);
+
+            static inline detail::SpinLock _registry_lock;
+            static inline std::unordered_map<uint32_t, std::shared_ptr<detail::SoundStream>> _registry;
+            static inline uint32_t _next_serial = 1;
+
+            static inline std::array<uint8_t, 12288> _silence = {}; // divisible by the size of a frame in all output formats
+            static inline Mix_Chunk* _silence_chunk = nullptr;
+
+            // declared after the registry, such that the thread is joined before the registry is destroyed
+            static inline detail::StreamWorker _worker;
+    };
+}
@@ -0,0 +1,142 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+
+#include <include/physics_world.hpp>
+#include <include/time.hpp>
+
+namespace ts
+{
+    /// \brief collision event returned by ts::WorldScheduler::get_events, additionally stores which world the event occurred in
+    struct ScheduledCollisionEvent
+    {
+        /// \brief index of the world, as returned by ts::WorldScheduler::add_world
+        size_t world_index;
+
+        /// \brief the event
+        CollisionEvent event;
+    };
+
+    /// \brief owns many independent physics worlds and steps them concurrently on a pool of worker threads
+    /// \note box2d keeps global profiling counters (b2_gjkCalls, b2_gjkIters, b2_toiCalls, b2_toiMaxIters, etc.), which all worlds write to without synchronization. While worlds are stepped concurrently, the values of these counters are meaningless and they should not be read or written. telescope itself does not use them
+    class WorldScheduler
+    {
+        public:
+            /// \brief construct
+            /// \param n_threads: number of worker threads, if 0 all worlds are stepped on the calling thread
+            WorldScheduler(size_t n_threads = std::thread::hardware_concurrency());
+
+            /// \brief destruct, joins all worker threads and deallocates all worlds
+            ~WorldScheduler();
+
+            /// \brief create a new world, owned by the scheduler
+            /// \param timestep: fixed duration of one step of this world
+            /// \returns index of the world
+            size_t add_world(Time timestep = seconds(1 / 60.f));
+
+            /// \brief access a world
+            /// \param index: index of the world, as returned by ts::WorldScheduler::add_world
+            /// \returns pointer to world, the scheduler retains ownership
+            PhysicsWorld* get_world(size_t index);
+
+            /// \brief get the number of worlds
+            /// \returns number of worlds
+            size_t get_n_worlds() const;
+
+            /// \brief set the fixed duration of one step of a world
+            /// \param index: index of the world
+            /// \param timestep: duration
+            void set_timestep(size_t index, Time timestep);
+
+            /// \brief get the fixed duration of one step of a world
+            /// \param index: index of the world
+            /// \returns duration
+            Time get_timestep(size_t index) const;
+
+            /// \brief advance all worlds by the elapsed time, concurrently. Each world performs as many steps of its own timestep as fit into the elapsed time, the remainder carries over to the next call. Blocks until all worlds are done
+            /// \param elapsed: time that passed since the last call, usually the result of ts::start_frame
+            /// \param velocity_iterations: iterations, dictate velocity step resolution
+            /// \param position_iterations: iterations, dictate position step resolution
+            /// \note collision callbacks registered with ts::PhysicsWorld::add_collision_callback are invoked on the worker thread that steps their world
+            /// \note if stepping a world throws, the remaining worlds are still stepped, then the first exception is rethrown on the calling thread. In that case, the events of this call stay in the event queues of their worlds
+            void step(Time elapsed, int32_t velocity_iterations = 8, int32_t position_iterations = 3);
+
+            /// \brief get all collision events of all worlds that occurred during the last call to ts::WorldScheduler::step. The event queues of the worlds are drained in the process
+            /// \returns reference to events, valid until the next call to ts::WorldScheduler::step
+            const std::vector<ScheduledCollisionEvent>& get_events() const;
+
+            /// \brief get the time a world took during the last call to ts::WorldScheduler::step, including all of its sub-steps
+            /// \param index: index of the world
+            /// \returns duration
+            Time get_step_duration(size_t index) const;
+
+            /// \brief get the number of steps a world performed during the last call to ts::WorldScheduler::step
+            /// \param index: index of the world
+            /// \returns number of steps
+            size_t get_n_steps(size_t index) const;
+
+            /// \brief get the number of worker threads
+            /// \returns number of threads
+            size_t get_n_threads() const;
+
+            /// \brief maximum number of steps a single world will perform per call to ts::WorldScheduler::step, prevents falling further and further behind if stepping takes longer than real-time
+            static inline constexpr size_t max_steps_per_call = 8;
+
+        private:
+            struct WorldEntry
+            {
+                std::unique_ptr<PhysicsWorld> world;
+                double timestep; // seconds
+                double accumulator; // seconds
+
+                Time last_duration = nanoseconds(0);
+                size_t last_n_steps = 0;
+            };
+
+            std::vector<WorldEntry> _worlds;
+            std::vector<ScheduledCollisionEvent> _events;
+
+            double _elapsed = 0;
+            int32_t _velocity_iterations = 8;
+            int32_t _position_iterations = 3;
+
+            void run(size_t world_index);
+
+            // work-stealing pool: each thread owns a queue of world indices, it pops from the front of its own
+            // queue and, once that is empty, steals from the back of the other threads queues
+
+            struct WorkQueue
+            {
+                std::mutex lock;
+                std::deque<size_t> tasks;
+            };
+
+            bool try_pop(size_t thread_index, size_t& task);
+            bool try_steal(size_t thread_index, size_t& task);
+            void worker_loop(size_t thread_index);
+
+            std::vector<std::unique_ptr<WorkQueue>> _queues;
+            std::vector<std::thread> _threads;
+
+            std::mutex _state_lock;
+            std::condition_variable _work_available;
+            std::condition_variable _work_done;
+
+            size_t _generation = 0;
+            std::atomic<size_t> _n_remaining = 0;
+            std::exception_ptr _exception = nullptr; // first exception thrown by a worker, guarded by _state_lock
+            bool _shutdown = false;
+    };
+}
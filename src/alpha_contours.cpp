@@ -0,0 +1,460 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include <SDL2/SDL_image.h>
+
+#include <include/alpha_contours.hpp>
+#include <include/logging.hpp>
+
+namespace ts
+{
+    namespace detail
+    {
+        // segment between two points on edges of the sample grid, edges are identified by key such that
+        // segments of neighboring cells, possibly computed by different threads, share endpoints exactly
+        struct ContourSegment
+        {
+            uint64_t key_a, key_b;
+            Vector2f point_a, point_b;
+        };
+
+        static inline constexpr uint32_t contour_cache_magic = 0x43415354; // "TSAC"
+
+        static uint64_t fnv1a(const uint8_t* data, size_t n, uint64_t hash = 14695981039346656037ull)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                hash ^= data[i];
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+
+        template<typename T>
+        static void write_value(std::vector<uint8_t>& buffer, T value)
+        {
+            auto offset = buffer.size();
+            buffer.resize(offset + sizeof(T));
+            std::memcpy(buffer.data() + offset, &value, sizeof(T));
+        }
+
+        template<typename T>
+        static bool read_value(const std::vector<uint8_t>& buffer, size_t& offset, T& value)
+        {
+            if (offset + sizeof(T) > buffer.size())
+                return false;
+
+            std::memcpy(&value, buffer.data() + offset, sizeof(T));
+            offset += sizeof(T);
+            return true;
+        }
+
+        // marching squares over the cell rows [first_row, last_row) of the sample grid. The grid is padded by one transparent
+        // sample on each side, such that all contours are closed
+        static void march_rows(
+            const std::vector<uint8_t>& alpha, size_t width, size_t height, uint8_t threshold,
+            size_t first_row, size_t last_row, std::vector<ContourSegment>& out)
+        {
+            const size_t grid_width = width + 2;
+
+            auto sample = [&](size_t gx, size_t gy) -> float {
+                if (gx == 0 or gy == 0 or gx > width or gy > height)
+                    return 0;
+
+                return alpha[(gy - 1) * width + (gx - 1)];
+            };
+
+            auto horizontal = [&](size_t gx, size_t gy) -> uint64_t {
+                return (uint64_t(gy) * grid_width + gx) * 2;
+            };
+
+            auto vertical = [&](size_t gx, size_t gy) -> uint64_t {
+                return (uint64_t(gy) * grid_width + gx) * 2 + 1;
+            };
+
+            // point along the edge from sample a to sample b where alpha crosses the threshold, samples are at pixel centers
+            auto interpolate = [&](float ax, float ay, float a, float bx, float by, float b) -> Vector2f {
+                float t = a == b ? 0.5f : std::clamp((threshold - a) / (b - a), 0.f, 1.f);
+                return Vector2f(ax + t * (bx - ax) - 0.5f, ay + t * (by - ay) - 0.5f);
+            };
+
+            for (size_t gy = first_row; gy < last_row; ++gy)
+            {
+                for (size_t gx = 0; gx <= width; ++gx)
+                {
+                    float tl = sample(gx, gy);
+                    float tr = sample(gx + 1, gy);
+                    float br = sample(gx + 1, gy + 1);
+                    float bl = sample(gx, gy + 1);
+
+                    uint8_t index = (tl >= threshold ? 8 : 0) | (tr >= threshold ? 4 : 0) | (br >= threshold ? 2 : 0) | (bl >= threshold ? 1 : 0);
+                    if (index == 0 or index == 15)
+                        continue;
+
+                    float x = gx, y = gy;
+                    auto top = [&]() { return std::make_pair(horizontal(gx, gy), interpolate(x, y, tl, x + 1, y, tr)); };
+                    auto bottom = [&]() { return std::make_pair(horizontal(gx, gy + 1), interpolate(x, y + 1, bl, x + 1, y + 1, br)); };
+                    auto left = [&]() { return std::make_pair(vertical(gx, gy), interpolate(x, y, tl, x, y + 1, bl)); };
+                    auto right = [&]() { return std::make_pair(vertical(gx + 1, gy), interpolate(x + 1, y, tr, x + 1, y + 1, br)); };
+
+                    auto push = [&](std::pair<uint64_t, Vector2f> a, std::pair<uint64_t, Vector2f> b) {
+                        out.push_back({a.first, b.first, a.second, b.second});
+                    };
+
+                    bool center_inside = (tl + tr + br + bl) / 4 >= threshold;
+
+                    // segments run such that the opaque side is on their right on screen, i.e. outlines run clockwise around opaque
+                    // areas and counter-clockwise around holes. One-sided chains then collide on the transparent side
+                    switch (index)
+                    {
+                        case 1: push(left(), bottom()); break;
+                        case 14: push(bottom(), left()); break;
+                        case 2: push(bottom(), right()); break;
+                        case 13: push(right(), bottom()); break;
+                        case 3: push(left(), right()); break;
+                        case 12: push(right(), left()); break;
+                        case 4: push(right(), top()); break;
+                        case 11: push(top(), right()); break;
+                        case 6: push(bottom(), top()); break;
+                        case 9: push(top(), bottom()); break;
+                        case 7: push(left(), top()); break;
+                        case 8: push(top(), left()); break;
+                        case 5:
+                            if (center_inside) { push(left(), top()); push(right(), bottom()); }
+                            else { push(right(), top()); push(left(), bottom()); }
+                            break;
+                        case 10:
+                            if (center_inside) { push(top(), right()); push(bottom(), left()); }
+                            else { push(top(), left()); push(bottom(), right()); }
+                            break;
+                        default:
+                            break;
+                    }
+                }
+            }
+        }
+    }
+
+    AlphaContourBaker::AlphaContourBaker(float alpha_threshold, float simplification_tolerance, size_t n_threads)
+        : _alpha_threshold(std::clamp(alpha_threshold, 0.f, 1.f)),
+          _simplification_tolerance(simplification_tolerance),
+          _n_threads(n_threads != 0 ? n_threads : std::max<size_t>(std::thread::hardware_concurrency(), 1))
+    {}
+
+    void AlphaContourBaker::set_cache_directory(const std::string& directory)
+    {
+        _cache_directory = directory;
+    }
+
+    bool AlphaContourBaker::get_last_was_cached() const
+    {
+        return _last_was_cached;
+    }
+
+    AlphaContours AlphaContourBaker::bake(const std::vector<uint8_t>& alpha, size_t width, size_t height) const
+    {
+        auto out = AlphaContours();
+        out.width = width;
+        out.height = height;
+
+        if (width == 0 or height == 0 or alpha.size() < width * height)
+        {
+            Log::warning("In ts::AlphaContourBaker::bake: alpha channel has ", alpha.size(), " pixels, but at least ", width * height, " are needed for an image of size ", width, "x", height);
+            return out;
+        }
+
+        // alpha of 0 is never opaque, otherwise the padding would be part of the outline
+        auto threshold = uint8_t(std::clamp<float>(_alpha_threshold * 255, 1, 255));
+
+        // the padded grid has height + 1 rows of cells, each thread traces a band of consecutive rows
+        size_t n_rows = height + 1;
+        size_t n_tiles = std::min(_n_threads, n_rows);
+        auto tiles = std::vector<std::vector<detail::ContourSegment>>(n_tiles);
+
+        auto rows_of = [&](size_t tile) -> std::pair<size_t, size_t> {
+            return {tile * n_rows / n_tiles, (tile + 1) * n_rows / n_tiles};
+        };
+
+        if (n_tiles <= 1)
+            detail::march_rows(alpha, width, height, threshold, 0, n_rows, tiles.at(0));
+        else
+        {
+            auto threads = std::vector<std::thread>();
+            for (size_t i = 0; i < n_tiles; ++i)
+                threads.emplace_back([&, i]() {
+                    auto [first, last] = rows_of(i);
+                    detail::march_rows(alpha, width, height, threshold, first, last, tiles.at(i));
+                });
+
+            for (auto& thread : threads)
+                thread.join();
+        }
+
+        // tiles are concatenated in row order, so the result does not depend on the number of threads
+        auto segments = std::vector<detail::ContourSegment>();
+        size_t n_segments = 0;
+        for (auto& tile : tiles)
+            n_segments += tile.size();
+
+        segments.reserve(n_segments);
+        for (auto& tile : tiles)
+            segments.insert(segments.end(), tile.begin(), tile.end());
+
+        // each edge point is shared by exactly two segments
+        static constexpr uint32_t none = uint32_t(-1);
+        auto adjacency = std::unordered_map<uint64_t, std::array<uint32_t, 2>>();
+        adjacency.reserve(n_segments);
+
+        auto link = [&](uint64_t key, uint32_t segment) {
+            auto it = adjacency.find(key);
+            if (it == adjacency.end())
+                adjacency.insert({key, {segment, none}});
+            else
+                it->second[1] = segment;
+        };
+
+        for (uint32_t i = 0; i < segments.size(); ++i)
+        {
+            link(segments[i].key_a, i);
+            link(segments[i].key_b, i);
+        }
+
+        auto visited = std::vector<bool>(segments.size(), false);
+        for (uint32_t i = 0; i < segments.size(); ++i)
+        {
+            if (visited[i])
+                continue;
+
+            auto chain = std::vector<Vector2f>{segments[i].point_a, segments[i].point_b};
+            visited[i] = true;
+
+            uint64_t start_key = segments[i].key_a;
+            uint64_t current_key = segments[i].key_b;
+            uint32_t current = i;
+
+            while (current_key != start_key)
+            {
+                auto& neighbors = adjacency.at(current_key);
+                uint32_t next = neighbors[0] == current ? neighbors[1] : neighbors[0];
+                if (next == none or visited[next])
+                    break;
+
+                // segments are oriented consistently, so the chain always continues at the start of the next segment
+                auto& segment = segments[next];
+                if (segment.key_a != current_key)
+                    break;
+
+                chain.push_back(segment.point_b);
+                current_key = segment.key_b;
+
+                visited[next] = true;
+                current = next;
+            }
+
+            chain = CollisionLineSequence::simplify(chain, _simplification_tolerance);
+            if (chain.size() >= 4)
+                out.chains.push_back(std::move(chain));
+        }
+
+        return out;
+    }
+
+    bool AlphaContourBaker::bake_file(const std::string& path, AlphaContours* out)
+    {
+        _last_was_cached = false;
+
+        auto cache_path = std::string();
+        if (not _cache_directory.empty())
+        {
+            auto file = std::ifstream(path, std::ios::binary);
+            if (not file.is_open())
+            {
+                Log::warning("In ts::AlphaContourBaker::bake_file: unable to open file \"", path, "\"");
+                return false;
+            }
+
+            auto bytes = std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+            // parameters are part of the key, such that changing them invalidates the cache
+            auto hash = detail::fnv1a(bytes.data(), bytes.size());
+            hash = detail::fnv1a((const uint8_t*) &_alpha_threshold, sizeof(float), hash);
+            hash = detail::fnv1a((const uint8_t*) &_simplification_tolerance, sizeof(float), hash);
+
+            cache_path = get_cache_path(hash);
+            if (load_cache(cache_path, out))
+            {
+                _last_was_cached = true;
+                return true;
+            }
+        }
+
+        auto* loaded = IMG_Load(path.c_str());
+        if (loaded == nullptr)
+        {
+            Log::warning("In ts::AlphaContourBaker::bake_file: unable to load image from file \"", path, "\"");
+            return false;
+        }
+
+        // RGBA32 is byte-ordered, alpha is always the fourth byte of each pixel
+        auto* surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+        SDL_FreeSurface(loaded);
+
+        if (surface == nullptr)
+        {
+            Log::warning("In ts::AlphaContourBaker::bake_file: unable to convert image \"", path, "\" to RGBA");
+            return false;
+        }
+
+        size_t width = surface->w;
+        size_t height = surface->h;
+        auto alpha = std::vector<uint8_t>(width * height);
+
+        SDL_LockSurface(surface);
+        for (size_t y = 0; y < height; ++y)
+        {
+            auto* row = (const uint8_t*) surface->pixels + y * surface->pitch;
+            for (size_t x = 0; x < width; ++x)
+                alpha[y * width + x] = row[x * 4 + 3];
+        }
+        SDL_UnlockSurface(surface);
+        SDL_FreeSurface(surface);
+
+        *out = bake(alpha, width, height);
+
+        if (not cache_path.empty())
+            save_cache(cache_path, *out);
+
+        return true;
+    }
+
+    std::string AlphaContourBaker::get_cache_path(uint64_t file_hash) const
+    {
+        auto out = std::stringstream();
+        out << _cache_directory;
+        if (_cache_directory.back() != '/')
+            out << '/';
+
+        out << std::hex << file_hash << ".contours";
+        return out.str();
+    }
+
+    bool AlphaContourBaker::load_cache(const std::string& path, AlphaContours* out) const
+    {
+        auto file = std::ifstream(path, std::ios::binary);
+        if (not file.is_open())
+            return false;
+
+        auto buffer = std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        size_t offset = 0;
+
+        uint32_t magic = 0, version = 0;
+        uint64_t width = 0, height = 0, n_chains = 0;
+        if (not detail::read_value(buffer, offset, magic) or magic != detail::contour_cache_magic or
+            not detail::read_value(buffer, offset, version) or version != cache_version or
+            not detail::read_value(buffer, offset, width) or
+            not detail::read_value(buffer, offset, height) or
+            not detail::read_value(buffer, offset, n_chains))
+            return false;
+
+        auto result = AlphaContours();
+        result.width = width;
+        result.height = height;
+        result.chains.reserve(n_chains);
+
+        for (size_t i = 0; i < n_chains; ++i)
+        {
+            uint64_t n_vertices = 0;
+            if (not detail::read_value(buffer, offset, n_vertices) or offset + n_vertices * 2 * sizeof(float) > buffer.size())
+                return false;
+
+            auto& chain = result.chains.emplace_back();
+            chain.reserve(n_vertices);
+            for (size_t j = 0; j < n_vertices; ++j)
+            {
+                float x, y;
+                detail::read_value(buffer, offset, x);
+                detail::read_value(buffer, offset, y);
+                chain.emplace_back(x, y);
+            }
+        }
+
+        *out = std::move(result);
+        return true;
+    }
+
+    void AlphaContourBaker::save_cache(const std::string& path, const AlphaContours& contours) const
+    {
+        auto buffer = std::vector<uint8_t>();
+        detail::write_value(buffer, detail::contour_cache_magic);
+        detail::write_value(buffer, cache_version);
+        detail::write_value(buffer, uint64_t(contours.width));
+        detail::write_value(buffer, uint64_t(contours.height));
+        detail::write_value(buffer, uint64_t(contours.chains.size()));
+
+        for (auto& chain : contours.chains)
+        {
+            detail::write_value(buffer, uint64_t(chain.size()));
+            for (auto& v : chain)
+            {
+                detail::write_value(buffer, float(v.x));
+                detail::write_value(buffer, float(v.y));
+            }
+        }
+
+        auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+        if (not file.is_open())
+        {
+            Log::warning("In ts::AlphaContourBaker::bake_file: unable to write cache file \"", path, "\"");
+            return;
+        }
+
+        file.write((const char*) buffer.data(), buffer.size());
+    }
+
+    std::vector<std::unique_ptr<CollisionLineSequence>> AlphaContours::create_collision_shapes(PhysicsWorld* world, CollisionType type, Vector2f top_left, bool is_two_sided) const
+    {
+        auto out = std::vector<std::unique_ptr<CollisionLineSequence>>();
+        out.reserve(chains.size());
+
+        auto vertices = std::vector<Vector2f>();
+        for (auto& chain : chains)
+        {
+            vertices.clear();
+            for (auto& v : chain)
+                vertices.push_back(v + top_left);
+
+            out.push_back(std::make_unique<CollisionLineSequence>(world, type, vertices, is_two_sided));
+        }
+
+        return out;
+    }
+
+    std::vector<PolylineShape> AlphaContours::create_render_shapes(Vector2f top_left, float thickness) const
+    {
+        auto out = std::vector<PolylineShape>();
+        out.reserve(chains.size());
+
+        auto vertices = std::vector<Vector2f>();
+        for (auto& chain : chains)
+        {
+            vertices.clear();
+            for (auto& v : chain)
+                vertices.push_back(v + top_left);
+
+            out.emplace_back(vertices, thickness);
+        }
+
+        return out;
+    }
+}
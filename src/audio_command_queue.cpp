@@ -0,0 +1,220 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#include <thread>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+
+#include <include/audio_command_queue.hpp>
+#include <include/sound_handler.hpp>
+#include <include/music_handler.hpp>
+#include <include/audio_mixer.hpp>
+#include <include/music_playlist.hpp>
+#include <include/streaming_sound.hpp>
+#include <include/audio_statistics.hpp>
+
+namespace ts
+{
+    size_t flush_audio_commands()
+    {
+        return detail::AudioCommandQueue::flush();
+    }
+
+    namespace detail
+    {
+        void AudioCommandQueue::push(const AudioCommand& command)
+        {
+            while (not _queue.try_push(command))
+            {
+                // full, make room by applying what was issued so far, or wait for the thread that is already doing so
+                if (flush() == 0)
+                    std::this_thread::yield();
+            }
+        }
+
+        size_t AudioCommandQueue::flush()
+        {
+            if (_is_flushing.test_and_set(std::memory_order_acquire))
+                return 0;
+
+            auto n_applied = apply_all();
+            _is_flushing.clear(std::memory_order_release);
+            return n_applied;
+        }
+
+        void AudioCommandQueue::flush_pending()
+        {
+            // unlike flush, waits for a flush on another thread to finish, which may not have reached the commands of this thread yet
+            while (_is_flushing.test_and_set(std::memory_order_acquire))
+                std::this_thread::yield();
+
+            apply_all();
+            _is_flushing.clear(std::memory_order_release);
+        }
+
+        size_t AudioCommandQueue::apply_all()
+        {
+            // SDL_mixer locks the device for every call, the lock is recursive, so taking it once
+            // here means the audio callback is blocked once per flush instead of once per command
+            SDL_LockAudio();
+
+            size_t n_applied = 0;
+            auto command = AudioCommand();
+
+            do
+            {
+                while (_queue.try_pop(command))
+                {
+                    apply(command);
+                    n_applied += 1;
+                }
+            }
+            while (MusicHandler::update());
+
+            MusicPlaylist::update();
+            StreamingSound::update();
+
+            SDL_UnlockAudio();
+
+            AudioStatistics::on_commands_applied(n_applied);
+            return n_applied;
+        }
+
+        void AudioCommandQueue::apply(const AudioCommand& command)
+        {
+            auto* chunk = static_cast<Mix_Chunk*>(command.data);
+            auto* music = static_cast<Mix_Music*>(command.data);
+
+            switch (command.type)
+            {
+                case AudioCommand::CHANNEL_PLAY:
+                    if (Mix_PlayChannel(command.channel, chunk, command.n_loops) == -1)
+                        SoundHandler::on_channel_finished(command.channel); // the play was counted when it was issued
+                    else
+                    {
+                        if (command.stream != 0)
+                            StreamingSound::on_play(command.channel, command.stream);
+
+                        AudioMixer::on_play(command.channel, chunk, AudioBus(command.bus));
+                    }
+                    break;
+
+                case AudioCommand::CHANNEL_FADE_IN:
+                    if (Mix_FadeInChannel(command.channel, chunk, command.n_loops, command.duration_ms) == -1)
+                        SoundHandler::on_channel_finished(command.channel);
+                    else
+                    {
+                        if (command.stream != 0)
+                            StreamingSound::on_play(command.channel, command.stream);
+
+                        AudioMixer::on_play(command.channel, chunk, AudioBus(command.bus));
+                    }
+                    break;
+
+                case AudioCommand::CHANNEL_STOP:
+                    Mix_HaltChannel(command.channel);
+                    break;
+
+                case AudioCommand::CHANNEL_FADE_OUT:
+                    Mix_FadeOutChannel(command.channel, command.duration_ms);
+                    break;
+
+                case AudioCommand::CHANNEL_PAUSE:
+                    Mix_Pause(command.channel);
+                    break;
+
+                case AudioCommand::CHANNEL_UNPAUSE:
+                    Mix_Resume(command.channel);
+                    break;
+
+                case AudioCommand::CHANNEL_EXPIRE:
+                    Mix_ExpireChannel(command.channel, 0);
+                    break;
+
+                case AudioCommand::CHANNEL_SET_VOLUME:
+                    Mix_Volume(command.channel, command.value * MIX_MAX_VOLUME);
+                    break;
+
+                case AudioCommand::CHANNEL_SET_PANNING:
+                case AudioCommand::CHANNEL_SET_POSITION:
+                    // while the mixer is enabled, it pans channels itself
+                    AudioMixer::set_channel_position(command.channel, command.value, command.distance);
+                    if (not AudioMixer::_is_active)
+                        Mix_SetPosition(command.channel, command.value, command.distance);
+                    break;
+
+                case AudioCommand::MUSIC_PLAY:
+                    MusicPlaylist::apply_stop(); // the playlist replaces SDL_mixers music player while it is active
+                    Mix_PlayMusic(music, command.n_loops);
+                    break;
+
+                case AudioCommand::MUSIC_FADE_IN:
+                    MusicPlaylist::apply_stop();
+                    Mix_FadeInMusic(music, command.n_loops, command.duration_ms);
+                    break;
+
+                case AudioCommand::MUSIC_STOP:
+                    Mix_HaltMusic();
+                    break;
+
+                case AudioCommand::MUSIC_FADE_OUT:
+                    Mix_FadeOutMusic(command.duration_ms);
+                    break;
+
+                case AudioCommand::MUSIC_PAUSE:
+                    Mix_PauseMusic();
+                    break;
+
+                case AudioCommand::MUSIC_UNPAUSE:
+                    Mix_ResumeMusic();
+                    break;
+
+                case AudioCommand::MUSIC_SKIP_TO:
+                    if (command.value == 0)
+                        Mix_RewindMusic();
+                    else
+                        Mix_SetMusicPosition(command.value);
+                    break;
+
+                case AudioCommand::MUSIC_SET_VOLUME:
+                    Mix_VolumeMusic(command.value * MIX_MAX_VOLUME);
+                    break;
+
+                case AudioCommand::PLAYLIST_START:
+                    MusicPlaylist::apply_start();
+                    break;
+
+                case AudioCommand::PLAYLIST_STOP:
+                    MusicPlaylist::apply_stop();
+                    break;
+
+                case AudioCommand::PLAYLIST_SKIP:
+                    MusicPlaylist::apply_skip();
+                    break;
+
+                case AudioCommand::MIXER_ENABLE:
+                    AudioMixer::apply_enable();
+                    break;
+
+                case AudioCommand::MIXER_DISABLE:
+                    AudioMixer::apply_disable();
+                    break;
+
+                case AudioCommand::MIXER_SET_BUS_VOLUME:
+                    AudioMixer::apply_bus_volume(AudioBus(command.bus), command.value, command.duration_ms);
+                    break;
+
+                case AudioCommand::MIXER_SET_BUS_LOW_PASS:
+                    AudioMixer::apply_bus_low_pass(AudioBus(command.bus), command.value);
+                    break;
+
+                case AudioCommand::MIXER_SET_LIMITER:
+                    AudioMixer::apply_limiter_threshold(command.value);
+                    break;
+            }
+        }
+    }
+}
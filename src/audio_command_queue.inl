@@ -0,0 +1,60 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+namespace ts::detail
+{
+    // each cell carries a sequence number: a producer may write to a cell once its sequence equals the
+    // position being pushed, the consumer may read it once the sequence is one past the position being popped
+
+    template<typename T, size_t Capacity>
+    MPSCQueue<T, Capacity>::MPSCQueue()
+    {
+        for (size_t i = 0; i < Capacity; ++i)
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    template<typename T, size_t Capacity>
+    bool MPSCQueue<T, Capacity>::try_push(const T& value)
+    {
+        Cell* cell;
+        size_t position = _push_position.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            cell = &_cells[position & (Capacity - 1)];
+            auto sequence = cell->sequence.load(std::memory_order_acquire);
+            auto difference = intptr_t(sequence) - intptr_t(position);
+
+            if (difference == 0)
+            {
+                if (_push_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (difference < 0)
+                return false; // full
+            else
+                position = _push_position.load(std::memory_order_relaxed);
+        }
+
+        cell->value = value;
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename T, size_t Capacity>
+    bool MPSCQueue<T, Capacity>::try_pop(T& out)
+    {
+        auto& cell = _cells[_pop_position & (Capacity - 1)];
+        auto sequence = cell.sequence.load(std::memory_order_acquire);
+
+        if (intptr_t(sequence) - intptr_t(_pop_position + 1) < 0)
+            return false; // empty, or the producer has not finished writing yet
+
+        out = cell.value;
+        cell.sequence.store(_pop_position + Capacity, std::memory_order_release);
+        _pop_position += 1;
+        return true;
+    }
+}
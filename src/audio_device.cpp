@@ -0,0 +1,230 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#include <chrono>
+#include <ctime>
+#include <algorithm>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+
+#include <include/audio_device.hpp>
+#include <include/audio_mixer.hpp>
+#include <include/music_playlist.hpp>
+#include <include/streaming_sound.hpp>
+#include <include/audio_statistics.hpp>
+#include <include/sound_bank.hpp>
+#include <include/sound_handler.hpp>
+#include <include/logging.hpp>
+
+namespace ts
+{
+    namespace detail
+    {
+        uint64_t thread_cpu_ns()
+        {
+            #if defined(CLOCK_THREAD_CPUTIME_ID)
+            timespec time;
+            if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) == 0)
+                return uint64_t(time.tv_sec) * 1000000000 + time.tv_nsec;
+            #endif
+
+            return 0;
+        }
+    }
+
+    bool AudioDevice::open_device(AudioConfig config)
+    {
+        if (Mix_OpenAudio(config.sample_rate, config.format, config.n_channels, config.chunk_size) != 0)
+            return false;
+
+        if (Mix_AllocateChannels(SoundHandler::n_channels) != SoundHandler::n_channels)
+        {
+            Mix_CloseAudio();
+            return false;
+        }
+
+        int frequency = 0;
+        uint16_t format = 0;
+        int n_channels = 0;
+        Mix_QuerySpec(&frequency, &format, &n_channels);
+
+        _bytes_per_frame = std::max<size_t>(1, (SDL_AUDIO_BITSIZE(format) / 8) * n_channels);
+        _frequency = frequency;
+        _n_frames_per_callback = 0;
+        _last_thread_ns = 0;
+        _last_callback_ns = 0;
+        reset_callback_statistics();
+
+        Mix_SetPostMix(&on_post_mix, nullptr);
+
+        // is_playing and voice allocation count finished channels, so the hook has to be in place before the first play
+        Mix_ChannelFinished(&SoundHandler::on_channel_finished);
+
+        _requested = config;
+        _is_open = true;
+        return true;
+    }
+
+    bool AudioDevice::open(AudioConfig config)
+    {
+        if (_is_open)
+        {
+            Log::warning("In ts::AudioDevice::open: device is already open, use ts::AudioDevice::reopen to change its configuration");
+            return true;
+        }
+
+        return open_device(config);
+    }
+
+    bool AudioDevice::reopen(AudioConfig config)
+    {
+        if (not _is_open)
+            return open(config);
+
+        // everything that holds decoded audio or registered hooks is stopped through the queue first
+        bool mixer_was_enabled = AudioMixer::is_enabled();
+        if (mixer_was_enabled)
+            AudioMixer::disable();
+
+        if (MusicPlaylist::is_playing())
+            MusicPlaylist::stop();
+
+        MusicHandler::force_stop();
+        flush_audio_commands();
+
+        Mix_HaltChannel(-1);
+        Mix_HaltMusic();
+        Mix_SetPostMix(nullptr, nullptr);
+        Mix_CloseAudio();
+        _is_open = false;
+
+        auto previous = _requested;
+        bool success = open_device(config);
+        if (not success)
+        {
+            Log::warning("In ts::AudioDevice::reopen: unable to open audio device with the requested configuration: ", SDL_GetError(), ", reopening with the previous configuration");
+            if (not open_device(previous))
+            {
+                Log::warning("In ts::AudioDevice::reopen: unable to reopen audio device: ", SDL_GetError());
+                return false;
+            }
+        }
+
+        // samples are converted to the output format when they are decoded
+        Sound::reload_all();
+        SoundBank::update_all_memory_usage();
+        Music::reload_all();
+        StreamingSound::reload_all();
+
+        if (mixer_was_enabled)
+        {
+            AudioMixer::enable();
+            flush_audio_commands();
+        }
+
+        return success;
+    }
+
+    bool AudioDevice::is_open()
+    {
+        return _is_open;
+    }
+
+    AudioConfig AudioDevice::get_config()
+    {
+        auto out = _requested;
+
+        int frequency = 0;
+        uint16_t format = 0;
+        int n_channels = 0;
+
+        if (_is_open and Mix_QuerySpec(&frequency, &format, &n_channels) != 0)
+        {
+            out.sample_rate = frequency;
+            out.format = format;
+            out.n_channels = n_channels;
+        }
+
+        if (_n_frames_per_callback > 0)
+            out.chunk_size = _n_frames_per_callback;
+
+        return out;
+    }
+
+    Time AudioDevice::get_latency()
+    {
+        auto config = get_config();
+        return seconds(config.sample_rate > 0 ? double(config.chunk_size) / config.sample_rate : 0);
+    }
+
+    Time AudioDevice::get_last_callback_cpu_time()
+    {
+        return nanoseconds(_last_ns);
+    }
+
+    Time AudioDevice::get_average_callback_cpu_time()
+    {
+        auto n = _n_callbacks.load();
+        return nanoseconds(n > 0 ? _total_ns / n : 0);
+    }
+
+    Time AudioDevice::get_max_callback_cpu_time()
+    {
+        return nanoseconds(_max_ns);
+    }
+
+    size_t AudioDevice::get_n_callbacks()
+    {
+        return _n_callbacks;
+    }
+
+    void AudioDevice::reset_callback_statistics()
+    {
+        _last_ns = 0;
+        _max_ns = 0;
+        _total_ns = 0;
+        _n_callbacks = 0;
+    }
+
+    void AudioDevice::on_post_mix(void* data, uint8_t* stream, int length)
+    {
+        AudioMixer::on_post_mix(data, stream, length);
+
+        size_t n_frames = length / _bytes_per_frame;
+        _n_frames_per_callback = n_frames;
+
+        uint64_t budget_ns = _frequency > 0 ? n_frames * uint64_t(1000000000) / _frequency : 0;
+
+        // the driver asks for the next buffer about once per buffer duration. If it asks a whole buffer later than
+        // that, the audio thread was not scheduled in time, and the device most likely played silence in between
+        uint64_t wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        bool is_late = _last_callback_ns != 0 and wall_ns - _last_callback_ns > 2 * budget_ns;
+        _last_callback_ns = wall_ns;
+
+        // everything the audio thread did since the last buffer: writing it to the driver, then mixing this one
+        auto now = detail::thread_cpu_ns();
+        if (now == 0)
+        {
+            AudioStatistics::on_callback(0, budget_ns, is_late);
+            return;
+        }
+
+        if (_last_thread_ns != 0)
+        {
+            auto duration = now - _last_thread_ns;
+            _last_ns = duration;
+            if (duration > _max_ns)
+                _max_ns = duration;
+
+            _total_ns += duration;
+            _n_callbacks += 1;
+
+            AudioStatistics::on_callback(duration, budget_ns, is_late);
+        }
+
+        _last_thread_ns = now;
+    }
+}
@@ -0,0 +1,251 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#include <cmath>
+#include <algorithm>
+
+#include <include/audio_emitter_system.hpp>
+#include <include/sound_handler.hpp>
+#include <include/logging.hpp>
+
+namespace ts
+{
+    AudioEmitterSystem::AudioEmitterSystem(float hearing_radius)
+        : _hearing_radius(hearing_radius)
+    {}
+
+    AudioEmitterSystem::~AudioEmitterSystem()
+    {
+        _n_virtual_total -= _n_virtual;
+
+        for (auto& emitter : _emitters)
+            if (owns_voice(emitter))
+                SoundHandler::stop(emitter.channel);
+    }
+
+    AudioEmitterID AudioEmitterSystem::add(Sound& sound, Vector2f position, bool should_loop, int32_t priority)
+    {
+        auto id = _current_id++;
+
+        _id_to_slot.insert({id, _emitters.size()});
+        _x.push_back(position.x);
+        _y.push_back(position.y);
+        _emitters.push_back(Emitter{id, &sound, should_loop, priority, SoundHandler::no_channel, 0, -1, -1});
+
+        return id;
+    }
+
+    size_t AudioEmitterSystem::get_slot(AudioEmitterID id, const std::string& function_name) const
+    {
+        auto it = _id_to_slot.find(id);
+        if (it == _id_to_slot.end())
+        {
+            Log::warning("In ts::AudioEmitterSystem::", function_name, ": no emitter with id ", id);
+            return -1;
+        }
+
+        return it->second;
+    }
+
+    void AudioEmitterSystem::remove(AudioEmitterID id)
+    {
+        auto slot = get_slot(id, "remove");
+        if (slot == size_t(-1))
+            return;
+
+        auto& emitter = _emitters.at(slot);
+        if (owns_voice(emitter))
+            SoundHandler::stop(emitter.channel);
+
+        remove_slot(slot);
+    }
+
+    void AudioEmitterSystem::remove_slot(size_t slot)
+    {
+        // swap with last, such that the arrays stay contiguous
+        auto last = _emitters.size() - 1;
+        _id_to_slot.erase(_emitters.at(slot).id);
+
+        if (slot != last)
+        {
+            _emitters.at(slot) = _emitters.at(last);
+            _x.at(slot) = _x.at(last);
+            _y.at(slot) = _y.at(last);
+            _id_to_slot.at(_emitters.at(slot).id) = slot;
+        }
+
+        _emitters.pop_back();
+        _x.pop_back();
+        _y.pop_back();
+    }
+
+    bool AudioEmitterSystem::has_emitter(AudioEmitterID id) const
+    {
+        return _id_to_slot.find(id) != _id_to_slot.end();
+    }
+
+    void AudioEmitterSystem::set_position(AudioEmitterID id, Vector2f position)
+    {
+        auto slot = get_slot(id, "set_position");
+        if (slot == size_t(-1))
+            return;
+
+        _x.at(slot) = position.x;
+        _y.at(slot) = position.y;
+    }
+
+    Vector2f AudioEmitterSystem::get_position(AudioEmitterID id) const
+    {
+        auto slot = get_slot(id, "get_position");
+        if (slot == size_t(-1))
+            return Vector2f(0, 0);
+
+        return Vector2f(_x.at(slot), _y.at(slot));
+    }
+
+    bool AudioEmitterSystem::get_is_virtual(AudioEmitterID id) const
+    {
+        auto slot = get_slot(id, "get_is_virtual");
+        if (slot == size_t(-1))
+            return true;
+
+        return not owns_voice(_emitters.at(slot));
+    }
+
+    bool AudioEmitterSystem::owns_voice(const Emitter& emitter) const
+    {
+        // the channel may have finished or been stolen by another sound since it was assigned
+        if (emitter.channel == SoundHandler::no_channel)
+            return false;
+
+        auto& state = SoundHandler::_channels[emitter.channel];
+        return state.n_started.load(std::memory_order_acquire) == emitter.play_count and SoundHandler::is_busy(emitter.channel);
+    }
+
+    void AudioEmitterSystem::update(const Camera& camera)
+    {
+        update(camera.get_center());
+    }
+
+    void AudioEmitterSystem::update(Vector2f listener)
+    {
+        size_t n = _emitters.size();
+        _distance_squared.resize(n);
+
+        // branchless over contiguous arrays, such that the compiler can vectorize it
+        {
+            const float* x = _x.data();
+            const float* y = _y.data();
+            float* distance_squared = _distance_squared.data();
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                float dx = x[i] - listener.x;
+                float dy = y[i] - listener.y;
+                distance_squared[i] = dx * dx + dy * dy;
+            }
+        }
+
+        const float radius_squared = _hearing_radius * _hearing_radius;
+        const float angle_step_size = 360.f / n_angle_steps;
+
+        size_t n_virtual_before = _n_virtual;
+        _n_virtual = 0;
+        _n_position_updates = 0;
+
+        for (size_t i = 0; i < _emitters.size();)
+        {
+            auto& emitter = _emitters[i];
+            bool in_range = _distance_squared[i] < radius_squared;
+            bool has_voice = owns_voice(emitter);
+
+            // non-looping sounds are not restarted, once they lose their voice they are done
+            bool had_voice = emitter.channel != SoundHandler::no_channel;
+            if ((had_voice and not has_voice and not emitter.should_loop) or (not in_range and not emitter.should_loop))
+            {
+                if (has_voice)
+                    SoundHandler::stop(emitter.channel);
+
+                // swap-remove, the last emitter is moved into this slot, so the distance has to be moved with it
+                _distance_squared[i] = _distance_squared[_emitters.size() - 1];
+                remove_slot(i);
+                continue;
+            }
+
+            if (not in_range)
+            {
+                if (has_voice)
+                    SoundHandler::stop(emitter.channel);
+
+                emitter.channel = SoundHandler::no_channel;
+                _n_virtual += 1;
+                i += 1;
+                continue;
+            }
+
+            if (not has_voice)
+            {
+                emitter.channel = SoundHandler::play(*emitter.sound, emitter.priority, emitter.should_loop ? size_t(-1) : 0); // -1 loops forever
+                if (emitter.channel == SoundHandler::no_channel)
+                {
+                    _n_virtual += 1;
+                    i += 1;
+                    continue;
+                }
+
+                emitter.play_count = SoundHandler::_channels[emitter.channel].n_started.load(std::memory_order_acquire);
+                emitter.angle_step = -1;
+                emitter.distance = -1;
+            }
+
+            // clockwise from screen-up, such that +90° is to the right of the listener
+            float dx = _x[i] - listener.x;
+            float dy = _y[i] - listener.y;
+            float angle = std::atan2(dx, -dy) * (180.f / M_PI);
+            if (angle < 0)
+                angle += 360;
+
+            int32_t angle_step = int32_t(std::round(angle / angle_step_size)) % n_angle_steps;
+            int32_t distance = std::min<int32_t>(255, (std::sqrt(_distance_squared[i]) / _hearing_radius) * 255);
+
+            if (angle_step != emitter.angle_step or distance != emitter.distance)
+            {
+                SoundHandler::set_position(emitter.channel, degrees(angle_step * angle_step_size), distance / 255.f);
+                emitter.angle_step = angle_step;
+                emitter.distance = distance;
+                _n_position_updates += 1;
+            }
+
+            i += 1;
+        }
+
+        _n_virtual_total += _n_virtual - n_virtual_before;
+    }
+
+    void AudioEmitterSystem::set_hearing_radius(float radius)
+    {
+        _hearing_radius = radius;
+    }
+
+    float AudioEmitterSystem::get_hearing_radius() const
+    {
+        return _hearing_radius;
+    }
+
+    size_t AudioEmitterSystem::get_n_emitters() const
+    {
+        return _emitters.size();
+    }
+
+    size_t AudioEmitterSystem::get_n_virtual() const
+    {
+        return _n_virtual;
+    }
+
+    size_t AudioEmitterSystem::get_n_position_updates() const
+    {
+        return _n_position_updates;
+    }
+}
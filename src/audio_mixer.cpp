@@ -0,0 +1,571 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <SDL2/SDL_mixer.h>
+
+#include <include/audio_mixer.hpp>
+#include <include/music_handler.hpp>
+#include <include/logging.hpp>
+
+namespace ts
+{
+    namespace detail
+    {
+        // kernels operate on interleaved stereo, n_samples = 2 * n_frames. SSE2 is part of x86-64,
+        // other platforms use the scalar loops, which are also used for the tail of each buffer
+
+        // convert 16-bit samples to float, scale them and add them onto out
+        void mix_s16_into(const int16_t* in, float* out, size_t n_samples, float gain_left, float gain_right)
+        {
+            constexpr float scale = 1.f / 32768;
+            gain_left *= scale;
+            gain_right *= scale;
+
+            size_t i = 0;
+
+            #if defined(__SSE2__)
+            const __m128 gain = _mm_setr_ps(gain_left, gain_right, gain_left, gain_right);
+            for (; i + 8 <= n_samples; i += 8)
+            {
+                // sign-extend by unpacking into the upper half, then shifting down
+                __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                __m128 low = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16));
+                __m128 high = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16));
+
+                _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(low, gain)));
+                _mm_storeu_ps(out + i + 4, _mm_add_ps(_mm_loadu_ps(out + i + 4), _mm_mul_ps(high, gain)));
+            }
+            #endif
+
+            for (; i < n_samples; ++i)
+                out[i] += in[i] * (i % 2 == 0 ? gain_left : gain_right);
+        }
+
+        // convert 16-bit samples to float, overwriting out
+        void convert_s16(const int16_t* in, float* out, size_t n_samples)
+        {
+            std::fill(out, out + n_samples, 0.f);
+            mix_s16_into(in, out, n_samples, 1, 1);
+        }
+
+        // multiply each frame by a gain that changes linearly from `from` to `to` over the buffer
+        void apply_gain_ramp(float* buffer, size_t n_frames, float from, float to)
+        {
+            if (from == 1 and to == 1)
+                return;
+
+            const float step = (to - from) / n_frames;
+            size_t frame = 0;
+
+            #if defined(__SSE2__)
+            __m128 gain = _mm_setr_ps(from, from, from + step, from + step);
+            const __m128 increment = _mm_set1_ps(2 * step);
+            for (; frame + 2 <= n_frames; frame += 2)
+            {
+                float* at = buffer + 2 * frame;
+                _mm_storeu_ps(at, _mm_mul_ps(_mm_loadu_ps(at), gain));
+                gain = _mm_add_ps(gain, increment);
+            }
+            #endif
+
+            for (; frame < n_frames; ++frame)
+            {
+                float gain = from + step * frame;
+                buffer[2 * frame] *= gain;
+                buffer[2 * frame + 1] *= gain;
+            }
+        }
+
+        // recursive across samples, so it is not vectorized
+        void apply_one_pole(float* buffer, size_t n_frames, float coefficient, std::array<float, 2>& state)
+        {
+            float left = state[0];
+            float right = state[1];
+
+            for (size_t frame = 0; frame < n_frames; ++frame)
+            {
+                left += coefficient * (buffer[2 * frame] - left);
+                right += coefficient * (buffer[2 * frame + 1] - right);
+                buffer[2 * frame] = left;
+                buffer[2 * frame + 1] = right;
+            }
+
+            state = {left, right};
+        }
+
+        void add_into(const float* in, float* out, size_t n_samples)
+        {
+            size_t i = 0;
+
+            #if defined(__SSE2__)
+            for (; i + 4 <= n_samples; i += 4)
+                _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_loadu_ps(in + i)));
+            #endif
+
+            for (; i < n_samples; ++i)
+                out[i] += in[i];
+        }
+
+        // largest absolute sample
+        float get_peak(const float* in, size_t n_samples)
+        {
+            float peak = 0;
+            size_t i = 0;
+
+            #if defined(__SSE2__)
+            const __m128 sign = _mm_set1_ps(-0.f);
+            __m128 peaks = _mm_setzero_ps();
+            for (; i + 4 <= n_samples; i += 4)
+                peaks = _mm_max_ps(peaks, _mm_andnot_ps(sign, _mm_loadu_ps(in + i)));
+
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, peaks);
+            peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+            #endif
+
+            for (; i < n_samples; ++i)
+                peak = std::max(peak, std::fabs(in[i]));
+
+            return peak;
+        }
+
+        // apply a gain ramp and convert back to 16-bit, saturating
+        void write_s16(const float* in, int16_t* out, size_t n_samples, float from, float to)
+        {
+            const size_t n_frames = n_samples / 2;
+            const float step = (to - from) / n_frames;
+            constexpr float scale = 32767;
+            size_t frame = 0;
+
+            #if defined(__SSE2__)
+            __m128 gain_low = _mm_mul_ps(_mm_setr_ps(from, from, from + step, from + step), _mm_set1_ps(scale));
+            __m128 gain_high = _mm_add_ps(gain_low, _mm_set1_ps(2 * step * scale));
+            const __m128 increment = _mm_set1_ps(4 * step * scale);
+
+            for (; frame + 4 <= n_frames; frame += 4)
+            {
+                auto i = 2 * frame;
+                __m128i low = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i), gain_low));
+                __m128i high = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i + 4), gain_high));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(low, high));
+
+                gain_low = _mm_add_ps(gain_low, increment);
+                gain_high = _mm_add_ps(gain_high, increment);
+            }
+            #endif
+
+            for (; frame < n_frames; ++frame)
+            {
+                float gain = (from + step * frame) * scale;
+                for (size_t i = 2 * frame; i < 2 * frame + 2; ++i)
+                    out[i] = std::clamp<float>(std::round(in[i] * gain), -32768, 32767);
+            }
+        }
+
+        uint64_t now_ns()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    // ### GAME THREAD ###
+
+    void AudioMixer::enable()
+    {
+        _is_enabled = true;
+
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::MIXER_ENABLE;
+        detail::AudioCommandQueue::push(command);
+    }
+
+    void AudioMixer::disable()
+    {
+        _is_enabled = false;
+
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::MIXER_DISABLE;
+        detail::AudioCommandQueue::push(command);
+    }
+
+    bool AudioMixer::is_enabled()
+    {
+        return _is_enabled;
+    }
+
+    void AudioMixer::set_bus(const Sound& sound, AudioBus bus)
+    {
+        auto guard = std::lock_guard(_bus_lock);
+        _sound_to_bus[sound.get_id()] = bus;
+    }
+
+    AudioBus AudioMixer::get_bus(const Sound& sound)
+    {
+        auto guard = std::lock_guard(_bus_lock);
+        auto it = _sound_to_bus.find(sound.get_id());
+        return it != _sound_to_bus.end() ? it->second : AudioBus::SFX;
+    }
+
+    void AudioMixer::set_bus(const StreamingSound& sound, AudioBus bus)
+    {
+        auto guard = std::lock_guard(_bus_lock);
+        _sound_to_bus[sound.get_id()] = bus;
+    }
+
+    AudioBus AudioMixer::get_bus(const StreamingSound& sound)
+    {
+        auto guard = std::lock_guard(_bus_lock);
+        auto it = _sound_to_bus.find(sound.get_id());
+        return it != _sound_to_bus.end() ? it->second : AudioBus::SFX;
+    }
+
+    void AudioMixer::set_bus_volume(AudioBus bus, float zero_to_one, Time ramp_duration)
+    {
+        zero_to_one = std::clamp(zero_to_one, 0.f, 1.f);
+        _bus_volume.at(size_t(bus)) = zero_to_one;
+
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::MIXER_SET_BUS_VOLUME;
+        command.bus = uint8_t(bus);
+        command.value = zero_to_one;
+        command.duration_ms = ramp_duration.as_milliseconds();
+        detail::AudioCommandQueue::push(command);
+    }
+
+    float AudioMixer::get_bus_volume(AudioBus bus)
+    {
+        return _bus_volume.at(size_t(bus));
+    }
+
+    void AudioMixer::set_bus_low_pass(AudioBus bus, float cutoff_hz)
+    {
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::MIXER_SET_BUS_LOW_PASS;
+        command.bus = uint8_t(bus);
+        command.value = std::max(cutoff_hz, 0.f);
+        detail::AudioCommandQueue::push(command);
+    }
+
+    void AudioMixer::set_limiter_threshold(float zero_to_one)
+    {
+        if (zero_to_one <= 0 or zero_to_one > 1)
+        {
+            Log::warning("In ts::AudioMixer::set_limiter_threshold: threshold ", zero_to_one, " is outside (0, 1], instead using 1");
+            zero_to_one = 1;
+        }
+
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::MIXER_SET_LIMITER;
+        command.value = zero_to_one;
+        detail::AudioCommandQueue::push(command);
+    }
+
+    Time AudioMixer::get_callback_budget()
+    {
+        auto frequency = _frequency.load();
+        if (frequency == 0)
+            return seconds(0);
+
+        return seconds(double(_n_frames_per_callback) / frequency);
+    }
+
+    Time AudioMixer::get_last_callback_duration()
+    {
+        return nanoseconds(_last_ns);
+    }
+
+    Time AudioMixer::get_average_callback_duration()
+    {
+        auto n = _n_callbacks.load();
+        return nanoseconds(n > 0 ? _total_ns / n : 0);
+    }
+
+    Time AudioMixer::get_max_callback_duration()
+    {
+        return nanoseconds(_max_ns);
+    }
+
+    size_t AudioMixer::get_n_callbacks()
+    {
+        return _n_callbacks;
+    }
+
+    void AudioMixer::reset_callback_statistics()
+    {
+        _last_ns = 0;
+        _max_ns = 0;
+        _total_ns = 0;
+        _n_callbacks = 0;
+    }
+
+    // ### COMMANDS ###
+
+    void AudioMixer::apply_enable()
+    {
+        if (_is_active)
+            return;
+
+        int frequency = 0;
+        uint16_t format = 0;
+        int n_output_channels = 0;
+
+        if (Mix_QuerySpec(&frequency, &format, &n_output_channels) == 0)
+        {
+            Log::warning("In ts::AudioMixer::enable: audio device is not open, the mixer stays disabled");
+            _is_enabled = false;
+            return;
+        }
+
+        if (format != AUDIO_S16SYS or n_output_channels != 2)
+        {
+            Log::warning("In ts::AudioMixer::enable: only 16-bit stereo output is supported, the mixer stays disabled");
+            _is_enabled = false;
+            return;
+        }
+
+        _frequency = frequency;
+        for (auto& bus : _buses)
+        {
+            bus.filter_state = {0, 0};
+            apply_bus_low_pass(AudioBus(&bus - _buses.data()), bus.cutoff_hz); // coefficient depends on the frequency
+        }
+
+        for (size_t channel = 0; channel < _channels.size(); ++channel)
+        {
+            auto& state = _channels[channel];
+
+            // remove SDL_mixers own panning, the mixer pans by itself
+            if (state.angle != 0 or state.distance != 0)
+                Mix_SetPosition(channel, 0, 0);
+
+            if (Mix_Playing(channel) and not state.is_registered)
+                state.is_registered = Mix_RegisterEffect(channel, &on_channel_effect, &on_channel_effect_done, nullptr) != 0;
+        }
+
+        // called by ts::AudioDevice, which owns the post-mix hook
+        _is_active = true;
+    }
+
+    void AudioMixer::apply_disable()
+    {
+        if (not _is_active)
+            return;
+
+        for (size_t channel = 0; channel < _channels.size(); ++channel)
+        {
+            auto& state = _channels[channel];
+            if (state.is_registered)
+            {
+                Mix_UnregisterEffect(channel, &on_channel_effect);
+                state.is_registered = false;
+            }
+
+            if (Mix_Playing(channel) and (state.angle != 0 or state.distance != 0))
+                Mix_SetPosition(channel, state.angle, state.distance);
+        }
+
+        for (size_t i = 0; i < n_buses; ++i)
+        {
+            _bus_buffers[i].fill(0);
+            _buses[i].is_used = false;
+        }
+
+        _limiter_gain = 1;
+        _is_active = false;
+    }
+
+    void AudioMixer::on_play(size_t channel, Mix_Chunk* chunk, AudioBus bus)
+    {
+        auto& state = _channels[channel];
+        state.chunk = chunk;
+        state.bus = bus;
+
+        // SDL_mixer resets panning when a channel finishes, so does the mixer
+        set_channel_position(channel, 0, 0);
+
+        // playing removed all effects of the channel
+        state.is_registered = false;
+        if (_is_active)
+            state.is_registered = Mix_RegisterEffect(channel, &on_channel_effect, &on_channel_effect_done, nullptr) != 0;
+    }
+
+    void AudioMixer::set_channel_position(size_t channel, float angle_degrees, uint8_t distance)
+    {
+        auto& state = _channels[channel];
+        state.angle = angle_degrees;
+        state.distance = distance;
+
+        // equal power, 0° is in front, 90° to the right, same as Mix_SetPosition. Scaled such that the center is at unity
+        static constexpr float pi = 3.14159265358979f;
+        float pan = std::sin(angle_degrees * pi / 180);
+        float theta = (pan + 1) * pi / 4;
+        float attenuation = (255 - distance) / 255.f;
+
+        state.gain_left = std::min(1.f, std::sqrt(2.f) * std::cos(theta)) * attenuation;
+        state.gain_right = std::min(1.f, std::sqrt(2.f) * std::sin(theta)) * attenuation;
+    }
+
+    void AudioMixer::apply_bus_volume(AudioBus id, float zero_to_one, int32_t ramp_ms)
+    {
+        auto& bus = _buses.at(size_t(id));
+        int frequency = _frequency > 0 ? _frequency.load() : MusicHandler::sample_rate;
+
+        // at least one frame, such that the change is spread across the next callback
+        float n_frames = std::max(1.f, ramp_ms * frequency / 1000.f);
+        bus.target_gain = zero_to_one;
+        bus.gain_per_frame = std::fabs(bus.target_gain - bus.gain) / n_frames;
+    }
+
+    void AudioMixer::apply_bus_low_pass(AudioBus id, float cutoff_hz)
+    {
+        auto& bus = _buses.at(size_t(id));
+        float frequency = _frequency > 0 ? _frequency.load() : MusicHandler::sample_rate;
+
+        bus.cutoff_hz = cutoff_hz;
+        if (cutoff_hz <= 0 or cutoff_hz >= frequency / 2)
+            bus.low_pass = 1;
+        else
+            bus.low_pass = 1 - std::exp(-2 * 3.14159265358979f * cutoff_hz / frequency);
+    }
+
+    void AudioMixer::apply_limiter_threshold(float threshold)
+    {
+        _limiter_threshold = threshold;
+    }
+
+    // ### AUDIO THREAD ###
+
+    void AudioMixer::begin_callback()
+    {
+        if (not _callback_started)
+        {
+            _callback_start_ns = detail::now_ns();
+            _callback_started = true;
+        }
+    }
+
+    void AudioMixer::on_channel_effect_done(int channel, void*)
+    {
+        _channels[channel].is_registered = false;
+    }
+
+    void AudioMixer::on_channel_effect(int channel, void* stream, int length, void*)
+    {
+        if (not _is_active)
+            return;
+
+        begin_callback();
+
+        auto& state = _channels[channel];
+        if (state.generation != _generation)
+        {
+            state.generation = _generation;
+            state.offset = 0;
+        }
+
+        size_t n_samples = length / sizeof(int16_t);
+        if (state.offset + n_samples > 2 * max_n_frames)
+            return; // left to SDL_mixer
+
+        // channel volume includes the current fade, both are applied by SDL_mixer after the effects, which now only see silence
+        float volume = Mix_Volume(channel, -1) / float(MIX_MAX_VOLUME);
+        if (state.chunk != nullptr)
+            volume *= state.chunk->volume / float(MIX_MAX_VOLUME);
+
+        auto bus = size_t(state.bus);
+        detail::mix_s16_into(static_cast<int16_t*>(stream), _bus_buffers[bus].data() + state.offset, n_samples, volume * state.gain_left, volume * state.gain_right);
+        _buses[bus].is_used = true;
+
+        state.offset += n_samples;
+        std::memset(stream, 0, length);
+    }
+
+    void AudioMixer::on_post_mix(void*, uint8_t* stream, int length)
+    {
+        if (not _is_active)
+            return;
+
+        begin_callback();
+
+        size_t n_samples = length / sizeof(int16_t);
+        size_t n_frames = n_samples / 2;
+
+        if (n_samples > 2 * max_n_frames or n_frames == 0)
+        {
+            _generation += 1;
+            _callback_started = false;
+            return;
+        }
+
+        auto* output = reinterpret_cast<int16_t*>(stream);
+
+        // channels routed through the mixer added silence, so what SDL_mixer produced is the music
+        detail::convert_s16(output, _bus_buffers[size_t(AudioBus::MUSIC)].data(), n_samples);
+        _buses[size_t(AudioBus::MUSIC)].is_used = true;
+
+        std::fill(_master.begin(), _master.begin() + n_samples, 0.f);
+
+        for (size_t i = 0; i < n_buses; ++i)
+        {
+            auto& bus = _buses[i];
+
+            float from = bus.gain;
+            float delta = bus.gain_per_frame * n_frames;
+            float to = bus.target_gain > from ? std::min(bus.target_gain, from + delta) : std::max(bus.target_gain, from - delta);
+            bus.gain = to;
+
+            if (not bus.is_used)
+                continue;
+
+            auto* buffer = _bus_buffers[i].data();
+
+            if (bus.low_pass < 1)
+                detail::apply_one_pole(buffer, n_frames, bus.low_pass, bus.filter_state);
+
+            detail::apply_gain_ramp(buffer, n_frames, from, to);
+            detail::add_into(buffer, _master.data(), n_samples);
+
+            std::fill(buffer, buffer + n_samples, 0.f);
+            bus.is_used = false;
+        }
+
+        // peak limiter: attack within one buffer, release over ~100ms
+        float peak = detail::get_peak(_master.data(), n_samples);
+        float needed = peak > _limiter_threshold ? _limiter_threshold / peak : 1;
+        float from = _limiter_gain;
+        float to = needed;
+
+        if (needed > from)
+        {
+            float release = 1 - std::exp(-float(n_frames) / (0.1f * _frequency));
+            to = from + (needed - from) * release;
+        }
+
+        detail::write_s16(_master.data(), output, n_samples, from, to);
+        _limiter_gain = to;
+
+        // statistics
+        uint64_t duration = detail::now_ns() - _callback_start_ns;
+        _last_ns = duration;
+        if (duration > _max_ns)
+            _max_ns = duration;
+
+        _total_ns += duration;
+        _n_callbacks += 1;
+        _n_frames_per_callback = n_frames;
+
+        _generation += 1;
+        _callback_started = false;
+    }
+}
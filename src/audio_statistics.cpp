@@ -0,0 +1,154 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#include <algorithm>
+#include <fstream>
+
+#include <include/audio_statistics.hpp>
+#include <include/sound_handler.hpp>
+#include <include/music_handler.hpp>
+#include <include/music_playlist.hpp>
+#include <include/audio_emitter_system.hpp>
+#include <include/logging.hpp>
+
+namespace ts
+{
+    void AudioStatistics::on_commands_applied(size_t n)
+    {
+        _n_commands += n;
+    }
+
+    void AudioStatistics::on_callback(uint64_t cpu_ns, uint64_t budget_ns, bool is_late)
+    {
+        auto guard = std::lock_guard(_window_lock);
+
+        _window.min_ns = std::min(_window.min_ns, cpu_ns);
+        _window.max_ns = std::max(_window.max_ns, cpu_ns);
+        _window.total_ns += cpu_ns;
+        _window.n_callbacks += 1;
+        _window.budget_ns = budget_ns;
+
+        if (is_late)
+            _window.n_late += 1;
+    }
+
+    void AudioStatistics::update()
+    {
+        auto window = detail::CallbackWindow();
+        {
+            auto guard = std::lock_guard(_window_lock);
+            window = _window;
+            _window = detail::CallbackWindow();
+            _window.budget_ns = window.budget_ns;
+        }
+
+        auto out = AudioFrameStatistics();
+        out.frame_duration = _frame_clock.restart();
+
+        for (size_t i = 0; i < SoundHandler::n_channels; ++i)
+            if (SoundHandler::is_busy(i))
+                out.n_active_voices += 1;
+
+        out.n_virtual_voices = AudioEmitterSystem::_n_virtual_total;
+        out.is_music_playing = MusicHandler::is_playing() or MusicPlaylist::is_playing();
+        out.n_commands = _n_commands.exchange(0);
+
+        out.n_callbacks = window.n_callbacks;
+        out.min_callback_duration = nanoseconds(window.n_callbacks > 0 ? window.min_ns : 0);
+        out.average_callback_duration = nanoseconds(window.n_callbacks > 0 ? window.total_ns / window.n_callbacks : 0);
+        out.max_callback_duration = nanoseconds(window.max_ns);
+        out.callback_budget = nanoseconds(window.budget_ns);
+        out.n_underruns = window.n_late;
+
+        size_t n_stolen = SoundHandler::get_n_stolen_voices();
+
+        auto guard = std::lock_guard(_history_lock);
+
+        // the counter of the handler only increases, the first frame after a reset starts from the current value
+        out.n_stolen_voices = _n_frames > 0 ? n_stolen - _last_n_stolen : 0;
+        _last_n_stolen = n_stolen;
+
+        out.frame = _n_frames;
+        _history[_n_frames % history_size] = out;
+        _n_frames += 1;
+        _n_underruns += out.n_underruns;
+    }
+
+    AudioFrameStatistics AudioStatistics::get_last_frame()
+    {
+        auto guard = std::lock_guard(_history_lock);
+        return _n_frames > 0 ? _history[(_n_frames - 1) % history_size] : AudioFrameStatistics();
+    }
+
+    std::vector<AudioFrameStatistics> AudioStatistics::get_history()
+    {
+        auto guard = std::lock_guard(_history_lock);
+
+        size_t n = std::min(_n_frames, history_size);
+        auto out = std::vector<AudioFrameStatistics>();
+        out.reserve(n);
+
+        for (size_t i = _n_frames - n; i < _n_frames; ++i)
+            out.push_back(_history[i % history_size]);
+
+        return out;
+    }
+
+    size_t AudioStatistics::get_n_underruns()
+    {
+        auto guard = std::lock_guard(_history_lock);
+        return _n_underruns;
+    }
+
+    void AudioStatistics::reset()
+    {
+        {
+            auto guard = std::lock_guard(_window_lock);
+            _window = detail::CallbackWindow();
+        }
+
+        _n_commands = 0;
+
+        auto guard = std::lock_guard(_history_lock);
+        _n_frames = 0;
+        _n_underruns = 0;
+        _last_n_stolen = 0;
+        _frame_clock.restart();
+    }
+
+    bool AudioStatistics::export_csv(const std::string& path)
+    {
+        auto history = get_history();
+        auto file = std::ofstream(path, std::ios::trunc);
+
+        file << "frame,frame_duration_ms,n_active_voices,n_virtual_voices,n_stolen_voices,is_music_playing,n_commands,"
+             << "n_callbacks,min_callback_us,average_callback_us,max_callback_us,callback_budget_us,n_underruns\n";
+
+        for (auto& frame : history)
+        {
+            file << frame.frame << ","
+                 << frame.frame_duration.as_milliseconds() << ","
+                 << frame.n_active_voices << ","
+                 << frame.n_virtual_voices << ","
+                 << frame.n_stolen_voices << ","
+                 << frame.is_music_playing << ","
+                 << frame.n_commands << ","
+                 << frame.n_callbacks << ","
+                 << frame.min_callback_duration.as_microseconds() << ","
+                 << frame.average_callback_duration.as_microseconds() << ","
+                 << frame.max_callback_duration.as_microseconds() << ","
+                 << frame.callback_budget.as_microseconds() << ","
+                 << frame.n_underruns << "\n";
+        }
+
+        if (not file)
+        {
+            Log::warning("In ts::AudioStatistics::export_csv: unable to write \"", path, "\"");
+            return false;
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,352 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#include <array>
+#include <cmath>
+#include <algorithm>
+#include <exception>
+#include <functional>
+
+#include <include/collision_compound.hpp>
+#include <include/physics_world.hpp>
+
+namespace ts
+{
+    namespace detail
+    {
+        // > 0 if o, a, b are in counter-clockwise order, 0 if collinear
+        static float cross(Vector2f o, Vector2f a, Vector2f b)
+        {
+            return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+        }
+
+        static float signed_area(const std::vector<Vector2f>& vertices)
+        {
+            float out = 0;
+            for (size_t i = 0; i < vertices.size(); ++i)
+            {
+                auto& a = vertices.at(i);
+                auto& b = vertices.at((i + 1) % vertices.size());
+                out += a.x * b.y - b.x * a.y;
+            }
+            return out / 2.f;
+        }
+
+        static inline constexpr float collinear_epsilon = 1e-4;
+
+        static bool is_convex(const std::vector<Vector2f>& vertices)
+        {
+            size_t n = vertices.size();
+            for (size_t i = 0; i < n; ++i)
+                if (cross(vertices.at((i + n - 1) % n), vertices.at(i), vertices.at((i + 1) % n)) < -collinear_epsilon)
+                    return false;
+
+            return true;
+        }
+
+        static bool is_in_triangle(Vector2f point, Vector2f a, Vector2f b, Vector2f c)
+        {
+            return cross(a, b, point) >= 0 and cross(b, c, point) >= 0 and cross(c, a, point) >= 0;
+        }
+
+        static size_t hash_outline(const std::vector<Vector2f>& vertices)
+        {
+            size_t seed = vertices.size();
+            for (auto& v : vertices)
+            {
+                seed ^= std::hash<float>()(v.x) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                seed ^= std::hash<float>()(v.y) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            }
+            return seed;
+        }
+    }
+
+    std::vector<std::vector<Vector2f>> CollisionCompound::decompose_uncached(std::vector<Vector2f> vertices)
+    {
+        if (vertices.size() > 1 and vertices.front() == vertices.back())
+            vertices.pop_back(); // closing vertex is implicit
+
+        // remove duplicate and collinear vertices, they would produce degenerate pieces
+        bool changed = true;
+        while (changed and vertices.size() >= 3)
+        {
+            changed = false;
+            size_t n = vertices.size();
+            for (size_t i = 0; i < n; ++i)
+            {
+                auto& previous = vertices.at((i + n - 1) % n);
+                auto& next = vertices.at((i + 1) % n);
+
+                if (std::abs(detail::cross(previous, vertices.at(i), next)) < detail::collinear_epsilon)
+                {
+                    vertices.erase(vertices.begin() + i);
+                    changed = true;
+                    break;
+                }
+            }
+        }
+
+        if (vertices.size() < 3)
+            throw std::invalid_argument("In ts::CollisionCompound::decompose: polygon needs to have at least 3 non-collinear vertices.");
+
+        if (detail::signed_area(vertices) < 0)
+            std::reverse(vertices.begin(), vertices.end());
+
+        if (vertices.size() <= 8 and detail::is_convex(vertices))
+            return {vertices};
+
+        // triangulate by ear clipping
+
+        std::vector<std::vector<size_t>> pieces;
+        pieces.reserve(vertices.size() - 2);
+
+        std::vector<size_t> remaining(vertices.size());
+        for (size_t i = 0; i < remaining.size(); ++i)
+            remaining.at(i) = i;
+
+        while (remaining.size() > 3)
+        {
+            size_t n = remaining.size();
+            bool found = false;
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                auto previous = remaining.at((i + n - 1) % n);
+                auto current = remaining.at(i);
+                auto next = remaining.at((i + 1) % n);
+
+                auto& a = vertices.at(previous);
+                auto& b = vertices.at(current);
+                auto& c = vertices.at(next);
+
+                if (detail::cross(a, b, c) <= 0)
+                    continue; // reflex vertex, not an ear
+
+                bool is_ear = true;
+                for (auto other : remaining)
+                {
+                    if (other == previous or other == current or other == next)
+                        continue;
+
+                    if (detail::is_in_triangle(vertices.at(other), a, b, c))
+                    {
+                        is_ear = false;
+                        break;
+                    }
+                }
+
+                if (is_ear)
+                {
+                    pieces.push_back({previous, current, next});
+                    remaining.erase(remaining.begin() + i);
+                    found = true;
+                    break;
+                }
+            }
+
+            if (not found)
+                throw std::invalid_argument("In ts::CollisionCompound::decompose: unable to triangulate polygon, its outline may not intersect itself.");
+        }
+        pieces.push_back(remaining);
+
+        // Hertel-Mehlhorn: remove diagonals between pieces as long as the union stays convex,
+        // pieces are capped at 8 vertices, the maximum box2d supports for a single polygon
+
+        auto to_positions = [&](const std::vector<size_t>& indices) -> std::vector<Vector2f> {
+            std::vector<Vector2f> out;
+            out.reserve(indices.size());
+            for (auto i : indices)
+                out.push_back(vertices.at(i));
+            return out;
+        };
+
+        auto try_merge = [&](const std::vector<size_t>& p, const std::vector<size_t>& q, std::vector<size_t>& out) -> bool
+        {
+            if (p.size() + q.size() - 2 > 8)
+                return false;
+
+            for (size_t k = 0; k < p.size(); ++k)
+            {
+                auto p_from = p.at(k);
+                auto p_to = p.at((k + 1) % p.size());
+
+                for (size_t l = 0; l < q.size(); ++l)
+                {
+                    // shared diagonal is traversed in opposite directions
+                    if (q.at(l) != p_to or q.at((l + 1) % q.size()) != p_from)
+                        continue;
+
+                    out.clear();
+                    for (size_t i = 0; i < p.size(); ++i)
+                        out.push_back(p.at((k + 1 + i) % p.size()));
+
+                    for (size_t i = 2; i < q.size(); ++i)
+                        out.push_back(q.at((l + i) % q.size()));
+
+                    return detail::is_convex(to_positions(out));
+                }
+            }
+
+            return false;
+        };
+
+        std::vector<size_t> merged;
+        bool any_merged = true;
+        while (any_merged)
+        {
+            any_merged = false;
+            for (size_t i = 0; i < pieces.size() and not any_merged; ++i)
+            {
+                for (size_t j = i + 1; j < pieces.size(); ++j)
+                {
+                    if (try_merge(pieces.at(i), pieces.at(j), merged))
+                    {
+                        pieces.at(i) = merged;
+                        pieces.erase(pieces.begin() + j);
+                        any_merged = true;
+                        break;
+                    }
+                }
+            }
+        }
+
+        std::vector<std::vector<Vector2f>> out;
+        out.reserve(pieces.size());
+        for (auto& piece : pieces)
+            out.push_back(to_positions(piece));
+
+        return out;
+    }
+
+    std::vector<std::vector<Vector2f>> CollisionCompound::decompose_local(const std::vector<Vector2f>& vertices)
+    {
+        auto hash = detail::hash_outline(vertices);
+
+        {
+            auto lock = std::lock_guard(_cache_lock);
+            auto it = _decomposition_cache.find(hash);
+            if (it != _decomposition_cache.end() and it->second.outline == vertices)
+                return it->second.pieces;
+        }
+
+        auto pieces = decompose_uncached(vertices);
+
+        auto lock = std::lock_guard(_cache_lock);
+
+        // bounded, such that creating many unique outlines over time does not grow the cache indefinitely
+        if (_decomposition_cache.size() >= decomposition_cache_capacity and _decomposition_cache.find(hash) == _decomposition_cache.end())
+            _decomposition_cache.erase(_decomposition_cache.begin());
+
+        _decomposition_cache.insert_or_assign(hash, CacheEntry{vertices, pieces});
+        return pieces;
+    }
+
+    std::vector<std::vector<Vector2f>> CollisionCompound::decompose(const std::vector<Vector2f>& vertices)
+    {
+        if (vertices.empty())
+            return {};
+
+        auto center = Vector2f(0, 0);
+        for (auto& v : vertices)
+            center += v;
+        center /= Vector2f(vertices.size(), vertices.size());
+
+        auto local = std::vector<Vector2f>();
+        local.reserve(vertices.size());
+        for (auto& v : vertices)
+            local.push_back(v - center);
+
+        auto out = decompose_local(local);
+        for (auto& piece : out)
+            for (auto& v : piece)
+                v += center;
+
+        return out;
+    }
+
+    void CollisionCompound::clear_decomposition_cache()
+    {
+        auto lock = std::lock_guard(_cache_lock);
+        _decomposition_cache.clear();
+    }
+
+    CollisionCompound::CollisionCompound(PhysicsWorld* world, CollisionType type, const std::vector<Vector2f>& vertices)
+        : CollisionShape(world, type, [&]() -> Vector2f {
+
+            if (vertices.size() < 3)
+                throw std::invalid_argument("In ts::CollisionCompound Constructor: at least 3 vertices need to be specified.");
+
+            auto out = Vector2f(0, 0);
+            for (auto& v : vertices)
+                out += v;
+
+            return out / Vector2f(vertices.size(), vertices.size());
+        }())
+    {
+        _center = Vector2f(0, 0);
+        for (auto& v : vertices)
+            _center += v;
+        _center /= Vector2f(vertices.size(), vertices.size());
+
+        auto local = std::vector<Vector2f>();
+        local.reserve(vertices.size());
+        for (auto& v : vertices)
+            local.push_back(v - _center);
+
+        _pieces = decompose_local(local);
+        _shapes.resize(_pieces.size());
+        _subsequent_fixtures.reserve(_pieces.size());
+
+        auto points = std::vector<b2Vec2>();
+        points.reserve(8);
+
+        for (size_t i = 0; i < _pieces.size(); ++i)
+        {
+            points.clear();
+            for (auto& v : _pieces.at(i))
+            {
+                auto point = _world->world_to_native(v);
+                points.emplace_back(point.x, point.y);
+            }
+
+            auto& shape = _shapes.at(i);
+            shape.Set(points.data(), points.size());
+            shape.m_radius = _world->get_skin_radius();
+
+            auto def = create_fixture_def(&shape);
+            _subsequent_fixtures.push_back(_body->CreateFixture(&def));
+        }
+
+        _fixture = _subsequent_fixtures.front();
+    }
+
+    std::vector<std::vector<Vector2f>> CollisionCompound::get_pieces() const
+    {
+        auto out = _pieces;
+        for (auto& piece : out)
+            for (auto& v : piece)
+                v += _center;
+
+        return out;
+    }
+
+    size_t CollisionCompound::get_n_pieces() const
+    {
+        return _pieces.size();
+    }
+
+    b2Shape* CollisionCompound::get_native_shape()
+    {
+        return &_shapes.front();
+    }
+
+    void CollisionCompound::on_fixtures_moved(const FixtureMap& fixtures)
+    {
+        for (auto& fixture : _subsequent_fixtures)
+            for (auto& pair : fixtures)
+                if (pair.first == fixture)
+                    fixture = pair.second;
+    }
+}
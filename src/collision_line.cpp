@@ -14,12 +14,11 @@ namespace ts
     {
         if (type == ts::DYNAMIC)
         {
-            static bool once = false;
+            static std::atomic<bool> once = false; // worlds may be constructed from multiple threads
 
-            if (not once)
+            if (not once.exchange(true))
             {
                 Log::warning("In ts::CollisionLine Constructor: collision lines cannot be dynamic because they have no volume. Type will be set to ts::KINEMATIC instead.");
-                once = true;
             }
 
             type = ts::KINEMATIC;
@@ -7,14 +7,163 @@
 #include <include/physics_world.hpp>
 
 #include <exception>
+#include <algorithm>
+#include <cmath>
 
 namespace ts
 {
+    namespace detail
+    {
+        // distance between point and the line segment a-b
+        static float distance_to_segment(Vector2f point, Vector2f a, Vector2f b)
+        {
+            auto ab = b - a;
+            auto length_squared = glm::dot(ab, ab);
+            if (length_squared == 0)
+                return glm::distance(point, a);
+
+            auto t = std::clamp(glm::dot(point - a, ab) / length_squared, 0.f, 1.f);
+            return glm::distance(point, a + ab * Vector2f(t, t));
+        }
+
+        static inline constexpr float collinear_tolerance = 1e-3; // world units
+    }
+
+    std::vector<Vector2f> CollisionLineSequence::simplify(const std::vector<Vector2f>& vertices, float tolerance)
+    {
+        if (vertices.size() <= 2)
+            return vertices;
+
+        // remove duplicate and collinear vertices
+        auto merged = std::vector<Vector2f>();
+        merged.reserve(vertices.size());
+        merged.push_back(vertices.front());
+
+        for (size_t i = 1; i < vertices.size(); ++i)
+        {
+            auto& current = vertices.at(i);
+            if (glm::distance(current, merged.back()) < detail::collinear_tolerance)
+                continue;
+
+            // next vertex that is not a duplicate of current
+            size_t next_i = i + 1;
+            while (next_i < vertices.size() and glm::distance(vertices.at(next_i), current) < detail::collinear_tolerance)
+                next_i += 1;
+
+            if (next_i < vertices.size())
+            {
+                auto& previous = merged.back();
+                auto& next = vertices.at(next_i);
+
+                // only merge if current lies between its neighbors, otherwise the line folds back onto itself
+                if (detail::distance_to_segment(current, previous, next) < detail::collinear_tolerance and glm::dot(current - previous, next - current) > 0)
+                    continue;
+            }
+
+            merged.push_back(current);
+        }
+
+        if (merged.size() <= 2 or tolerance <= 0)
+            return merged;
+
+        // Ramer-Douglas-Peucker, iterative to not overflow the stack for traced outlines
+        auto keep = std::vector<bool>(merged.size(), false);
+        keep.front() = true;
+        keep.back() = true;
+
+        auto ranges = std::vector<std::pair<size_t, size_t>>{{0, merged.size() - 1}};
+        while (not ranges.empty())
+        {
+            auto [first, last] = ranges.back();
+            ranges.pop_back();
+
+            float max_distance = 0;
+            size_t max_index = first;
+            for (size_t i = first + 1; i < last; ++i)
+            {
+                auto distance = detail::distance_to_segment(merged.at(i), merged.at(first), merged.at(last));
+                if (distance > max_distance)
+                {
+                    max_distance = distance;
+                    max_index = i;
+                }
+            }
+
+            if (max_distance > tolerance)
+            {
+                keep.at(max_index) = true;
+                ranges.push_back({first, max_index});
+                ranges.push_back({max_index, last});
+            }
+        }
+
+        auto out = std::vector<Vector2f>();
+        for (size_t i = 0; i < merged.size(); ++i)
+            if (keep.at(i))
+                out.push_back(merged.at(i));
+
+        return out;
+    }
+
+    std::vector<std::vector<Vector2f>> CollisionLineSequence::join(const std::vector<std::vector<Vector2f>>& sequences, float tolerance)
+    {
+        auto out = std::vector<std::vector<Vector2f>>();
+        auto used = std::vector<bool>(sequences.size(), false);
+
+        auto is_equal = [&](Vector2f a, Vector2f b) -> bool {
+            return glm::distance(a, b) <= tolerance;
+        };
+
+        for (size_t i = 0; i < sequences.size(); ++i)
+        {
+            if (used.at(i) or sequences.at(i).empty())
+                continue;
+
+            used.at(i) = true;
+            auto current = sequences.at(i);
+
+            // extend at the end, then at the start, until no sequence fits anymore
+            bool extended = true;
+            while (extended)
+            {
+                extended = false;
+                for (size_t j = 0; j < sequences.size(); ++j)
+                {
+                    auto& other = sequences.at(j);
+                    if (used.at(j) or other.empty())
+                        continue;
+
+                    if (is_equal(current.back(), other.front()))
+                    {
+                        current.insert(current.end(), other.begin() + 1, other.end());
+                        used.at(j) = true;
+                        extended = true;
+                    }
+                    else if (is_equal(other.back(), current.front()))
+                    {
+                        current.insert(current.begin(), other.begin(), other.end() - 1);
+                        used.at(j) = true;
+                        extended = true;
+                    }
+                }
+            }
+
+            // close the outline exactly, such that it is simulated as a loop
+            if (current.size() > 3 and is_equal(current.back(), current.front()))
+                current.back() = current.front();
+
+            out.push_back(std::move(current));
+        }
+
+        return out;
+    }
+
     CollisionLineSequence::CollisionLineSequence(
             PhysicsWorld *world,
             CollisionType type,
             const std::vector<Vector2f>& vertices,
-            bool two_sided)
+            bool two_sided,
+            float simplification_tolerance)
             : CollisionShape(world, type, [&]() -> Vector2f {
 
         if (vertices.size() < 2)
@@ -30,58 +179,138 @@ namespace ts
     {
         if (type == ts::DYNAMIC)
         {
-            static bool once = false;
+            static std::atomic<bool> once = false; // worlds may be constructed from multiple threads
 
-            if (not once)
+            if (not once.exchange(true))
             {
                 Log::warning("In ts::CollisionLineSequence Constructor: collision lines cannot be dynamic because they have no volume. Type will be set to ts::KINEMATIC instead.");
-                once = true;
             }
 
             type = ts::KINEMATIC;
         }
 
+        // center of the unsimplified vertices, the body was already created there
         auto center = Vector2f(0, 0);
         size_t n = vertices.size() - 1;
         for (size_t i = 0; i < n; ++i)
             center += (vertices.at(i) + vertices.at(i+1)) / Vector2f(2, 2);
         center /= Vector2f(n, n);
 
-        for (size_t i = 0; i < n; ++i)
+        _vertices = simplification_tolerance > 0 ? simplify(vertices, simplification_tolerance) : vertices;
+
+        if (_vertices.size() < 2)
+            throw std::invalid_argument("In CollisionLineSequence Constructor: all vertices are at the same position, at least 2 distinct vertices are needed.");
+
+        if (not two_sided)
         {
-            auto previous = i != 0 ? vertices.at(i-1) : vertices.at(0);
-            auto next = i != vertices.size() - 1 ? vertices.at(i+1) : vertices.back();
+            // one-sided: single chain, box2d handles the ghost vertices between neighboring lines itself.
+            // An outline whose last vertex is the first is closed explicitly, such that it is simulated as a loop
 
-            auto a = vertices.at(i);
-            auto b = vertices.at(i+1);
+            bool is_closed = _vertices.size() > 3 and _vertices.front() == _vertices.back();
+            size_t n_open = is_closed ? _vertices.size() - 1 : _vertices.size();
 
-            _shape = b2EdgeShape();
-            a = _world->world_to_native(a - center);
-            b = _world->world_to_native(b - center);
-            next = _world->world_to_native(next - center);
-            previous = _world->world_to_native(previous - center);
+            auto points = std::vector<b2Vec2>();
+            auto kept = std::vector<Vector2f>();
+            points.reserve(_vertices.size());
+            kept.reserve(_vertices.size());
 
-            if (two_sided)
+            // box2d requires chain vertices to be further apart than b2_linearSlop
+            auto is_too_close = [](b2Vec2 a, b2Vec2 b) {
+                return b2DistanceSquared(a, b) <= b2_linearSlop * b2_linearSlop;
+            };
+
+            size_t n_removed = 0;
+            for (size_t i = 0; i < n_open; ++i)
             {
-                _shape.SetTwoSided(b2Vec2(a.x, a.y), b2Vec2(b.x, b.y));
+                auto native = _world->world_to_native(_vertices.at(i) - center);
+                auto point = b2Vec2(native.x, native.y);
+
+                if (not points.empty() and is_too_close(point, points.back()))
+                {
+                    n_removed += 1;
+                    continue;
+                }
+
+                points.push_back(point);
+                kept.push_back(_vertices.at(i));
             }
-            else
+
+            while (is_closed and points.size() > 1 and is_too_close(points.back(), points.front()))
             {
-                _shape.SetOneSided(
-                        b2Vec2(previous.x, previous.y),
-                        b2Vec2(a.x, a.y),
-                        b2Vec2(b.x, b.y),
-                        b2Vec2(next.x, next.y));
+                points.pop_back();
+                kept.pop_back();
+                n_removed += 1;
             }
 
+            if (n_removed > 0)
+                Log::warning("In ts::CollisionLineSequence Constructor: ", n_removed, " vertices are closer than ", b2_linearSlop * _world->pixel_ratio, " to their predecessor, which box2d does not support for one-sided lines. They were removed, c.f. ts::CollisionLineSequence::get_vertices");
+
+            if (is_closed)
+                kept.push_back(kept.front());
+
+            // vertices are reported as simulated
+            _vertices = std::move(kept);
+
+            auto chain = b2ChainShape();
+            if (is_closed and points.size() >= 3)
+            {
+                chain.CreateLoop(points.data(), points.size());
+                _n_edges = points.size();
+            }
+            else if (not is_closed and points.size() >= 2)
+            {
+                auto previous = points.at(0) + (points.at(0) - points.at(1));
+                auto next = points.back() + (points.back() - points.at(points.size() - 2));
+                chain.CreateChain(points.data(), points.size(), previous, next);
+                _n_edges = points.size() - 1;
+            }
+            else
+                throw std::invalid_argument("In CollisionLineSequence Constructor: all vertices are too close together, at least 2 distinct vertices are needed, or 3 for a closed outline.");
+
+            // the fixture stores a deep copy of the chain
+            auto def = create_fixture_def(&chain);
+            _fixture = _body->CreateFixture(&def);
+            _subsequent_fixtures.push_back(_fixture);
+            return;
+        }
+
+        // two-sided: one edge per line, box2d chains are always one-sided
+        for (size_t i = 0; i + 1 < _vertices.size(); ++i)
+        {
+            auto a = _world->world_to_native(_vertices.at(i) - center);
+            auto b = _world->world_to_native(_vertices.at(i+1) - center);
+
+            _shape = b2EdgeShape();
+            _shape.SetTwoSided(b2Vec2(a.x, a.y), b2Vec2(b.x, b.y));
+
             auto def = create_fixture_def(&_shape);
             _subsequent_fixtures.push_back(_body->CreateFixture(&def));
         }
+
+        _n_edges = _subsequent_fixtures.size();
         _fixture = _subsequent_fixtures.front();
     }
 
+    const std::vector<Vector2f>& CollisionLineSequence::get_vertices() const
+    {
+        return _vertices;
+    }
+
+    size_t CollisionLineSequence::get_n_edges() const
+    {
+        return _n_edges;
+    }
+
     b2Shape *CollisionLineSequence::get_native_shape()
     {
-        return &_shape;
+        return _fixture->GetShape();
+    }
+
+    void CollisionLineSequence::on_fixtures_moved(const FixtureMap& fixtures)
+    {
+        for (auto& fixture : _subsequent_fixtures)
+            for (auto& pair : fixtures)
+                if (pair.first == fixture)
+                    fixture = pair.second;
     }
-}
\ No newline at end of file
+}
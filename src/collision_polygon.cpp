@@ -7,6 +7,7 @@
 #include <exception>
 #include <sstream>
 #include <algorithm>
+#include <utility>
 
 #include <include/collision_polygon.hpp>
 #include <include/physics_world.hpp>
@@ -106,8 +107,7 @@ namespace ts
         {
             std::stringstream str;
             str << "In ts::CollisionPolygon CTor: Maximum number of vertices (" << 8 << ") exceeded." \
-                << "To achieve the desired geometry, instead decompose the polygon into multiple smaller polygons." << std::endl;
-            // TODO: implement multi-fixure physics body to make this easier
+                << "To achieve the desired geometry, use ts::CollisionCompound instead, which decomposes the polygon into multiple smaller polygons." << std::endl;
 
             throw std::invalid_argument(str.str());
         }
@@ -144,6 +144,15 @@ namespace ts
         _fixture = _body->CreateFixture(&def);
     }
 
+    CollisionPolygon::CollisionPolygon(PhysicsWorld* world, CollisionType type, Vector2f center, const b2PolygonShape& shape)
+        : CollisionShape(world, type, center), _shape(shape)
+    {
+        _shape.m_radius = _world->get_skin_radius();
+
+        auto def = create_fixture_def(&_shape);
+        _fixture = _body->CreateFixture(&def);
+    }
+
     CollisionPolygon::CollisionPolygon(PhysicsWorld* world, CollisionType type, const PolygonShape & poly)
         : CollisionPolygon(world, type, [&]() -> std::vector<Vector2f> {
 
@@ -156,4 +165,72 @@ namespace ts
             return out;
         }())
     {}
-}
\ No newline at end of file
+
+    CollisionPolygonBatch::CollisionPolygonBatch(size_t capacity)
+        : _data(std::allocator<CollisionPolygon>().allocate(capacity)), _capacity(capacity)
+    {}
+
+    CollisionPolygonBatch::~CollisionPolygonBatch()
+    {
+        for (size_t i = 0; i < _size; ++i)
+            _data[i].~CollisionPolygon();
+
+        if (_data != nullptr)
+            std::allocator<CollisionPolygon>().deallocate(_data, _capacity);
+    }
+
+    CollisionPolygonBatch::CollisionPolygonBatch(CollisionPolygonBatch&& other) noexcept
+        : _data(std::exchange(other._data, nullptr)),
+          _size(std::exchange(other._size, 0)),
+          _capacity(std::exchange(other._capacity, 0))
+    {}
+
+    CollisionPolygonBatch& CollisionPolygonBatch::operator=(CollisionPolygonBatch&& other) noexcept
+    {
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+        std::swap(_capacity, other._capacity);
+        return *this;
+    }
+
+    void CollisionPolygonBatch::destroy()
+    {
+        for (auto& shape : *this)
+            shape.destroy();
+    }
+
+    size_t CollisionPolygonBatch::size() const
+    {
+        return _size;
+    }
+
+    CollisionPolygon& CollisionPolygonBatch::operator[](size_t index)
+    {
+        return _data[index];
+    }
+
+    const CollisionPolygon& CollisionPolygonBatch::operator[](size_t index) const
+    {
+        return _data[index];
+    }
+
+    CollisionPolygon* CollisionPolygonBatch::begin()
+    {
+        return _data;
+    }
+
+    CollisionPolygon* CollisionPolygonBatch::end()
+    {
+        return _data + _size;
+    }
+
+    const CollisionPolygon* CollisionPolygonBatch::begin() const
+    {
+        return _data;
+    }
+
+    const CollisionPolygon* CollisionPolygonBatch::end() const
+    {
+        return _data + _size;
+    }
+}
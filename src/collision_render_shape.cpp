@@ -3,11 +3,34 @@
 //
 
 #include <include/collision_render_shape.hpp>
+#include <include/physics_world.hpp>
 
 #include <iostream>
 
 namespace ts
 {
+    bool CollisionRenderShape::should_update(const b2Body* body)
+    {
+        auto& transform = body->GetTransform();
+        if (_is_synced and
+            transform.p.x == _last_transform.p.x and
+            transform.p.y == _last_transform.p.y and
+            transform.q.s == _last_transform.q.s and
+            transform.q.c == _last_transform.q.c)
+            return false;
+
+        _last_transform = transform;
+        _is_synced = true;
+        return true;
+    }
+
+    void CollisionRenderShape::update_awake(PhysicsWorld* world)
+    {
+        for (auto* shape : world->get_awake_shapes())
+            if (auto* render_shape = dynamic_cast<CollisionRenderShape*>(shape))
+                render_shape->update();
+    }
+
     CollisionRectangleShape::CollisionRectangleShape(
         PhysicsWorld* world,
         CollisionType type,
@@ -18,6 +41,9 @@ namespace ts
 
     void CollisionRectangleShape::update()
     {
+        if (not should_update(get_native_body()))
+            return;
+
         RectangleShape::set_centroid(CollisionShape::get_centroid());
 
         auto is = _rotation.as_degrees();
@@ -39,6 +65,9 @@ namespace ts
 
     void CollisionTriangleShape::update()
     {
+        if (not should_update(get_native_body()))
+            return;
+
         TriangleShape::set_centroid(CollisionShape::get_centroid());
 
         auto is = _rotation.as_degrees();
@@ -59,6 +88,9 @@ namespace ts
 
     void CollisionCircleShape::update()
     {
+        if (not should_update(get_native_body()))
+            return;
+
         CircleShape::set_centroid(CollisionShape::get_centroid());
 
         auto is = _rotation.as_degrees();
@@ -89,6 +121,9 @@ namespace ts
 
     void CollisionLineShape::update()
     {
+        if (not should_update(get_native_body()))
+            return;
+
         RectangleShape::set_centroid(CollisionShape::get_centroid());
 
         auto is = _rotation.as_degrees();
@@ -103,42 +138,30 @@ namespace ts
         PhysicsWorld* world,
         CollisionType type,
         const std::vector<Vector2f>& vertices,
-        bool is_two_sided)
-        : CollisionLineSequence(world, type, vertices, is_two_sided)
-    {
-        for (size_t i = 0; i < vertices.size()-1; ++i)
-            _lines.push_back(detail::create_line_shape(vertices.at(i), vertices.at(i+1)));
-    }
+        bool is_two_sided,
+        float simplification_tolerance)
+        : CollisionLineSequence(world, type, vertices, is_two_sided, simplification_tolerance),
+          _polyline(CollisionLineSequence::get_vertices()),
+          _initial_origin(CollisionShape::get_origin())
+    {}
 
-    std::vector<RectangleShape> &CollisionLineSequenceShape::get_shapes()
+    PolylineShape& CollisionLineSequenceShape::get_polyline()
     {
-        return _lines;
+        return _polyline;
     }
 
     void CollisionLineSequenceShape::update()
     {
-        auto centroid = Vector2f(0, 0);
-        for (auto& line : _lines)
-            centroid += line.get_centroid();
-        centroid /= Vector2f(_lines.size(), _lines.size());
-
-        auto is = _rotation.as_degrees();
-        auto should_be = CollisionShape::get_rotation().as_degrees();
-        auto delta = should_be - is;
+        if (not should_update(get_native_body()))
+            return;
 
-        for (auto& line : _lines)
-        {
-            line.set_origin(centroid - line.get_centroid());
-            line.rotate(degrees(delta));
-        }
-
-        _rotation = degrees(is + delta);
+        // the mesh is never rebuilt, only its model transform follows the body
+        _polyline.set_model_transform(CollisionShape::get_origin() - _initial_origin, CollisionShape::get_rotation(), _initial_origin);
     }
 
     void CollisionLineSequenceShape::render(RenderTarget *target, Transform transform) const
     {
-        for (auto& e : _lines)
-            e.render(target, transform);
+        detail::forward_render(target, &_polyline, transform);
     }
 
     CollisionPolygonShape::CollisionPolygonShape(PhysicsWorld* world, CollisionType type, const std::vector<Vector2f> & vertices)
@@ -147,6 +170,9 @@ namespace ts
 
     void CollisionPolygonShape::update()
     {
+        if (not should_update(get_native_body()))
+            return;
+
         PolygonShape::set_centroid(CollisionShape::get_centroid());
 
         auto is = _rotation.as_degrees();
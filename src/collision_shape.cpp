@@ -21,6 +21,16 @@ namespace ts
         // this gives additional information to a potential box2d error
     }
 
+    b2AABB CollisionShape::compute_aabb() const
+    {
+        auto out = _fixture->GetAABB(0);
+        for (auto* fixture = _body->GetFixtureList(); fixture != nullptr; fixture = fixture->GetNext())
+            for (int32 i = 0; i < fixture->GetShape()->GetChildCount(); ++i)
+                out.Combine(fixture->GetAABB(i));
+
+        return out;
+    }
+
     b2FixtureDef CollisionShape::create_fixture_def(b2Shape *shape) const
     {
         auto def = default_fixture_def;
@@ -32,36 +42,38 @@ namespace ts
     }
 
     CollisionShape::CollisionShape(PhysicsWorld* world, CollisionType type, Vector2f initial_center)
-        : _world(world), _id(_current_id)
+        : _world(world), _id(_current_id.fetch_add(1)) // shapes may be created on multiple threads, c.f. ts::WorldScheduler
     {
-        _current_id = _current_id + 1;
-
         initial_center = _world->world_to_native(initial_center);
 
         auto bodydef = default_body_def;
         bodydef.position.Set(initial_center.x, initial_center.y);
         bodydef.type = (b2BodyType) type;
+        bodydef.userData.pointer = (uintptr_t) this;
 
         _body = world->get_native()->CreateBody(&bodydef);
+        _world->on_shape_created(this);
+
+        if (type != STATIC)
+            _world->on_shape_woken(this);
     }
 
     CollisionShape::~CollisionShape()
-    {}
+    {
+        // the body, the awake sets, callbacks and triggers all refer to this shape
+        if (_body != nullptr)
+            destroy();
+    }
 
     void CollisionShape::set_density(float density)
     {
         assert_hidden();
 
-        if (density == 0)
-        {
-            _fixture->SetDensity(density);
-            _body->SetGravityScale(0);
-        }
-        else
-        {
-            _fixture->SetDensity(density);
-            _body->SetGravityScale(1);
-        }
+        for (auto* fixture = _body->GetFixtureList(); fixture != nullptr; fixture = fixture->GetNext())
+            fixture->SetDensity(density);
+
+        _body->SetGravityScale(density == 0 ? 0 : 1);
+        _body->ResetMassData();
     }
 
     float CollisionShape::get_density() const
@@ -75,7 +87,8 @@ namespace ts
     {
         assert_hidden();
 
-        _fixture->SetFriction(friction);
+        for (auto* fixture = _body->GetFixtureList(); fixture != nullptr; fixture = fixture->GetNext())
+            fixture->SetFriction(friction);
     }
 
     float CollisionShape::get_friction() const
@@ -89,14 +102,15 @@ namespace ts
     {
         assert_hidden();
 
-        _fixture->SetRestitution(restitution);
+        for (auto* fixture = _body->GetFixtureList(); fixture != nullptr; fixture = fixture->GetNext())
+            fixture->SetRestitution(restitution);
     }
 
     Rectangle CollisionShape::get_bounding_box() const
     {
         assert_hidden();
 
-        auto aabb = _fixture->GetAABB(0);
+        auto aabb = compute_aabb();
         auto size = aabb.upperBound - aabb.lowerBound;
         return Rectangle{
             _world->native_to_world(Vector2f(aabb.lowerBound.x, aabb.lowerBound.y)),
@@ -108,7 +122,7 @@ namespace ts
     {
         assert_hidden();
 
-        auto center = _fixture->GetAABB(0).GetCenter();
+        auto center = compute_aabb().GetCenter();
         return _world->native_to_world(Vector2f{center.x, center.y});
     }
 
@@ -130,6 +144,7 @@ namespace ts
         assert_hidden();
 
         _body->SetType((b2BodyType) type);
+        _world->on_shape_woken(this);
     }
 
     CollisionType CollisionShape::get_type() const
@@ -142,6 +157,9 @@ namespace ts
     void CollisionShape::set_is_hidden(bool b)
     {
         _body->SetEnabled(not b);
+
+        if (not b)
+            _world->on_shape_woken(this);
     }
 
     bool CollisionShape::get_is_hidden() const
@@ -195,6 +213,7 @@ namespace ts
 
         vec = _world->world_to_native(vec);
         _body->SetLinearVelocity(b2Vec2(vec.x, vec.y));
+        _world->on_shape_woken(this);
     }
 
     Vector2f CollisionShape::get_linear_velocity() const
@@ -210,6 +229,7 @@ namespace ts
         assert_hidden();
 
         _body->SetAngularVelocity(value);
+        _world->on_shape_woken(this);
     }
 
     float CollisionShape::get_angular_velocity() const
@@ -225,6 +245,7 @@ namespace ts
 
         force = _world->world_to_native(force);
         _body->ApplyForce(b2Vec2(force.x, force.y), b2Vec2(point.x, point.y), true);
+        _world->on_shape_woken(this);
     }
 
     void CollisionShape::apply_force_to_center(Vector2f force)
@@ -233,6 +254,7 @@ namespace ts
 
         force = _world->world_to_native(force);
         _body->ApplyForceToCenter(b2Vec2(force.x, force.y), true);
+        _world->on_shape_woken(this);
     }
 
     void CollisionShape::apply_torque(float torque)
@@ -240,6 +262,7 @@ namespace ts
         assert_hidden();
 
         _body->ApplyTorque(torque, true);
+        _world->on_shape_woken(this);
     }
 
     void CollisionShape::apply_linear_impulse_to(Vector2f impulse, Vector2f point)
@@ -247,6 +270,7 @@ namespace ts
         assert_hidden();
 
         _body->ApplyLinearImpulse(b2Vec2(impulse.x, impulse.y), b2Vec2(point.x, point.y), true);
+        _world->on_shape_woken(this);
     }
 
     void CollisionShape::apply_linear_impulse_to_center(Vector2f impulse)
@@ -254,6 +278,7 @@ namespace ts
         assert_hidden();
 
         _body->ApplyLinearImpulseToCenter(b2Vec2(impulse.x, impulse.y), true);
+        _world->on_shape_woken(this);
     }
 
     float CollisionShape::get_mass() const
@@ -319,6 +344,19 @@ namespace ts
         return _fixture->GetRestitution();
     }
 
+    void CollisionShape::set_is_sensor(bool value)
+    {
+        for (auto* fixture = _body->GetFixtureList(); fixture != nullptr; fixture = fixture->GetNext())
+            fixture->SetSensor(value);
+
+        _world->on_shape_woken(this);
+    }
+
+    bool CollisionShape::get_is_sensor() const
+    {
+        return _fixture->IsSensor();
+    }
+
     void CollisionShape::set_collision_filter(
         const std::vector<CollisionFilterGroup> &does_not_collide_with_group,
         const std::vector<CollisionFilterGroup> &is_in_group)
@@ -334,14 +372,93 @@ namespace ts
         auto filter = b2Filter();
         filter.maskBits = _will_collide_with_group_bits;
         filter.categoryBits = _is_in_collision_group_bits;
-        _fixture->SetFilterData(filter);
+        for (auto* fixture = _body->GetFixtureList(); fixture != nullptr; fixture = fixture->GetNext())
+            fixture->SetFilterData(filter);
     }
 
     void CollisionShape::destroy()
     {
+        if (_was_destroyed)
+            return;
+
         if (_world != nullptr && _body != nullptr)
+        {
+            _world->remove_collision_callbacks(this);
+            _world->on_shape_destroyed(this);
             _world->get_native()->DestroyBody(_body);
+            _world->remove_trigger(this);
+            _world->remove_events(this); // including the contact ends caused by destroying the body
+        }
 
         _was_destroyed = true;
     }
-}
\ No newline at end of file
+
+    void CollisionShape::move_to(PhysicsWorld* world)
+    {
+        if (_was_destroyed or world == _world)
+            return;
+
+        auto* old_body = _body;
+
+        auto body_def = b2BodyDef();
+        body_def.type = old_body->GetType();
+        body_def.position = old_body->GetPosition();
+        body_def.angle = old_body->GetAngle();
+        body_def.linearVelocity = old_body->GetLinearVelocity();
+        body_def.angularVelocity = old_body->GetAngularVelocity();
+        body_def.linearDamping = old_body->GetLinearDamping();
+        body_def.angularDamping = old_body->GetAngularDamping();
+        body_def.allowSleep = old_body->IsSleepingAllowed();
+        body_def.awake = old_body->IsAwake();
+        body_def.fixedRotation = old_body->IsFixedRotation();
+        body_def.bullet = old_body->IsBullet();
+        body_def.enabled = old_body->IsEnabled();
+        body_def.gravityScale = old_body->GetGravityScale();
+        body_def.userData = old_body->GetUserData();
+
+        auto* new_body = world->get_native()->CreateBody(&body_def);
+
+        // fixtures deep-copy their shape, so the old shapes only need to outlive this loop
+        auto fixtures = FixtureMap();
+        for (auto* fixture = old_body->GetFixtureList(); fixture != nullptr; fixture = fixture->GetNext())
+        {
+            auto def = b2FixtureDef();
+            def.shape = fixture->GetShape();
+            def.userData = fixture->GetUserData();
+            def.friction = fixture->GetFriction();
+            def.restitution = fixture->GetRestitution();
+            def.restitutionThreshold = fixture->GetRestitutionThreshold();
+            def.density = fixture->GetDensity();
+            def.isSensor = fixture->IsSensor();
+            def.filter = fixture->GetFilterData();
+            fixtures.emplace_back(fixture, new_body->CreateFixture(&def));
+        }
+
+        for (auto& pair : fixtures)
+            if (pair.first == _fixture)
+                _fixture = pair.second;
+
+        on_fixtures_moved(fixtures);
+
+        auto callbacks = _world->take_collision_callbacks(this);
+        _world->on_shape_destroyed(this);
+        _world->get_native()->DestroyBody(old_body);
+        bool was_trigger = _world->remove_trigger(this);
+
+        _world = world;
+        _body = new_body;
+        _awake_epoch = 0; // counted per world
+        _world->on_shape_created(this);
+
+        if (body_def.type != b2_staticBody)
+            _world->on_shape_woken(this);
+
+        // overlaps are tracked anew, shapes overlapping in the new world are reported as entered
+        if (was_trigger)
+            _world->add_trigger(this);
+
+        // callbacks are registered anew, so their ids are those of the new world
+        for (auto& callback : callbacks)
+            _world->add_collision_callback(this, std::move(callback));
+    }
+}
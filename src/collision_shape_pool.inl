@@ -0,0 +1,210 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#include <include/logging.hpp>
+
+namespace ts
+{
+    template<typename Shape_t>
+    CollisionShapePool<Shape_t>::CollisionShapePool(PhysicsWorld* world, Factory factory)
+        : _world(world), _factory(std::move(factory))
+    {}
+
+    template<typename Shape_t>
+    CollisionShapePool<Shape_t>::~CollisionShapePool()
+    {
+        clear();
+    }
+
+    template<typename Shape_t>
+    CollisionShapeHandle CollisionShapePool<Shape_t>::acquire(Vector2f origin, Angle angle, Vector2f linear_velocity)
+    {
+        uint32_t index;
+        if (not _free.empty())
+        {
+            index = _free.back();
+            _free.pop_back();
+        }
+        else
+        {
+            index = _slots.size();
+            _slots.emplace_back();
+        }
+
+        auto& slot = _slots.at(index);
+        if (slot.shape == nullptr)
+            slot.shape = _factory(_world);
+        else
+            _n_pooled -= 1;
+
+        auto* body = slot.shape->get_native_body();
+        auto position = _world->world_to_native(origin);
+
+        // the body is disabled while pooled, moving it first means its broadphase proxies
+        // are created at the new position directly instead of being moved there
+        body->SetTransform(b2Vec2(position.x, position.y), angle.as_radians());
+        body->SetEnabled(true);
+        body->SetAwake(true);
+
+        slot.shape->set_linear_velocity(linear_velocity);
+        slot.shape->set_angular_velocity(0);
+
+        slot.is_live = true;
+        _n_live += 1;
+
+        return CollisionShapeHandle{index, slot.generation};
+    }
+
+    template<typename Shape_t>
+    bool CollisionShapePool<Shape_t>::release(CollisionShapeHandle handle)
+    {
+        if (not is_valid(handle))
+        {
+            Log::warning("In ts::CollisionShapePool::release: handle #", handle.index, " (generation ", handle.generation, ") is no longer valid, it may have been released already.");
+            return false;
+        }
+
+        auto& slot = _slots.at(handle.index);
+        slot.is_live = false;
+        slot.generation += 1;
+        _n_live -= 1;
+
+        auto& shape = *slot.shape;
+
+        // a recycled shape starts without registrations, regardless of who acquires it next
+        _world->remove_collision_callbacks(&shape);
+        bool was_trigger = _world->remove_trigger(&shape);
+
+        if (shape._was_destroyed)
+        {
+            // body is gone, the shape cannot be recycled
+            slot.shape.reset();
+        }
+        else
+        {
+            // add_trigger made it a sensor
+            if (was_trigger)
+                shape.set_is_sensor(false);
+
+            shape.get_native_body()->SetEnabled(false);
+            _n_pooled += 1;
+        }
+
+        _free.push_back(handle.index);
+        return true;
+    }
+
+    template<typename Shape_t>
+    Shape_t* CollisionShapePool<Shape_t>::get(CollisionShapeHandle handle) const
+    {
+        if (not is_valid(handle))
+            return nullptr;
+
+        return _slots[handle.index].shape.get();
+    }
+
+    template<typename Shape_t>
+    bool CollisionShapePool<Shape_t>::is_valid(CollisionShapeHandle handle) const
+    {
+        if (handle.index >= _slots.size())
+            return false;
+
+        auto& slot = _slots[handle.index];
+        return slot.is_live and slot.generation == handle.generation;
+    }
+
+    template<typename Shape_t>
+    void CollisionShapePool<Shape_t>::reserve(size_t n_pooled)
+    {
+        _free.reserve(n_pooled);
+
+        for (auto index : _free)
+        {
+            if (_n_pooled >= n_pooled)
+                return;
+
+            auto& slot = _slots.at(index);
+            if (slot.shape != nullptr)
+                continue;
+
+            slot.shape = _factory(_world);
+            slot.shape->get_native_body()->SetEnabled(false);
+            _n_pooled += 1;
+        }
+
+        while (_n_pooled < n_pooled)
+        {
+            _free.push_back(_slots.size());
+            auto& slot = _slots.emplace_back();
+            slot.shape = _factory(_world);
+            slot.shape->get_native_body()->SetEnabled(false);
+            _n_pooled += 1;
+        }
+    }
+
+    template<typename Shape_t>
+    void CollisionShapePool<Shape_t>::shrink_to(size_t n_pooled)
+    {
+        for (auto index : _free)
+        {
+            if (_n_pooled <= n_pooled)
+                return;
+
+            auto& slot = _slots.at(index);
+            if (slot.shape == nullptr)
+                continue;
+
+            slot.shape->destroy();
+            slot.shape.reset();
+            _n_pooled -= 1;
+        }
+    }
+
+    template<typename Shape_t>
+    void CollisionShapePool<Shape_t>::clear()
+    {
+        // slots are kept, such that their generation keeps invalidating old handles
+        _free.clear();
+        for (uint32_t i = 0; i < _slots.size(); ++i)
+        {
+            auto& slot = _slots.at(i);
+            _free.push_back(i);
+
+            if (slot.is_live)
+            {
+                _n_leaked_on_clear += 1;
+                slot.is_live = false;
+                slot.generation += 1;
+            }
+
+            if (slot.shape != nullptr)
+            {
+                slot.shape->destroy();
+                slot.shape.reset();
+            }
+        }
+
+        _n_live = 0;
+        _n_pooled = 0;
+    }
+
+    template<typename Shape_t>
+    size_t CollisionShapePool<Shape_t>::get_n_live() const
+    {
+        return _n_live;
+    }
+
+    template<typename Shape_t>
+    size_t CollisionShapePool<Shape_t>::get_n_pooled() const
+    {
+        return _n_pooled;
+    }
+
+    template<typename Shape_t>
+    size_t CollisionShapePool<Shape_t>::get_n_leaked() const
+    {
+        return _n_leaked_on_clear;
+    }
+}
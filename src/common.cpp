@@ -17,6 +17,9 @@
 #include <include/exceptions.hpp>
 #include <include/music_handler.hpp>
 #include <include/sound_handler.hpp>
+#include <include/audio_command_queue.hpp>
+#include <include/audio_device.hpp>
+#include <include/audio_statistics.hpp>
 
 namespace ts
 {
@@ -26,7 +29,7 @@ namespace ts
         static inline Clock _frame_clock = ts::Clock();
     }
 
-    bool initialize()
+    bool initialize(AudioConfig audio)
     {
         if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
         {
@@ -63,16 +66,9 @@ namespace ts
             return false;
         }
 
-        if (Mix_OpenAudio(ts::MusicHandler::sample_rate, MIX_DEFAULT_FORMAT, 2, 1024) != 0)
+        if (not ts::AudioDevice::open(audio))
         {
-            ts::Log::warning("In ts::initialize: Unable to initialize Music Handler");
-            ts::forward_sdl_error();
-            return false;
-        }
-
-        if (Mix_AllocateChannels(ts::SoundHandler::n_channels) != ts::SoundHandler::n_channels)
-        {
-            ts::Log::warning("In ts::initialize: Unable to initialize Audio Handler");
+            ts::Log::warning("In ts::initialize: Unable to open audio device");
             ts::forward_sdl_error();
             return false;
         }
@@ -107,6 +103,9 @@ namespace ts
         for (auto* w : windows)
             w->flush();
 
+        flush_audio_commands();
+        AudioStatistics::update();
+
         auto to_wait = ts::seconds(1.f / detail::_target_fps).as_microseconds() - detail::_frame_clock.elapsed().as_microseconds();
         std::this_thread::sleep_for(std::chrono::microseconds(size_t(to_wait)));
     }
@@ -4,6 +4,7 @@
 //
 
 #include <include/music.hpp>
+#include <include/audio_command_queue.hpp>
 #include <include/logging.hpp>
 #include <SDL2/SDL_mixer.h>
 
@@ -22,6 +23,7 @@ namespace ts
     {
         _music = Mix_LoadMUS(path.c_str());
         _id = std::hash<std::string>()(path);
+        _path = path;
 
         if (_music == nullptr)
         {
@@ -29,11 +31,24 @@ namespace ts
             return false;
         }
         else
+        {
+            auto guard = std::lock_guard(_loaded_lock);
+            _loaded.insert(this);
             return true;
+        }
     }
 
     void Music::unload()
     {
+        {
+            auto guard = std::lock_guard(_loaded_lock);
+            _loaded.erase(this);
+        }
+
+        // a play issued this frame would otherwise start the music after it was freed
+        if (_music != nullptr)
+            detail::AudioCommandQueue::flush_pending();
+
         Mix_FreeMusic(_music);
         _id = -1;
         _music = nullptr;
@@ -53,5 +68,18 @@ namespace ts
     {
         return _music;
     }
+
+    void Music::reload_all()
+    {
+        auto guard = std::lock_guard(_loaded_lock);
+        for (auto* music : _loaded)
+        {
+            Mix_FreeMusic(music->_music);
+            music->_music = Mix_LoadMUS(music->_path.c_str());
+
+            if (music->_music == nullptr)
+                Log::warning("In ts::Music::reload_all: unable to reload \"", music->_path, "\"");
+        }
+    }
 }
 
@@ -1,4 +1,4 @@
-// 
+//
 // Copyright 2022 Joshua Higginbotham
 // Created on 23.05.22 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
 //
@@ -8,68 +8,95 @@
 
 namespace ts
 {
-    void MusicHandler::play(Music& music, bool should_loop, Time fade_in_delay)
+    void MusicHandler::push_play(Music& music, bool should_loop, Time fade_in_delay)
     {
-        auto guard = std::lock_guard(_lock);
+        auto command = detail::AudioCommand();
+        command.n_loops = should_loop ? -1 : 1;
+        command.data = music._music;
+
+        if (fade_in_delay.as_milliseconds() < sample_rate / 1000.f)
+            command.type = detail::AudioCommand::MUSIC_PLAY;
+        else
+        {
+            command.type = detail::AudioCommand::MUSIC_FADE_IN;
+            command.duration_ms = fade_in_delay.as_milliseconds();
+        }
 
+        _active = &music;
+        _is_paused = false;
+        detail::AudioCommandQueue::push(command);
+    }
+
+    void MusicHandler::play(Music& music, bool should_loop, Time fade_in_delay)
+    {
         if (music._music == nullptr)
         {
             Log::warning("In MusicHandler.play: trying to play music even though it is uninitialized");
             return;
         }
 
-        if (fade_in_delay.as_milliseconds() < sample_rate / 1000.f)
-            Mix_PlayMusic(music._music, (should_loop ? -1 : 1));
-        else
-            Mix_FadeInMusic(music._music, (should_loop ? -1 : 1), (int32_t) fade_in_delay.as_milliseconds());
-
-        _active = &music;
+        _next = nullptr;
+        push_play(music, should_loop, fade_in_delay);
     }
 
     void MusicHandler::stop(Time fade_out_delay)
     {
-        auto guard = std::lock_guard(_lock);
-
+        auto command = detail::AudioCommand();
         if (fade_out_delay.as_milliseconds() < sample_rate / 1000)
-            Mix_HaltMusic();
+            command.type = detail::AudioCommand::MUSIC_STOP;
         else
-            Mix_FadeOutMusic(fade_out_delay.as_milliseconds());
+        {
+            command.type = detail::AudioCommand::MUSIC_FADE_OUT;
+            command.duration_ms = fade_out_delay.as_milliseconds();
+        }
 
+        _next = nullptr;
         _active = nullptr;
+        detail::AudioCommandQueue::push(command);
     }
 
     void MusicHandler::pause()
     {
-        auto guard = std::lock_guard(_lock);
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::MUSIC_PAUSE;
 
-        Mix_PauseMusic();
-        // keeps _active set
+        _is_paused = true; // keeps _active set
+        detail::AudioCommandQueue::push(command);
     }
 
     void MusicHandler::play_next(Music& music, bool should_loop, Time fade_in)
     {
-        auto guard = std::lock_guard(_lock);
-
-        detail::MusicFunctionHook::function = [music_ptr = &music, should_loop, fade_in]() -> void
+        if (music._music == nullptr)
         {
-            MusicHandler::_next = nullptr;
-            MusicHandler::play((*music_ptr), should_loop, fade_in);
-        };
-        Mix_HookMusicFinished(&detail::MusicFunctionHook::invoke_once);
+            Log::warning("In MusicHandler.play_next: trying to queue music even though it is uninitialized");
+            return;
+        }
+
+        _next_should_loop = should_loop;
+        _next_fade_in_ms = fade_in.as_milliseconds();
         _next = &music;
     }
 
     void MusicHandler::clear_next()
     {
-        Mix_HookMusicFinished(nullptr);
-        detail::MusicFunctionHook::clear();
         _next = nullptr;
     }
 
     void MusicHandler::next(Time fade_out_duration)
     {
-        Mix_HookMusicFinished(nullptr);
-        detail::MusicFunctionHook::invoke_once();
+        if (fade_out_duration.as_milliseconds() >= sample_rate / 1000)
+        {
+            // the next track is started once the fade-out finished, c.f. update
+            auto command = detail::AudioCommand();
+            command.type = detail::AudioCommand::MUSIC_FADE_OUT;
+            command.duration_ms = fade_out_duration.as_milliseconds();
+            detail::AudioCommandQueue::push(command);
+            return;
+        }
+
+        auto* next = _next.exchange(nullptr);
+        if (next != nullptr)
+            push_play(*next, _next_should_loop, milliseconds(_next_fade_in_ms));
     }
 
     Music * MusicHandler::get_next()
@@ -79,53 +106,53 @@ namespace ts
 
     void MusicHandler::force_stop()
     {
-        auto guard = std::lock_guard(_lock);
-        clear_next();
-        Mix_HaltMusic();
-        _active = nullptr;
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::MUSIC_STOP;
+
         _next = nullptr;
+        _active = nullptr;
+        detail::AudioCommandQueue::push(command);
     }
 
     void MusicHandler::unpause()
     {
-        auto guard = std::lock_guard(_lock);
-        Mix_ResumeMusic();
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::MUSIC_UNPAUSE;
+
+        _is_paused = false;
+        detail::AudioCommandQueue::push(command);
     }
 
     bool MusicHandler::is_paused()
     {
-        return Mix_PausedMusic();
+        return _is_paused;
     }
 
     bool MusicHandler::is_stopped()
     {
-        return not Mix_PlayingMusic();
+        return _active == nullptr;
     }
 
     bool MusicHandler::is_playing()
     {
-        return not Mix_PausedMusic() and Mix_PlayingMusic();
+        return not _is_paused and _active != nullptr;
     }
 
     Music * MusicHandler::get_active()
     {
-        auto guard = std::lock_guard(_lock);
         return _active;
     }
 
     void MusicHandler::skip_to(Time timestamp)
     {
-        auto guard = std::lock_guard(_lock);
-
-        if (timestamp.as_seconds() == 0)
-            Mix_RewindMusic();
-        else
-            Mix_SetMusicPosition(timestamp.as_seconds());
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::MUSIC_SKIP_TO;
+        command.value = timestamp.as_seconds();
+        detail::AudioCommandQueue::push(command);
     }
 
     void MusicHandler::set_volume(double zero_to_one)
     {
-        auto guard = std::lock_guard(_lock);
         if (zero_to_one > 1.0)
         {
             Log::warning("In MusicHandler.set_volume: volume level ", zero_to_one,
@@ -139,12 +166,47 @@ namespace ts
             zero_to_one = 0.0;
         }
 
-        Mix_VolumeMusic(uint8_t(zero_to_one * 128));
         _volume = zero_to_one;
+
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::MUSIC_SET_VOLUME;
+        command.value = zero_to_one;
+        detail::AudioCommandQueue::push(command);
     }
 
     double MusicHandler::get_volume()
     {
         return _volume;
     }
-}
\ No newline at end of file
+
+    void MusicHandler::on_music_finished()
+    {
+        _music_finished = true;
+    }
+
+    bool MusicHandler::update()
+    {
+        if (not _hook_registered)
+        {
+            Mix_HookMusicFinished(&MusicHandler::on_music_finished);
+            _hook_registered = true;
+        }
+
+        if (not _music_finished.exchange(false))
+            return false;
+
+        // the hook also fires when a track is replaced, only act if nothing is playing anymore
+        if (Mix_PlayingMusic())
+            return false;
+
+        auto* next = _next.exchange(nullptr);
+        if (next == nullptr)
+        {
+            _active = nullptr;
+            return false;
+        }
+
+        push_play(*next, _next_should_loop, milliseconds(_next_fade_in_ms));
+        return true;
+    }
+}
@@ -0,0 +1,395 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include <SDL2/SDL_mixer.h>
+
+#include <include/music_playlist.hpp>
+#include <include/music_handler.hpp>
+#include <include/logging.hpp>
+
+namespace ts
+{
+    namespace detail
+    {
+        PlaylistLoader::~PlaylistLoader()
+        {
+            if (thread.joinable())
+                thread.join();
+        }
+    }
+
+    // ### GAME THREAD ###
+
+    void MusicPlaylist::add(const std::string& path, Time crossfade)
+    {
+        auto guard = std::lock_guard(_entry_lock);
+        _entries.push_back(Entry{path, crossfade});
+        _n_failed = 0;
+    }
+
+    void MusicPlaylist::clear()
+    {
+        stop();
+
+        auto guard = std::lock_guard(_entry_lock);
+        _entries.clear();
+    }
+
+    void MusicPlaylist::play()
+    {
+        MusicHandler::stop();
+
+        {
+            auto guard = std::lock_guard(_entry_lock);
+            _generation += 1;
+            _prepare_index = 0;
+            _n_failed = 0;
+        }
+
+        _is_playing = true;
+
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::PLAYLIST_START;
+        detail::AudioCommandQueue::push(command);
+    }
+
+    void MusicPlaylist::stop()
+    {
+        {
+            auto guard = std::lock_guard(_entry_lock);
+            _generation += 1;
+            _prepare_index = 0;
+        }
+
+        _is_playing = false;
+
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::PLAYLIST_STOP;
+        detail::AudioCommandQueue::push(command);
+    }
+
+    void MusicPlaylist::skip()
+    {
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::PLAYLIST_SKIP;
+        detail::AudioCommandQueue::push(command);
+    }
+
+    void MusicPlaylist::set_should_loop(bool b)
+    {
+        _should_loop = b;
+    }
+
+    bool MusicPlaylist::get_should_loop()
+    {
+        return _should_loop;
+    }
+
+    void MusicPlaylist::set_volume(float zero_to_one)
+    {
+        _volume = std::clamp(zero_to_one, 0.f, 1.f);
+    }
+
+    float MusicPlaylist::get_volume()
+    {
+        return _volume;
+    }
+
+    bool MusicPlaylist::is_playing()
+    {
+        return _is_playing;
+    }
+
+    size_t MusicPlaylist::get_n_tracks()
+    {
+        auto guard = std::lock_guard(_entry_lock);
+        return _entries.size();
+    }
+
+    size_t MusicPlaylist::get_current_track()
+    {
+        return _current_index;
+    }
+
+    Time MusicPlaylist::get_position()
+    {
+        auto frequency = _frequency.load();
+        return seconds(frequency > 0 ? double(_position) / frequency : 0);
+    }
+
+    size_t MusicPlaylist::get_n_late_tracks()
+    {
+        return _n_late;
+    }
+
+    // ### LOADER ###
+
+    void MusicPlaylist::load(Entry entry, size_t index, size_t generation)
+    {
+        // Mix_LoadWAV decodes the entire file and converts it to the output format of the device
+        auto* chunk = Mix_LoadWAV(entry.path.c_str());
+        if (chunk == nullptr)
+        {
+            Log::warning("In ts::MusicPlaylist: unable to load \"", entry.path, "\", skipping it");
+            _loader.result = nullptr;
+            _loader.is_done = true;
+            return;
+        }
+
+        auto* track = new detail::PlaylistTrack();
+        track->chunk = chunk;
+        track->samples = reinterpret_cast<const int16_t*>(chunk->abuf);
+        track->n_frames = chunk->alen / (2 * sizeof(int16_t));
+        track->n_crossfade_frames = entry.crossfade.as_seconds() * _frequency;
+        track->index = index;
+        track->generation = generation;
+
+        _loader.result = track;
+        _loader.is_done = true;
+    }
+
+    void MusicPlaylist::free_track(detail::PlaylistTrack* track)
+    {
+        if (track == nullptr)
+            return;
+
+        Mix_FreeChunk(track->chunk);
+        delete track;
+    }
+
+    // ### COMMANDS ###
+
+    void MusicPlaylist::apply_start()
+    {
+        int frequency = 0;
+        uint16_t format = 0;
+        int n_channels = 0;
+
+        if (Mix_QuerySpec(&frequency, &format, &n_channels) == 0 or format != AUDIO_S16SYS or n_channels != 2)
+        {
+            Log::warning("In ts::MusicPlaylist::play: the audio device has to be open with 16-bit stereo output");
+            _is_playing = false;
+            return;
+        }
+
+        _frequency = frequency;
+
+        // restarts from the first track, c.f. play
+        free_track(_current);
+        free_track(_next);
+        _current = nullptr;
+        _next = nullptr;
+        _fade_start = -1;
+        _position = 0;
+
+        if (not _is_hooked)
+        {
+            Mix_HookMusic(&on_mix, nullptr);
+            _is_hooked = true;
+        }
+    }
+
+    void MusicPlaylist::apply_stop()
+    {
+        if (_is_hooked)
+        {
+            Mix_HookMusic(nullptr, nullptr);
+            _is_hooked = false;
+        }
+
+        free_track(_current);
+        free_track(_next);
+        _current = nullptr;
+        _next = nullptr;
+        _fade_start = -1;
+        _position = 0;
+        _current_index = -1;
+    }
+
+    void MusicPlaylist::apply_skip()
+    {
+        // the next track starts in the next callback if it is already decoded
+        free_track(_current);
+        _current = nullptr;
+        _fade_start = -1;
+        _position = 0;
+    }
+
+    void MusicPlaylist::update()
+    {
+        for (size_t i = 0; i < _n_retired; ++i)
+            free_track(_retired[i]);
+
+        _n_retired = 0;
+
+        auto guard = std::lock_guard(_entry_lock);
+
+        if (_loader.is_running and _loader.is_done)
+        {
+            _loader.thread.join();
+            _loader.is_running = false;
+            _loader.is_done = false;
+
+            auto* track = _loader.result;
+            _loader.result = nullptr;
+
+            if (track == nullptr)
+                _n_failed += 1;
+            else
+                _n_failed = 0;
+
+            if (track != nullptr and track->generation == _generation and _next == nullptr)
+                _next = track;
+            else
+                free_track(track);
+        }
+
+        if (_prepare_index >= _entries.size() and _should_loop)
+            _prepare_index = 0;
+
+        // only one track is kept ahead, such that memory stays bounded
+        bool can_prepare = _is_hooked and _prepare_index < _entries.size() and _n_failed < _entries.size();
+        if (not _loader.is_running and _next == nullptr and can_prepare)
+        {
+            _loader.is_running = true;
+            _loader.thread = std::thread(&MusicPlaylist::load, _entries.at(_prepare_index), _prepare_index, _generation);
+            _prepare_index += 1;
+        }
+
+        _has_pending = _loader.is_running or (_next == nullptr and can_prepare);
+        _is_playing = _is_hooked and (_current != nullptr or _next != nullptr or _has_pending);
+    }
+
+    // ### AUDIO THREAD ###
+
+    void MusicPlaylist::retire(detail::PlaylistTrack* track)
+    {
+        // freed by update, SDL_mixer may not be called from the audio thread
+        _retired[_n_retired++] = track;
+    }
+
+    void MusicPlaylist::on_mix(void*, uint8_t* stream, int length)
+    {
+        static constexpr float pi = 3.14159265358979f;
+
+        auto* out = reinterpret_cast<int16_t*>(stream);
+        const size_t n_frames = length / (2 * sizeof(int16_t));
+        const float volume = _volume;
+
+        size_t written = 0;
+        while (written < n_frames)
+        {
+            if (_current == nullptr)
+            {
+                if (_next == nullptr)
+                    break;
+
+                _current = _next;
+                _next = nullptr;
+                _position = 0;
+                _fade_start = -1;
+                _current_index = _current->index;
+            }
+
+            auto* current = _current;
+            auto* next = _next;
+            size_t position = _position;
+
+            // decided once the next track is known, such that it does not matter when it finished decoding
+            if (next != nullptr and _fade_start == size_t(-1))
+            {
+                size_t fade = std::min({next->n_crossfade_frames, current->n_frames, next->n_frames});
+                _fade_start = std::max(position, current->n_frames - fade);
+            }
+
+            // current track alone
+            size_t end = next != nullptr ? _fade_start : current->n_frames;
+            if (position < end)
+            {
+                size_t n = std::min(n_frames - written, end - position);
+                const int16_t* from = current->samples + 2 * position;
+                int16_t* to = out + 2 * written;
+
+                if (volume == 1)
+                    std::memcpy(to, from, n * 2 * sizeof(int16_t));
+                else
+                    for (size_t i = 0; i < 2 * n; ++i)
+                        to[i] = from[i] * volume;
+
+                written += n;
+                _position = position + n;
+                continue;
+            }
+
+            if (next == nullptr)
+            {
+                // ended before the next track was decoded, or the playlist is over
+                if (_n_retired == _retired.size())
+                    break;
+
+                if (_has_pending)
+                    _n_late += 1;
+
+                retire(current);
+                _current = nullptr;
+                _current_index = -1;
+                continue;
+            }
+
+            // crossfade, the next track started at _fade_start. Equal power: the gains are cos and sin of the
+            // same angle, which is rotated each frame instead of evaluating both functions per frame
+            size_t fade_length = current->n_frames - _fade_start;
+            size_t n = std::min(n_frames - written, current->n_frames - position);
+            if (n > 0)
+            {
+                float step = (pi / 2) / fade_length;
+                float angle = (position - _fade_start) * step;
+                float c = std::cos(angle) * volume;
+                float s = std::sin(angle) * volume;
+                const float dc = std::cos(step);
+                const float ds = std::sin(step);
+
+                const int16_t* a = current->samples + 2 * position;
+                const int16_t* b = next->samples + 2 * (position - _fade_start);
+                int16_t* to = out + 2 * written;
+
+                for (size_t i = 0; i < n; ++i)
+                {
+                    to[2 * i] = std::clamp<float>(a[2 * i] * c + b[2 * i] * s, -32768, 32767);
+                    to[2 * i + 1] = std::clamp<float>(a[2 * i + 1] * c + b[2 * i + 1] * s, -32768, 32767);
+
+                    float c_next = c * dc - s * ds;
+                    s = s * dc + c * ds;
+                    c = c_next;
+                }
+
+                written += n;
+                position += n;
+                _position = position;
+            }
+
+            if (position >= current->n_frames)
+            {
+                if (_n_retired == _retired.size())
+                    break;
+
+                // sample-accurate, the next track continues exactly where the overlap ended
+                retire(current);
+                _current = next;
+                _next = nullptr;
+                _position = fade_length;
+                _fade_start = -1;
+                _current_index = next->index;
+            }
+        }
+
+        if (written < n_frames)
+            std::memset(out + 2 * written, 0, (n_frames - written) * 2 * sizeof(int16_t));
+    }
+}
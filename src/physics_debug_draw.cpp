@@ -0,0 +1,399 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <SDL2/SDL_render.h>
+
+#include <include/physics_debug_draw.hpp>
+#include <include/physics_world.hpp>
+#include <include/render_target.hpp>
+#include <include/logging.hpp>
+
+namespace ts
+{
+    namespace detail
+    {
+        static SDL_Color b2_color_to_sdl(const b2Color& color, float alpha)
+        {
+            return SDL_Color{
+                Uint8(std::clamp(color.r, 0.f, 1.f) * 255),
+                Uint8(std::clamp(color.g, 0.f, 1.f) * 255),
+                Uint8(std::clamp(color.b, 0.f, 1.f) * 255),
+                Uint8(std::clamp(alpha, 0.f, 1.f) * 255)
+            };
+        }
+
+        static inline const SDL_Color contact_point_color = {255, 160, 0, 255};
+        static inline const SDL_Color contact_normal_color = {255, 255, 0, 255};
+        static inline const SDL_Color x_axis_color = {255, 0, 0, 255};
+        static inline const SDL_Color y_axis_color = {0, 255, 0, 255};
+
+        static inline constexpr float contact_point_size = 4;   // px
+        static inline constexpr float contact_normal_length = 8; // px
+        static inline constexpr float axis_length = 10; // px
+
+        // converts native vertices to world coordinates and computes their bounds, returns false if there are too few vertices
+        static bool polygon_to_world(const b2Vec2* vertices, int32 n, std::vector<float>& out, float& min_x, float& min_y, float& max_x, float& max_y)
+        {
+            const float ratio = PhysicsWorld::pixel_ratio;
+            out.clear();
+
+            min_x = min_y = std::numeric_limits<float>::max();
+            max_x = max_y = std::numeric_limits<float>::lowest();
+            for (int32 i = 0; i < n; ++i)
+            {
+                float x = vertices[i].x * ratio;
+                float y = vertices[i].y * ratio;
+                out.push_back(x);
+                out.push_back(y);
+
+                min_x = std::min(min_x, x);
+                min_y = std::min(min_y, y);
+                max_x = std::max(max_x, x);
+                max_y = std::max(max_y, y);
+            }
+
+            return n >= 3;
+        }
+    }
+
+    PhysicsDebugDraw::PhysicsDebugDraw(PhysicsWorld* world, uint8_t categories)
+        : _world(world), _categories(categories)
+    {
+        set_circle_resolution(_circle_resolution);
+    }
+
+    void PhysicsDebugDraw::set_category_enabled(Category category, bool enabled)
+    {
+        if (enabled)
+            _categories |= category;
+        else
+            _categories &= ~category;
+    }
+
+    bool PhysicsDebugDraw::get_category_enabled(Category category) const
+    {
+        return (_categories & category) != 0;
+    }
+
+    void PhysicsDebugDraw::set_culling_area(Rectangle area)
+    {
+        _culling_enabled = true;
+        _culling_area = area;
+    }
+
+    void PhysicsDebugDraw::unset_culling_area()
+    {
+        _culling_enabled = false;
+    }
+
+    void PhysicsDebugDraw::set_line_thickness(float thickness)
+    {
+        _line_thickness = thickness;
+    }
+
+    void PhysicsDebugDraw::set_circle_resolution(size_t n_vertices)
+    {
+        if (n_vertices < 3)
+        {
+            Log::warning("In ts::PhysicsDebugDraw::set_circle_resolution: at least 3 vertices are needed, resolution will be set to 3 instead.");
+            n_vertices = 3;
+        }
+
+        _circle_resolution = n_vertices;
+        _circle_unit.clear();
+        _circle_unit.reserve(2 * n_vertices);
+
+        const float step = 2 * M_PI / n_vertices;
+        for (size_t i = 0; i < n_vertices; ++i)
+        {
+            _circle_unit.push_back(std::cos(i * step));
+            _circle_unit.push_back(std::sin(i * step));
+        }
+    }
+
+    void PhysicsDebugDraw::set_fill_alpha(float alpha)
+    {
+        _fill_alpha = alpha;
+    }
+
+    size_t PhysicsDebugDraw::get_n_vertices() const
+    {
+        return _local_xy.size() / 2;
+    }
+
+    size_t PhysicsDebugDraw::get_n_triangles() const
+    {
+        return _indices.size() / 3;
+    }
+
+    void PhysicsDebugDraw::update()
+    {
+        _local_xy.clear();
+        _colors.clear();
+        _indices.clear();
+
+        uint32 flags = 0;
+        if (_categories & SHAPES)
+            flags |= b2Draw::e_shapeBit;
+        if (_categories & AABBS)
+            flags |= b2Draw::e_aabbBit;
+        if (_categories & JOINTS)
+            flags |= b2Draw::e_jointBit;
+        if (_categories & CENTERS_OF_MASS)
+            flags |= b2Draw::e_centerOfMassBit;
+
+        if (flags != 0)
+        {
+            // only registered for the duration of the call, such that multiple overlays can share a world
+            auto* native = _world->get_native();
+            SetFlags(flags);
+            native->SetDebugDraw(this);
+            native->DebugDraw();
+            native->SetDebugDraw(nullptr);
+        }
+
+        // box2d does not draw contacts itself
+        if (_categories & CONTACTS)
+            collect_contacts();
+    }
+
+    void PhysicsDebugDraw::collect_contacts()
+    {
+        const float ratio = PhysicsWorld::pixel_ratio;
+        const float half = detail::contact_point_size / 2;
+
+        auto manifold = b2WorldManifold();
+        for (auto* contact = _world->get_native()->GetContactList(); contact != nullptr; contact = contact->GetNext())
+        {
+            if (not contact->IsTouching())
+                continue;
+
+            int32 n_points = contact->GetManifold()->pointCount;
+            if (n_points == 0)
+                continue;
+
+            contact->GetWorldManifold(&manifold);
+            for (int32 i = 0; i < n_points; ++i)
+            {
+                float x = manifold.points[i].x * ratio;
+                float y = manifold.points[i].y * ratio;
+                if (is_culled(x - half, y - half, x + half, y + half))
+                    continue;
+
+                push_point(x, y, detail::contact_point_size, detail::contact_point_color);
+                push_line(x, y,
+                    x + manifold.normal.x * detail::contact_normal_length,
+                    y + manifold.normal.y * detail::contact_normal_length,
+                    detail::contact_normal_color
+                );
+            }
+        }
+    }
+
+    bool PhysicsDebugDraw::is_culled(float min_x, float min_y, float max_x, float max_y) const
+    {
+        if (not _culling_enabled)
+            return false;
+
+        return max_x < _culling_area.top_left.x or
+               max_y < _culling_area.top_left.y or
+               min_x > _culling_area.top_left.x + _culling_area.size.x or
+               min_y > _culling_area.top_left.y + _culling_area.size.y;
+    }
+
+    int PhysicsDebugDraw::push_vertex(float x, float y, SDL_Color color)
+    {
+        int index = _local_xy.size() / 2;
+        _local_xy.push_back(x);
+        _local_xy.push_back(y);
+        _colors.push_back(color);
+        return index;
+    }
+
+    void PhysicsDebugDraw::push_point(float x, float y, float size, SDL_Color color)
+    {
+        float half = size / 2;
+        auto first = push_vertex(x - half, y - half, color);
+        push_vertex(x + half, y - half, color);
+        push_vertex(x + half, y + half, color);
+        push_vertex(x - half, y + half, color);
+        _indices.insert(_indices.end(), {first, first + 1, first + 2, first, first + 2, first + 3});
+    }
+
+    void PhysicsDebugDraw::push_line(float ax, float ay, float bx, float by, SDL_Color color)
+    {
+        float dx = bx - ax;
+        float dy = by - ay;
+        float length = std::sqrt(dx * dx + dy * dy);
+        if (length < std::numeric_limits<float>::epsilon())
+            return;
+
+        float half = _line_thickness / 2;
+        float nx = -dy / length * half;
+        float ny = dx / length * half;
+
+        auto first = push_vertex(ax + nx, ay + ny, color);
+        push_vertex(ax - nx, ay - ny, color);
+        push_vertex(bx - nx, by - ny, color);
+        push_vertex(bx + nx, by + ny, color);
+        _indices.insert(_indices.end(), {first, first + 1, first + 2, first, first + 2, first + 3});
+    }
+
+    void PhysicsDebugDraw::DrawPolygon(const b2Vec2* vertices, int32 n_vertices, const b2Color& color)
+    {
+        auto& xy = _polygon_scratch;
+        float min_x, min_y, max_x, max_y;
+        if (not detail::polygon_to_world(vertices, n_vertices, xy, min_x, min_y, max_x, max_y) or is_culled(min_x, min_y, max_x, max_y))
+            return;
+
+        auto sdl_color = detail::b2_color_to_sdl(color, 1);
+        for (int32 i = 0; i < n_vertices; ++i)
+        {
+            size_t next = (i + 1) % n_vertices;
+            push_line(xy[2*i], xy[2*i+1], xy[2*next], xy[2*next+1], sdl_color);
+        }
+    }
+
+    void PhysicsDebugDraw::DrawSolidPolygon(const b2Vec2* vertices, int32 n_vertices, const b2Color& color)
+    {
+        auto& xy = _polygon_scratch;
+        float min_x, min_y, max_x, max_y;
+        if (not detail::polygon_to_world(vertices, n_vertices, xy, min_x, min_y, max_x, max_y) or is_culled(min_x, min_y, max_x, max_y))
+            return;
+
+        // fill as a fan, box2d polygons are convex
+        auto fill_color = detail::b2_color_to_sdl(color, _fill_alpha);
+        auto first = push_vertex(xy[0], xy[1], fill_color);
+        for (int32 i = 1; i < n_vertices; ++i)
+            push_vertex(xy[2*i], xy[2*i+1], fill_color);
+
+        for (int32 i = 1; i + 1 < n_vertices; ++i)
+            _indices.insert(_indices.end(), {first, first + i, first + i + 1});
+
+        auto outline_color = detail::b2_color_to_sdl(color, 1);
+        for (int32 i = 0; i < n_vertices; ++i)
+        {
+            size_t next = (i + 1) % n_vertices;
+            push_line(xy[2*i], xy[2*i+1], xy[2*next], xy[2*next+1], outline_color);
+        }
+    }
+
+    void PhysicsDebugDraw::DrawCircle(const b2Vec2& center, float radius, const b2Color& color)
+    {
+        const float ratio = PhysicsWorld::pixel_ratio;
+        float x = center.x * ratio;
+        float y = center.y * ratio;
+        float r = radius * ratio;
+
+        if (is_culled(x - r, y - r, x + r, y + r))
+            return;
+
+        auto sdl_color = detail::b2_color_to_sdl(color, 1);
+        for (size_t i = 0; i < _circle_resolution; ++i)
+        {
+            size_t next = (i + 1) % _circle_resolution;
+            push_line(
+                x + _circle_unit[2*i] * r, y + _circle_unit[2*i+1] * r,
+                x + _circle_unit[2*next] * r, y + _circle_unit[2*next+1] * r,
+                sdl_color
+            );
+        }
+    }
+
+    void PhysicsDebugDraw::DrawSolidCircle(const b2Vec2& center, float radius, const b2Vec2& axis, const b2Color& color)
+    {
+        const float ratio = PhysicsWorld::pixel_ratio;
+        float x = center.x * ratio;
+        float y = center.y * ratio;
+        float r = radius * ratio;
+
+        if (is_culled(x - r, y - r, x + r, y + r))
+            return;
+
+        auto fill_color = detail::b2_color_to_sdl(color, _fill_alpha);
+        auto first = push_vertex(x, y, fill_color);
+        for (size_t i = 0; i < _circle_resolution; ++i)
+            push_vertex(x + _circle_unit[2*i] * r, y + _circle_unit[2*i+1] * r, fill_color);
+
+        int n = _circle_resolution;
+        for (int i = 0; i < n; ++i)
+            _indices.insert(_indices.end(), {first, first + 1 + i, first + 1 + (i + 1) % n});
+
+        DrawCircle(center, radius, color);
+        push_line(x, y, x + axis.x * r, y + axis.y * r, detail::b2_color_to_sdl(color, 1));
+    }
+
+    void PhysicsDebugDraw::DrawSegment(const b2Vec2& a, const b2Vec2& b, const b2Color& color)
+    {
+        const float ratio = PhysicsWorld::pixel_ratio;
+        float ax = a.x * ratio;
+        float ay = a.y * ratio;
+        float bx = b.x * ratio;
+        float by = b.y * ratio;
+
+        if (is_culled(std::min(ax, bx), std::min(ay, by), std::max(ax, bx), std::max(ay, by)))
+            return;
+
+        push_line(ax, ay, bx, by, detail::b2_color_to_sdl(color, 1));
+    }
+
+    void PhysicsDebugDraw::DrawTransform(const b2Transform& transform)
+    {
+        const float ratio = PhysicsWorld::pixel_ratio;
+        const float length = detail::axis_length;
+        float x = transform.p.x * ratio;
+        float y = transform.p.y * ratio;
+
+        if (is_culled(x - length, y - length, x + length, y + length))
+            return;
+
+        // columns of the rotation matrix are the local axes
+        push_line(x, y, x + transform.q.c * length, y + transform.q.s * length, detail::x_axis_color);
+        push_line(x, y, x - transform.q.s * length, y + transform.q.c * length, detail::y_axis_color);
+    }
+
+    void PhysicsDebugDraw::DrawPoint(const b2Vec2& point, float size, const b2Color& color)
+    {
+        const float ratio = PhysicsWorld::pixel_ratio;
+        float x = point.x * ratio;
+        float y = point.y * ratio;
+        float half = size / 2;
+
+        if (is_culled(x - half, y - half, x + half, y + half))
+            return;
+
+        push_point(x, y, size, detail::b2_color_to_sdl(color, 1));
+    }
+
+    void PhysicsDebugDraw::render(RenderTarget* target, Transform transform) const
+    {
+        if (_indices.empty())
+            return;
+
+        _xy.resize(_local_xy.size());
+        for (size_t i = 0; i < _local_xy.size(); i += 2)
+        {
+            auto new_pos = transform.apply_to(Vector2f{_local_xy[i], _local_xy[i+1]});
+            _xy[i] = new_pos.x;
+            _xy[i+1] = new_pos.y;
+        }
+
+        SDL_SetRenderDrawBlendMode(target->get_renderer(), SDL_BLENDMODE_BLEND);
+        SDL_RenderGeometryRaw(
+                target->get_renderer(),
+                nullptr,
+                _xy.data(), 2 * sizeof(float),
+                _colors.data(), sizeof(SDL_Color),
+                nullptr, 0,
+                _xy.size() / 2,
+                _indices.data(), _indices.size(), sizeof(int)
+        );
+        SDL_SetRenderDrawBlendMode(target->get_renderer(), SDL_BLENDMODE_NONE);
+    }
+}
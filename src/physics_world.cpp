@@ -3,15 +3,91 @@
 // Created on 6/5/22 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
 //
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <sstream>
+#include <tuple>
+
 #include <box2d/b2_contact.h>
 #include <box2d/b2_distance.h>
 
 #include <include/physics_world.hpp>
 #include <include/window.hpp>
 #include <include/collision_shape.hpp>
+#include <include/collision_polygon.hpp>
+#include <include/logging.hpp>
 
 namespace ts
 {
+    namespace detail
+    {
+        // binary layout of ts::PhysicsWorld::snapshot:
+        //   SnapshotHeader
+        //   SnapshotBody * n_bodies, in order of the box2d body list
+        //   PhysicsWorld::SnapshotContact * n_contacts, sorted by shape ids
+
+        struct SnapshotHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t n_bodies;
+            uint32_t n_contacts;
+        };
+
+        struct SnapshotBody
+        {
+            uint64_t id;
+            float position_x, position_y, angle;
+            float linear_velocity_x, linear_velocity_y, angular_velocity;
+            uint32_t flags;
+        };
+
+        static inline constexpr uint32_t snapshot_magic = 0x57505354; // "TSPW"
+        static inline constexpr uint32_t snapshot_flag_awake = 1 << 0;
+        static inline constexpr uint32_t snapshot_flag_enabled = 1 << 1;
+
+        // id of the shape owning a body, 0 if the body was not created by telescope
+        static size_t get_body_id(b2Body* body)
+        {
+            auto* shape = (CollisionShape*) body->GetUserData().pointer;
+            return shape != nullptr ? shape->get_id() : 0;
+        }
+
+        // mirrors b2PolygonShape::Set: points closer than half the linear slop are welded, if the remaining
+        // points span no area box2d asserts in debug builds and silently substitutes a box in release builds
+        static bool is_degenerate_polygon(const b2Vec2* points, size_t n)
+        {
+            auto welded = std::array<b2Vec2, b2_maxPolygonVertices>();
+            size_t n_welded = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                bool is_unique = true;
+                for (size_t j = 0; j < n_welded; ++j)
+                {
+                    if (b2DistanceSquared(points[i], welded[j]) < (0.5f * b2_linearSlop) * (0.5f * b2_linearSlop))
+                    {
+                        is_unique = false;
+                        break;
+                    }
+                }
+
+                if (is_unique)
+                    welded[n_welded++] = points[i];
+            }
+
+            // the hull contains the largest triangle, so if that has no area neither does the hull
+            float max_area = 0;
+            for (size_t a = 0; a < n_welded; ++a)
+                for (size_t b = a + 1; b < n_welded; ++b)
+                    for (size_t c = b + 1; c < n_welded; ++c)
+                        max_area = std::max(max_area, 0.5f * std::abs(b2Cross(welded[b] - welded[a], welded[c] - welded[a])));
+
+            return max_area <= b2_epsilon;
+        }
+    }
+
     PhysicsWorld::PhysicsWorld()
         : _world(_default_gravity), _contact_listener(this)
     {
@@ -19,11 +95,244 @@ namespace ts
     }
 
     PhysicsWorld::~PhysicsWorld()
-    {}
+    {
+        // box2d frees all bodies with the world, shapes that outlive it must not touch theirs
+        for (auto* body = _world.GetBodyList(); body != nullptr; body = body->GetNext())
+        {
+            auto* shape = (CollisionShape*) body->GetUserData().pointer;
+            if (shape == nullptr)
+                continue;
+
+            shape->_world = nullptr;
+            shape->_body = nullptr;
+            shape->_was_destroyed = true;
+        }
+    }
 
     void PhysicsWorld::step(Time timestep, int32_t velocity_iterations, int32_t position_iterations)
     {
+        _contact_listener_ns = 0;
         _world.Step(timestep.as_seconds(), velocity_iterations, position_iterations);
+        update_triggers();
+        update_awake_shapes();
+        dispatch_events();
+        update_profile();
+    }
+
+    void PhysicsWorld::update_awake_shapes()
+    {
+        _awake_epoch += 1;
+        _awake_shapes.clear(); // keeps capacity
+        _awake_stack.clear();
+
+        // shapes awake at the start of the step may have moved, even if they fell asleep at its end
+        auto visit = [&](CollisionShape* shape, bool was_awake) {
+            if (shape->_awake_epoch == _awake_epoch)
+                return;
+
+            shape->_awake_epoch = _awake_epoch;
+
+            auto* body = shape->_body;
+            if (body->GetType() == b2_staticBody or not body->IsEnabled())
+                return;
+
+            bool is_awake = body->IsAwake();
+            if (not is_awake and not was_awake)
+                return;
+
+            shape->_awake_shape_index = _awake_shapes.size();
+            _awake_shapes.push_back(shape);
+
+            if (is_awake)
+                _awake_stack.push_back(shape);
+        };
+
+        for (auto* shape : _awake_bodies)
+            visit(shape, true);
+
+        for (auto* shape : _woken_shapes)
+            visit(shape, true);
+
+        _woken_shapes.clear();
+        _awake_bodies.clear();
+
+        // the solver wakes every body that touches an awake body, directly or through a chain of contacts, but
+        // never across static bodies. Following the same edges finds them, while only visiting awake bodies and their neighbors
+        while (not _awake_stack.empty())
+        {
+            auto* shape = _awake_stack.back();
+            _awake_stack.pop_back();
+
+            shape->_awake_body_index = _awake_bodies.size();
+            _awake_bodies.push_back(shape);
+
+            for (auto* edge = shape->_body->GetContactList(); edge != nullptr; edge = edge->next)
+            {
+                auto* contact = edge->contact;
+                if (not contact->IsTouching() or not contact->IsEnabled() or contact->GetFixtureA()->IsSensor() or contact->GetFixtureB()->IsSensor())
+                    continue;
+
+                if (auto* other = (CollisionShape*) edge->other->GetUserData().pointer)
+                    visit(other, false);
+            }
+
+            for (auto* edge = shape->_body->GetJointList(); edge != nullptr; edge = edge->next)
+                if (auto* other = (CollisionShape*) edge->other->GetUserData().pointer)
+                    visit(other, false);
+        }
+
+        _n_awake_bodies = _awake_bodies.size();
+    }
+
+    void PhysicsWorld::on_shape_woken(CollisionShape* shape)
+    {
+        size_t index = shape->_woken_index;
+        if (index < _woken_shapes.size() and _woken_shapes[index] == shape)
+            return;
+
+        shape->_woken_index = _woken_shapes.size();
+        _woken_shapes.push_back(shape);
+    }
+
+    void PhysicsWorld::on_shape_created(CollisionShape* shape)
+    {
+        _id_to_shape.insert({shape->get_id(), shape});
+    }
+
+    void PhysicsWorld::on_shape_destroyed(CollisionShape* shape)
+    {
+        _id_to_shape.erase(shape->get_id());
+
+        // indices are only valid if the list still holds the shape at that position
+        auto remove = [shape](std::vector<CollisionShape*>& list, size_t CollisionShape::* index) {
+            size_t i = shape->*index;
+            if (i >= list.size() or list[i] != shape)
+                return;
+
+            list[i] = list.back();
+            list[i]->*index = i;
+            list.pop_back();
+        };
+
+        remove(_awake_shapes, &CollisionShape::_awake_shape_index);
+        remove(_awake_bodies, &CollisionShape::_awake_body_index);
+        remove(_woken_shapes, &CollisionShape::_woken_index);
+    }
+
+    const std::vector<CollisionShape*>& PhysicsWorld::get_awake_shapes() const
+    {
+        return _awake_shapes;
+    }
+
+    void PhysicsWorld::update_profile()
+    {
+        _profile_index = (_profile_index + 1) % _profiles.size();
+        _n_profiles = std::min(_n_profiles + 1, _profiles.size());
+
+        auto& profile = _profiles.at(_profile_index);
+        auto& native = _world.GetProfile(); // milliseconds
+
+        profile.step = milliseconds(native.step);
+        profile.collide = milliseconds(native.collide);
+        profile.solve = milliseconds(native.solve);
+        profile.solve_toi = milliseconds(native.solveTOI);
+        profile.broadphase = milliseconds(native.broadphase);
+        profile.contact_listener = nanoseconds(_contact_listener_ns);
+        profile.dispatch = _dispatch_statistics.dispatch_duration;
+
+        profile.n_bodies = _world.GetBodyCount();
+        profile.n_awake_bodies = _n_awake_bodies;
+        profile.n_contacts = _world.GetContactCount();
+        profile.n_proxies = _world.GetProxyCount();
+    }
+
+    PhysicsStepProfile PhysicsWorld::get_last_step_profile() const
+    {
+        if (_n_profiles == 0)
+            return PhysicsStepProfile();
+
+        return _profiles.at(_profile_index);
+    }
+
+    PhysicsStepProfile PhysicsWorld::get_average_step_profile() const
+    {
+        if (_n_profiles == 0)
+            return PhysicsStepProfile();
+
+        double step = 0, collide = 0, solve = 0, solve_toi = 0, broadphase = 0, contact_listener = 0, dispatch = 0;
+        size_t n_bodies = 0, n_awake_bodies = 0, n_contacts = 0, n_proxies = 0;
+
+        // the newest _n_profiles slots, going back from the last one written
+        for (size_t i = 0; i < _n_profiles; ++i)
+        {
+            auto& profile = _profiles.at((_profile_index + _profiles.size() - i) % _profiles.size());
+            step += profile.step.as_microseconds();
+            collide += profile.collide.as_microseconds();
+            solve += profile.solve.as_microseconds();
+            solve_toi += profile.solve_toi.as_microseconds();
+            broadphase += profile.broadphase.as_microseconds();
+            contact_listener += profile.contact_listener.as_microseconds();
+            dispatch += profile.dispatch.as_microseconds();
+            n_bodies += profile.n_bodies;
+            n_awake_bodies += profile.n_awake_bodies;
+            n_contacts += profile.n_contacts;
+            n_proxies += profile.n_proxies;
+        }
+
+        auto out = PhysicsStepProfile();
+        out.step = microseconds(step / _n_profiles);
+        out.collide = microseconds(collide / _n_profiles);
+        out.solve = microseconds(solve / _n_profiles);
+        out.solve_toi = microseconds(solve_toi / _n_profiles);
+        out.broadphase = microseconds(broadphase / _n_profiles);
+        out.contact_listener = microseconds(contact_listener / _n_profiles);
+        out.dispatch = microseconds(dispatch / _n_profiles);
+        out.n_bodies = n_bodies / _n_profiles;
+        out.n_awake_bodies = n_awake_bodies / _n_profiles;
+        out.n_contacts = n_contacts / _n_profiles;
+        out.n_proxies = n_proxies / _n_profiles;
+        return out;
+    }
+
+    PhysicsStepProfile PhysicsWorld::get_max_step_profile() const
+    {
+        auto out = PhysicsStepProfile();
+
+        auto max = [](Time a, Time b) -> Time {
+            return a.as_nanoseconds() > b.as_nanoseconds() ? a : b;
+        };
+
+        // the newest _n_profiles slots, going back from the last one written
+        for (size_t i = 0; i < _n_profiles; ++i)
+        {
+            auto& profile = _profiles.at((_profile_index + _profiles.size() - i) % _profiles.size());
+            out.step = max(out.step, profile.step);
+            out.collide = max(out.collide, profile.collide);
+            out.solve = max(out.solve, profile.solve);
+            out.solve_toi = max(out.solve_toi, profile.solve_toi);
+            out.broadphase = max(out.broadphase, profile.broadphase);
+            out.contact_listener = max(out.contact_listener, profile.contact_listener);
+            out.dispatch = max(out.dispatch, profile.dispatch);
+            out.n_bodies = std::max(out.n_bodies, profile.n_bodies);
+            out.n_awake_bodies = std::max(out.n_awake_bodies, profile.n_awake_bodies);
+            out.n_contacts = std::max(out.n_contacts, profile.n_contacts);
+            out.n_proxies = std::max(out.n_proxies, profile.n_proxies);
+        }
+
+        return out;
+    }
+
+    void PhysicsWorld::set_profile_window_size(size_t n_steps)
+    {
+        if (n_steps == 0)
+        {
+            Log::warning("In ts::PhysicsWorld::set_profile_window_size: window size cannot be 0, the window size was not changed.");
+            return;
+        }
+
+        _profiles.assign(n_steps, PhysicsStepProfile());
+        _profile_index = 0;
+        _n_profiles = 0;
     }
 
     b2World *PhysicsWorld::get_native()
@@ -74,32 +383,56 @@ namespace ts
     DistanceInformation PhysicsWorld::distance_between(CollisionShape *a, CollisionShape *b)
     {
         auto in = b2DistanceInput();
-        in.proxyA.Set(a->get_native_fixture()->GetShape(), 0);
-        in.proxyB.Set(b->get_native_fixture()->GetShape(), 0);
         in.transformA = a->get_native_body()->GetTransform();
         in.transformB = b->get_native_body()->GetTransform();
 
-        auto out = b2DistanceOutput();
-        auto cache = b2SimplexCache();
+        // shapes may consist of more than one fixture, such as compounds and line sequences, each with one or more children
+        auto best = b2DistanceOutput();
+        best.distance = std::numeric_limits<float>::max();
+
+        for (auto* fixture_a = a->get_native_body()->GetFixtureList(); fixture_a != nullptr; fixture_a = fixture_a->GetNext())
+        {
+            for (int32 child_a = 0; child_a < fixture_a->GetShape()->GetChildCount(); ++child_a)
+            {
+                in.proxyA.Set(fixture_a->GetShape(), child_a);
+
+                for (auto* fixture_b = b->get_native_body()->GetFixtureList(); fixture_b != nullptr; fixture_b = fixture_b->GetNext())
+                {
+                    for (int32 child_b = 0; child_b < fixture_b->GetShape()->GetChildCount(); ++child_b)
+                    {
+                        in.proxyB.Set(fixture_b->GetShape(), child_b);
+
+                        auto out = b2DistanceOutput();
+                        auto cache = b2SimplexCache();
+                        cache.count = 0;
+
+                        b2Distance(&out, &cache, &in);
+                        if (out.distance < best.distance)
+                            best = out;
+                    }
+                }
+            }
+        }
 
-        b2Distance(&out, &cache, &in);
         return ts::DistanceInformation{
-                out.distance * pixel_ratio,
-                {native_to_world(Vector2f(out.pointA.x, out.pointA.y)), native_to_world(Vector2f(out.pointB.x, out.pointB.y))}
+                best.distance * pixel_ratio,
+                {native_to_world(Vector2f(best.pointA.x, best.pointA.y)), native_to_world(Vector2f(best.pointB.x, best.pointB.y))}
         };
     }
 
     bool PhysicsWorld::is_point_in_shape(CollisionShape *a, Vector2f point)
     {
         point = world_to_native(point);
-        return a->get_native_shape()->TestPoint(a->get_native_body()->GetTransform(), b2Vec2(point.x, point.y));
+
+        for (auto* fixture = a->get_native_body()->GetFixtureList(); fixture != nullptr; fixture = fixture->GetNext())
+            if (fixture->TestPoint(b2Vec2(point.x, point.y)))
+                return true;
+
+        return false;
     }
 
     RayCastInformation PhysicsWorld::ray_cast(CollisionShape *a, Vector2f ray_start, Vector2f ray_end, float multiplier)
     {
-        static auto transform = a->get_native_body()->GetTransform();
-        auto* shape = a->get_native_shape();
-
         ray_start = world_to_native(ray_start);
         ray_end = world_to_native(ray_end);
 
@@ -110,9 +443,26 @@ namespace ts
         in.p2.y = ray_end.y;
         in.maxFraction = multiplier; // multiplier of length
 
+        // earliest hit over all fixtures and their children, each hit shortens the ray for the next
+        bool hit = false;
         auto out = b2RayCastOutput();
+        out.normal = b2Vec2(0, 0);
+        out.fraction = 0;
+
+        for (auto* fixture = a->get_native_body()->GetFixtureList(); fixture != nullptr; fixture = fixture->GetNext())
+        {
+            for (int32 child = 0; child < fixture->GetShape()->GetChildCount(); ++child)
+            {
+                auto current = b2RayCastOutput();
+                if (fixture->RayCast(&current, in, child))
+                {
+                    hit = true;
+                    out = current;
+                    in.maxFraction = current.fraction;
+                }
+            }
+        }
 
-        bool hit = shape->RayCast(&out, in, transform, 0);
         b2Vec2 hit_point = in.p1 + out.fraction * (in.p2 - in.p1);
         // source: https://box2d.org/documentation/md__d_1__git_hub_box2d_docs_collision.html#autotoc_md43
 
@@ -150,29 +500,897 @@ namespace ts
         _event_queue.clear();
     }
 
+    size_t PhysicsWorld::snapshot(std::vector<uint8_t>& buffer)
+    {
+        size_t n_bodies = 0;
+        for (auto* body = _world.GetBodyList(); body != nullptr; body = body->GetNext())
+            if (detail::get_body_id(body) != 0)
+                n_bodies += 1;
+
+        _snapshot_contacts.clear();
+        for (auto* contact = _world.GetContactList(); contact != nullptr; contact = contact->GetNext())
+        {
+            if (not contact->IsTouching())
+                continue; // no accumulated impulses
+
+            auto* shape_a = (CollisionShape*) contact->GetFixtureA()->GetUserData().pointer;
+            auto* shape_b = (CollisionShape*) contact->GetFixtureB()->GetUserData().pointer;
+            if (shape_a == nullptr or shape_b == nullptr)
+                continue;
+
+            auto* manifold = contact->GetManifold();
+            auto record = SnapshotContact{
+                shape_a->get_id(), shape_b->get_id(),
+                contact->GetChildIndexA(), contact->GetChildIndexB(),
+                {0, 0}, {0, 0}, {0, 0},
+                uint32_t(manifold->pointCount)
+            };
+
+            for (int32 i = 0; i < manifold->pointCount and i < 2; ++i)
+            {
+                record.feature_keys[i] = manifold->points[i].id.key;
+                record.normal_impulses[i] = manifold->points[i].normalImpulse;
+                record.tangent_impulses[i] = manifold->points[i].tangentImpulse;
+            }
+
+            if (record.id_a > record.id_b)
+            {
+                std::swap(record.id_a, record.id_b);
+                std::swap(record.child_a, record.child_b);
+            }
+
+            _snapshot_contacts.push_back(record);
+        }
+
+        std::sort(_snapshot_contacts.begin(), _snapshot_contacts.end(), [](const SnapshotContact& a, const SnapshotContact& b){
+            return std::tie(a.id_a, a.id_b, a.child_a, a.child_b) < std::tie(b.id_a, b.id_b, b.child_a, b.child_b);
+        });
+
+        size_t size = sizeof(detail::SnapshotHeader)
+            + n_bodies * sizeof(detail::SnapshotBody)
+            + _snapshot_contacts.size() * sizeof(SnapshotContact);
+
+        if (buffer.size() < size)
+            buffer.resize(size);
+
+        auto header = detail::SnapshotHeader{
+            detail::snapshot_magic,
+            snapshot_version,
+            uint32_t(n_bodies),
+            uint32_t(_snapshot_contacts.size())
+        };
+
+        auto* out = buffer.data();
+        std::memcpy(out, &header, sizeof(header));
+        out += sizeof(header);
+
+        for (auto* body = _world.GetBodyList(); body != nullptr; body = body->GetNext())
+        {
+            auto id = detail::get_body_id(body);
+            if (id == 0)
+                continue;
+
+            auto& position = body->GetPosition();
+            auto& velocity = body->GetLinearVelocity();
+
+            auto record = detail::SnapshotBody{
+                id,
+                position.x, position.y, body->GetAngle(),
+                velocity.x, velocity.y, body->GetAngularVelocity(),
+                (body->IsAwake() ? detail::snapshot_flag_awake : 0) | (body->IsEnabled() ? detail::snapshot_flag_enabled : 0)
+            };
+
+            std::memcpy(out, &record, sizeof(record));
+            out += sizeof(record);
+        }
+
+        if (not _snapshot_contacts.empty())
+            std::memcpy(out, _snapshot_contacts.data(), _snapshot_contacts.size() * sizeof(SnapshotContact));
+
+        return size;
+    }
+
+    bool PhysicsWorld::restore(const std::vector<uint8_t>& buffer)
+    {
+        auto header = detail::SnapshotHeader();
+        if (buffer.size() >= sizeof(header))
+            std::memcpy(&header, buffer.data(), sizeof(header));
+
+        if (buffer.size() < sizeof(header) or header.magic != detail::snapshot_magic)
+        {
+            Log::warning("In ts::PhysicsWorld::restore: buffer does not contain a snapshot, world was not modified.");
+            return false;
+        }
+
+        if (header.version != snapshot_version)
+        {
+            Log::warning("In ts::PhysicsWorld::restore: snapshot version ", header.version, " is not supported, expected version ", snapshot_version, ". World was not modified.");
+            return false;
+        }
+
+        size_t body_offset = sizeof(header);
+        size_t contact_offset = body_offset + header.n_bodies * sizeof(detail::SnapshotBody);
+        if (buffer.size() < contact_offset + header.n_contacts * sizeof(SnapshotContact))
+        {
+            Log::warning("In ts::PhysicsWorld::restore: snapshot is truncated, world was not modified.");
+            return false;
+        }
+
+        // bodies: if no bodies were added or removed since the snapshot, the body list is in the same order
+        // as the records, which makes matching free. Otherwise, fall back to looking up shapes by id
+
+        auto* next = _world.GetBodyList();
+        bool in_order = true;
+
+        for (size_t i = 0; i < header.n_bodies; ++i)
+        {
+            auto record = detail::SnapshotBody();
+            std::memcpy(&record, buffer.data() + body_offset + i * sizeof(record), sizeof(record));
+
+            while (next != nullptr and detail::get_body_id(next) == 0)
+                next = next->GetNext();
+
+            b2Body* body = nullptr;
+            if (in_order and next != nullptr and detail::get_body_id(next) == record.id)
+            {
+                body = next;
+                next = next->GetNext();
+            }
+            else
+            {
+                in_order = false;
+
+                auto it = _id_to_shape.find(record.id);
+                if (it == _id_to_shape.end())
+                    continue; // shape was destroyed since
+
+                body = it->second->get_native_body();
+            }
+
+            bool enabled = record.flags & detail::snapshot_flag_enabled;
+            if (body->IsEnabled() != enabled)
+                body->SetEnabled(enabled);
+
+            body->SetTransform(b2Vec2(record.position_x, record.position_y), record.angle);
+            on_shape_woken((CollisionShape*) body->GetUserData().pointer);
+
+            // woken up even if asleep in the snapshot, such that its contacts are updated below
+            body->SetAwake(true);
+            body->SetLinearVelocity(b2Vec2(record.linear_velocity_x, record.linear_velocity_y));
+            body->SetAngularVelocity(record.angular_velocity);
+
+            if (not (record.flags & detail::snapshot_flag_awake))
+                _sleeping_bodies.push_back(body);
+        }
+
+        // a step of length 0 creates contacts that are touching in the snapshot but did not exist in the world,
+        // and updates all manifolds to the restored transforms, without moving any body
+        _world.Step(0, 0, 0);
+
+        for (auto* body : _sleeping_bodies)
+            body->SetAwake(false); // also zeroes velocities
+
+        _sleeping_bodies.clear();
+
+        // contacts: restore accumulated impulses used for warm starting
+
+        auto read_contact = [&](size_t i) -> SnapshotContact {
+            auto out = SnapshotContact();
+            std::memcpy(&out, buffer.data() + contact_offset + i * sizeof(out), sizeof(out));
+            return out;
+        };
+
+        for (auto* contact = _world.GetContactList(); contact != nullptr; contact = contact->GetNext())
+        {
+            auto* manifold = contact->GetManifold();
+            auto* shape_a = (CollisionShape*) contact->GetFixtureA()->GetUserData().pointer;
+            auto* shape_b = (CollisionShape*) contact->GetFixtureB()->GetUserData().pointer;
+
+            bool found = false;
+            auto record = SnapshotContact();
+
+            if (shape_a != nullptr and shape_b != nullptr)
+            {
+                uint64_t id_a = shape_a->get_id();
+                uint64_t id_b = shape_b->get_id();
+                int32_t child_a = contact->GetChildIndexA();
+                int32_t child_b = contact->GetChildIndexB();
+
+                if (id_a > id_b)
+                {
+                    std::swap(id_a, id_b);
+                    std::swap(child_a, child_b);
+                }
+
+                auto key = std::tie(id_a, id_b, child_a, child_b);
+
+                size_t low = 0;
+                size_t high = header.n_contacts;
+                while (low < high)
+                {
+                    size_t mid = low + (high - low) / 2;
+                    record = read_contact(mid);
+                    auto mid_key = std::tie(record.id_a, record.id_b, record.child_a, record.child_b);
+
+                    if (mid_key < key)
+                        low = mid + 1;
+                    else if (key < mid_key)
+                        high = mid;
+                    else
+                    {
+                        found = true;
+                        break;
+                    }
+                }
+            }
+
+            // points are matched by their contact feature, like box2d does when it updates a manifold
+            for (int32 i = 0; i < manifold->pointCount and i < 2; ++i)
+            {
+                auto& point = manifold->points[i];
+                point.normalImpulse = 0;
+                point.tangentImpulse = 0;
+
+                for (uint32_t j = 0; found and j < record.n_points and j < 2; ++j)
+                {
+                    if (record.feature_keys[j] == point.id.key)
+                    {
+                        point.normalImpulse = record.normal_impulses[j];
+                        point.tangentImpulse = record.tangent_impulses[j];
+                        break;
+                    }
+                }
+            }
+        }
+
+        // contacts that began or ended because of the restore are not reported on any path: trigger overlaps are
+        // updated to the restored state without reporting entered or exited shapes, no events or callbacks are queued
+        update_triggers();
+        for (auto* shape : _changed_triggers)
+        {
+            auto& trigger = _triggers.at(_shape_to_trigger.at(shape->get_id()));
+            trigger.entered.clear();
+            trigger.exited.clear();
+        }
+        _changed_triggers.clear();
+
+        _dispatch_buffer.clear();
+        clear_events();
+        return true;
+    }
+
+    CollisionCallbackID PhysicsWorld::allocate_callback(CollisionCallback callback, size_t shape_id)
+    {
+        // slots of removed callbacks are reused, such that adding and removing callbacks does not grow the tables
+        if (not _free_callbacks.empty())
+        {
+            auto id = _free_callbacks.back();
+            _free_callbacks.pop_back();
+
+            _callbacks.at(id) = std::move(callback);
+            _callback_last_event.at(id) = -1;
+            _callback_shape.at(id) = shape_id;
+            return id;
+        }
+
+        CollisionCallbackID id = _callbacks.size();
+        _callbacks.push_back(std::move(callback));
+        _callback_last_event.push_back(-1);
+        _callback_shape.push_back(shape_id);
+        return id;
+    }
+
+    CollisionCallbackID PhysicsWorld::add_collision_callback(CollisionShape* shape, CollisionCallback callback)
+    {
+        auto id = allocate_callback(std::move(callback), shape->get_id());
+
+        _shape_to_callbacks[shape->get_id()].push_back({id, false});
+        _n_shape_callbacks += 1;
+        return id;
+    }
+
+    CollisionCallbackID PhysicsWorld::add_collision_callback(CollisionFilterGroup group_a, CollisionFilterGroup group_b, CollisionCallback callback)
+    {
+        auto id = allocate_callback(std::move(callback), 0);
+
+        // groups may be bitwise-or'd, register for every pair of single groups
+
+        for (size_t i = 0; i < _n_groups; ++i)
+        {
+            if (not ((uint16_t) group_a & (uint16_t(1) << i)))
+                continue;
+
+            for (size_t j = 0; j < _n_groups; ++j)
+            {
+                if (not ((uint16_t) group_b & (uint16_t(1) << j)))
+                    continue;
+
+                _group_pair_to_callbacks.at(i * _n_groups + j).push_back({id, false});
+
+                if (i != j)
+                    _group_pair_to_callbacks.at(j * _n_groups + i).push_back({id, true});
+            }
+        }
+
+        _n_group_callbacks += 1;
+        return id;
+    }
+
+    void PhysicsWorld::remove_collision_callback(CollisionCallbackID id)
+    {
+        if (id >= _callbacks.size() or not _callbacks.at(id))
+            return;
+
+        _callbacks.at(id) = nullptr;
+        _free_callbacks.push_back(id);
+
+        auto erase_from = [id](std::vector<CallbackEntry>& entries) {
+            entries.erase(std::remove_if(entries.begin(), entries.end(), [id](const CallbackEntry& entry){
+                return entry.id == id;
+            }), entries.end());
+        };
+
+        auto shape_id = _callback_shape.at(id);
+        if (shape_id != 0)
+        {
+            auto it = _shape_to_callbacks.find(shape_id);
+            if (it != _shape_to_callbacks.end())
+            {
+                erase_from(it->second);
+                if (it->second.empty())
+                    _shape_to_callbacks.erase(it);
+            }
+
+            _n_shape_callbacks -= 1;
+        }
+        else
+        {
+            for (auto& entries : _group_pair_to_callbacks)
+                erase_from(entries);
+
+            _n_group_callbacks -= 1;
+        }
+    }
+
+    void PhysicsWorld::remove_collision_callbacks(CollisionShape* shape)
+    {
+        take_collision_callbacks(shape);
+    }
+
+    std::vector<CollisionCallback> PhysicsWorld::take_collision_callbacks(CollisionShape* shape)
+    {
+        auto out = std::vector<CollisionCallback>();
+
+        auto it = _shape_to_callbacks.find(shape->get_id());
+        if (it == _shape_to_callbacks.end())
+            return out;
+
+        out.reserve(it->second.size());
+        for (auto& entry : it->second)
+        {
+            if (not _callbacks.at(entry.id))
+                continue;
+
+            _n_shape_callbacks -= 1;
+            out.push_back(std::move(_callbacks.at(entry.id)));
+            _callbacks.at(entry.id) = nullptr;
+            _free_callbacks.push_back(entry.id);
+        }
+
+        _shape_to_callbacks.erase(it);
+        return out;
+    }
+
+    void PhysicsWorld::remove_events(CollisionShape* shape)
+    {
+        {
+            auto lock = std::lock_guard(_queue_lock);
+            _event_queue.erase(std::remove_if(_event_queue.begin(), _event_queue.end(), [shape](const CollisionEvent& event) {
+                return event.shape_a == shape or event.shape_b == shape;
+            }), _event_queue.end());
+        }
+
+        // not erased, the buffer may currently be dispatched if a callback destroyed the shape
+        for (auto& entry : _dispatch_buffer)
+        {
+            if (entry.event.shape_a == shape or entry.event.shape_b == shape)
+            {
+                entry.event.shape_a = nullptr;
+                entry.event.shape_b = nullptr;
+            }
+        }
+    }
+
+    void PhysicsWorld::add_trigger(CollisionShape* shape)
+    {
+        if (_shape_to_trigger.find(shape->get_id()) != _shape_to_trigger.end())
+            return;
+
+        shape->set_is_sensor(true);
+
+        auto& trigger = _triggers.emplace_back();
+        trigger.shape = shape;
+        _shape_to_trigger.insert({shape->get_id(), _triggers.size() - 1});
+
+        // shapes that already overlap never receive a begin contact
+        for (auto* edge = shape->get_native_body()->GetContactList(); edge != nullptr; edge = edge->next)
+        {
+            if (not edge->contact->IsTouching())
+                continue;
+
+            auto* other = (CollisionShape*) edge->other->GetUserData().pointer;
+            if (other == nullptr)
+                continue;
+
+            auto it = std::lower_bound(trigger.overlap_ids.begin(), trigger.overlap_ids.end(), other->get_id());
+            size_t index = it - trigger.overlap_ids.begin();
+            if (it != trigger.overlap_ids.end() and *it == other->get_id())
+            {
+                trigger.overlap_counts.at(index) += 1;
+                continue;
+            }
+
+            trigger.overlap_ids.insert(it, other->get_id());
+            trigger.overlaps.insert(trigger.overlaps.begin() + index, other);
+            trigger.overlap_counts.insert(trigger.overlap_counts.begin() + index, 1);
+        }
+    }
+
+    bool PhysicsWorld::remove_trigger(CollisionShape* shape)
+    {
+        auto it = _shape_to_trigger.find(shape->get_id());
+        if (it == _shape_to_trigger.end())
+            return false;
+
+        uint32_t index = it->second;
+        uint32_t last = _triggers.size() - 1;
+        _shape_to_trigger.erase(it);
+
+        // drop pending contacts of the trigger, then move the last trigger into its slot
+        _trigger_contacts.erase(std::remove_if(_trigger_contacts.begin(), _trigger_contacts.end(), [&](const TriggerContact& contact) {
+            return contact.trigger_index == index;
+        }), _trigger_contacts.end());
+
+        if (index != last)
+        {
+            _triggers.at(index) = std::move(_triggers.at(last));
+            _shape_to_trigger.at(_triggers.at(index).shape->get_id()) = index;
+
+            for (auto& contact : _trigger_contacts)
+                if (contact.trigger_index == last)
+                    contact.trigger_index = index;
+        }
+
+        _triggers.pop_back();
+        _changed_triggers.erase(std::remove(_changed_triggers.begin(), _changed_triggers.end(), shape), _changed_triggers.end());
+        return true;
+    }
+
+    bool PhysicsWorld::push_trigger_contact(b2Contact* contact, int32_t delta)
+    {
+        if (_shape_to_trigger.empty())
+            return false;
+
+        auto* fixture_a = contact->GetFixtureA();
+        auto* fixture_b = contact->GetFixtureB();
+        if (not fixture_a->IsSensor() and not fixture_b->IsSensor())
+            return false;
+
+        auto* shape_a = (CollisionShape*) fixture_a->GetUserData().pointer;
+        auto* shape_b = (CollisionShape*) fixture_b->GetUserData().pointer;
+        if (shape_a == nullptr or shape_b == nullptr)
+            return false; // fixture created on the native world directly, not tracked
+
+        bool is_trigger_contact = false;
+        auto push = [&](b2Fixture* fixture, CollisionShape* self, CollisionShape* other) {
+            if (not fixture->IsSensor())
+                return;
+
+            auto it = _shape_to_trigger.find(self->get_id());
+            if (it == _shape_to_trigger.end())
+                return;
+
+            _trigger_contacts.push_back({it->second, uint32_t(_trigger_contacts.size()), other->get_id(), other, delta});
+            is_trigger_contact = true;
+        };
+
+        push(fixture_a, shape_a, shape_b);
+        push(fixture_b, shape_b, shape_a);
+        return is_trigger_contact;
+    }
+
+    void PhysicsWorld::update_triggers()
+    {
+        for (auto* shape : _changed_triggers)
+        {
+            auto& trigger = _triggers.at(_shape_to_trigger.at(shape->get_id()));
+            trigger.entered.clear();
+            trigger.exited.clear();
+        }
+        _changed_triggers.clear();
+
+        if (_trigger_contacts.empty())
+            return;
+
+        std::sort(_trigger_contacts.begin(), _trigger_contacts.end(), [](const TriggerContact& a, const TriggerContact& b) -> bool {
+            return std::tie(a.trigger_index, a.other_id, a.order) < std::tie(b.trigger_index, b.other_id, b.order);
+        });
+
+        size_t i = 0;
+        while (i < _trigger_contacts.size())
+        {
+            auto trigger_index = _trigger_contacts.at(i).trigger_index;
+            auto& trigger = _triggers.at(trigger_index);
+            bool has_removed = false;
+
+            _merge_ids.clear();
+            _merge_shapes.clear();
+            _merge_counts.clear();
+
+            // one group per pair of trigger and other shape, only the net change of the step is reported
+            size_t search_start = 0;
+            while (i < _trigger_contacts.size() and _trigger_contacts.at(i).trigger_index == trigger_index)
+            {
+                auto& first = _trigger_contacts.at(i);
+                int32_t delta = 0;
+                for (; i < _trigger_contacts.size() and _trigger_contacts.at(i).trigger_index == trigger_index and _trigger_contacts.at(i).other_id == first.other_id; ++i)
+                    delta += _trigger_contacts.at(i).delta;
+
+                // contacts are sorted by id, so the search can continue where the last one ended
+                auto it = std::lower_bound(trigger.overlap_ids.begin() + search_start, trigger.overlap_ids.end(), first.other_id);
+                size_t index = it - trigger.overlap_ids.begin();
+                search_start = index;
+
+                if (it != trigger.overlap_ids.end() and *it == first.other_id)
+                {
+                    auto& count = trigger.overlap_counts.at(index);
+                    count += delta;
+                    if (count <= 0)
+                    {
+                        count = 0;
+                        trigger.exited.push_back(first.other);
+                        has_removed = true;
+                    }
+                }
+                else if (delta > 0)
+                {
+                    trigger.entered.push_back(first.other);
+                    _merge_ids.push_back(first.other_id);
+                    _merge_shapes.push_back(first.other);
+                    _merge_counts.push_back(delta);
+                }
+            }
+
+            if (has_removed)
+            {
+                size_t n = 0;
+                for (size_t j = 0; j < trigger.overlap_ids.size(); ++j)
+                {
+                    if (trigger.overlap_counts[j] == 0)
+                        continue;
+
+                    trigger.overlap_ids[n] = trigger.overlap_ids[j];
+                    trigger.overlaps[n] = trigger.overlaps[j];
+                    trigger.overlap_counts[n] = trigger.overlap_counts[j];
+                    n += 1;
+                }
+
+                trigger.overlap_ids.resize(n);
+                trigger.overlaps.resize(n);
+                trigger.overlap_counts.resize(n);
+            }
+
+            if (not _merge_ids.empty())
+            {
+                // merge into the scratch buffers, then swap, such that both sets of buffers keep their capacity
+                size_t n_new = _merge_ids.size();
+                size_t n_old = trigger.overlap_ids.size();
+                _merge_ids.resize(n_old + n_new);
+                _merge_shapes.resize(n_old + n_new);
+                _merge_counts.resize(n_old + n_new);
+
+                // merge from the back, new entries currently occupy the front of the scratch buffers
+                size_t a = n_old, b = n_new, out = n_old + n_new;
+                while (b > 0)
+                {
+                    if (a > 0 and trigger.overlap_ids[a - 1] > _merge_ids[b - 1])
+                    {
+                        a -= 1;
+                        out -= 1;
+                        _merge_ids[out] = trigger.overlap_ids[a];
+                        _merge_shapes[out] = trigger.overlaps[a];
+                        _merge_counts[out] = trigger.overlap_counts[a];
+                    }
+                    else
+                    {
+                        b -= 1;
+                        out -= 1;
+                        _merge_ids[out] = _merge_ids[b];
+                        _merge_shapes[out] = _merge_shapes[b];
+                        _merge_counts[out] = _merge_counts[b];
+                    }
+                }
+
+                for (size_t j = 0; j < a; ++j)
+                {
+                    _merge_ids[j] = trigger.overlap_ids[j];
+                    _merge_shapes[j] = trigger.overlaps[j];
+                    _merge_counts[j] = trigger.overlap_counts[j];
+                }
+
+                std::swap(trigger.overlap_ids, _merge_ids);
+                std::swap(trigger.overlaps, _merge_shapes);
+                std::swap(trigger.overlap_counts, _merge_counts);
+            }
+
+            if (not trigger.entered.empty() or not trigger.exited.empty())
+                _changed_triggers.push_back(trigger.shape);
+        }
+
+        _trigger_contacts.clear(); // keeps capacity
+    }
+
+    const PhysicsWorld::Trigger* PhysicsWorld::find_trigger(CollisionShape* shape) const
+    {
+        auto it = _shape_to_trigger.find(shape->get_id());
+        if (it == _shape_to_trigger.end())
+        {
+            Log::warning("In ts::PhysicsWorld: shape #", shape->get_id(), " is not a trigger, register it using ts::PhysicsWorld::add_trigger first");
+            return nullptr;
+        }
+
+        return &_triggers.at(it->second);
+    }
+
+    const std::vector<CollisionShape*>& PhysicsWorld::get_changed_triggers() const
+    {
+        return _changed_triggers;
+    }
+
+    const std::vector<CollisionShape*>& PhysicsWorld::get_trigger_entered(CollisionShape* shape) const
+    {
+        static const auto empty = std::vector<CollisionShape*>();
+        auto* trigger = find_trigger(shape);
+        return trigger != nullptr ? trigger->entered : empty;
+    }
+
+    const std::vector<CollisionShape*>& PhysicsWorld::get_trigger_exited(CollisionShape* shape) const
+    {
+        static const auto empty = std::vector<CollisionShape*>();
+        auto* trigger = find_trigger(shape);
+        return trigger != nullptr ? trigger->exited : empty;
+    }
+
+    const std::vector<CollisionShape*>& PhysicsWorld::get_trigger_overlaps(CollisionShape* shape) const
+    {
+        static const auto empty = std::vector<CollisionShape*>();
+        auto* trigger = find_trigger(shape);
+        return trigger != nullptr ? trigger->overlaps : empty;
+    }
+
+    CollisionPolygonBatch PhysicsWorld::create_polygons(CollisionType type, const std::vector<CollisionPolygonDescription>& descriptions)
+    {
+        auto points = std::array<b2Vec2, 8>();
+
+        // vertices relative to their centroid, in native units
+        auto to_native = [&](const CollisionPolygonDescription& description) -> Vector2f {
+            size_t n = description.n_vertices;
+
+            auto center = Vector2f(0, 0);
+            for (size_t i = 0; i < n; ++i)
+                center += description.vertices[i];
+
+            center /= Vector2f(n, n);
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                auto point = world_to_native(description.vertices[i] - center);
+                points[i].Set(point.x, point.y);
+            }
+
+            return center;
+        };
+
+        // validate everything first, such that an invalid description does not leave half the batch in the world
+        for (size_t i = 0; i < descriptions.size(); ++i)
+        {
+            auto n = descriptions[i].n_vertices;
+            if (n < 3 or n > 8)
+            {
+                std::stringstream str;
+                str << "In ts::PhysicsWorld::create_polygons: Description #" << i << " has " << size_t(n) << " vertices, it needs to have at least 3 and at most 8. "
+                    << "For larger polygons, use ts::CollisionCompound instead." << std::endl;
+
+                throw std::invalid_argument(str.str());
+            }
+
+            to_native(descriptions[i]);
+            if (detail::is_degenerate_polygon(points.data(), n))
+            {
+                std::stringstream str;
+                str << "In ts::PhysicsWorld::create_polygons: Description #" << i << " has no area, its vertices are collinear or too close to each other." << std::endl;
+
+                throw std::invalid_argument(str.str());
+            }
+        }
+
+        auto out = CollisionPolygonBatch(descriptions.size());
+
+        // b2PolygonShape::Set computes the convex hull and winding itself, so unlike the
+        // ts::CollisionPolygon constructor the vertices do not need to be sorted first
+        auto shape = b2PolygonShape();
+
+        construct_batch(out, [&](CollisionPolygon* at, size_t index) {
+            auto& description = descriptions[index];
+            auto center = to_native(description);
+            shape.Set(points.data(), description.n_vertices);
+            new (at) CollisionPolygon(this, type, center, shape);
+        });
+
+        return out;
+    }
+
+    CollisionPolygonBatch PhysicsWorld::create_polygons(CollisionType type, const std::vector<Rectangle>& rectangles)
+    {
+        auto out = CollisionPolygonBatch(rectangles.size());
+
+        // boxes need no hull computation
+        auto shape = b2PolygonShape();
+        construct_batch(out, [&](CollisionPolygon* at, size_t index) {
+            auto& rect = rectangles[index];
+            auto half_size = world_to_native(rect.size * Vector2f(0.5, 0.5));
+            shape.SetAsBox(half_size.x, half_size.y);
+            new (at) CollisionPolygon(this, type, rect.top_left + rect.size * Vector2f(0.5, 0.5), shape);
+        });
+
+        return out;
+    }
+
+    void PhysicsWorld::construct_batch(CollisionPolygonBatch& batch, const std::function<void(CollisionPolygon*, size_t)>& construct)
+    {
+        try
+        {
+            for (size_t i = 0; i < batch._capacity; ++i)
+            {
+                construct(batch._data + i, i);
+                batch._size += 1;
+            }
+        }
+        catch (...)
+        {
+            // shapes that were already created are removed from the world again, the batch deallocates them
+            batch.destroy();
+            throw;
+        }
+    }
+
+    CollisionDispatchStatistics PhysicsWorld::get_dispatch_statistics()
+    {
+        auto lock = std::lock_guard(_queue_lock);
+        auto out = _dispatch_statistics;
+        out.queue_depth = _event_queue.size();
+        return out;
+    }
+
+    void PhysicsWorld::invoke_callback(CallbackEntry entry, const CollisionEvent& event, size_t event_index)
+    {
+        // a shape in multiple groups may map to the same group callback more than once
+        if (_callback_last_event.at(entry.id) == event_index)
+            return;
+
+        _callback_last_event.at(entry.id) = event_index;
+
+        auto& callback = _callbacks.at(entry.id);
+        if (not callback)
+            return;
+
+        if (entry.swap_shapes)
+            callback(CollisionEvent{event.type, event.shape_b, event.shape_a});
+        else
+            callback(event);
+
+        _dispatch_statistics.n_callbacks_invoked += 1;
+    }
+
+    void PhysicsWorld::dispatch_events()
+    {
+        auto clock = Clock();
+        _dispatch_statistics.n_events_dispatched = _dispatch_buffer.size();
+        _dispatch_statistics.n_callbacks_invoked = 0;
+
+        // indexed, callbacks that destroy shapes append the events this causes
+        for (size_t i = 0; i < _dispatch_buffer.size(); ++i)
+        {
+            auto entry = _dispatch_buffer[i];
+            if (entry.event.shape_a == nullptr)
+                continue; // one of the shapes was destroyed since
+
+            auto event_index = _n_events_seen++;
+
+            if (_n_shape_callbacks > 0)
+            {
+                auto it = _shape_to_callbacks.find(entry.id_a);
+                if (it != _shape_to_callbacks.end())
+                    for (auto& callback : it->second)
+                        invoke_callback(callback, entry.event, event_index);
+
+                it = _shape_to_callbacks.find(entry.id_b);
+                if (it != _shape_to_callbacks.end())
+                    for (auto& callback : it->second)
+                        invoke_callback({callback.id, true}, entry.event, event_index);
+            }
+
+            if (_n_group_callbacks > 0)
+            {
+                for (uint16_t bits_a = entry.groups_a; bits_a != 0; bits_a &= bits_a - 1)
+                {
+                    size_t bit_a = __builtin_ctz(bits_a);
+                    for (uint16_t bits_b = entry.groups_b; bits_b != 0; bits_b &= bits_b - 1)
+                    {
+                        size_t bit_b = __builtin_ctz(bits_b);
+                        for (auto& callback : _group_pair_to_callbacks[bit_a * _n_groups + bit_b])
+                            invoke_callback(callback, entry.event, event_index);
+                    }
+                }
+            }
+        }
+
+        _dispatch_buffer.clear(); // keeps capacity, no allocation during the next step
+        _dispatch_statistics.dispatch_duration = clock.elapsed();
+    }
+
     PhysicsWorld::ContactListener::ContactListener(PhysicsWorld * world)
         : _world(world)
     {}
 
+    void PhysicsWorld::ContactListener::push_event(CollisionEvent::CollisionEventType type, b2Contact* contact)
+    {
+        auto clock = Clock();
+
+        auto* fixture_a = contact->GetFixtureA();
+        auto* fixture_b = contact->GetFixtureB();
+
+        auto event = CollisionEvent{
+            type,
+            (CollisionShape*) fixture_a->GetUserData().pointer,
+            (CollisionShape*) fixture_b->GetUserData().pointer
+        };
+
+        // fixtures created on the native world directly have no shape, their contacts are not reported
+        if (event.shape_a == nullptr or event.shape_b == nullptr)
+            return;
+
+        auto lock = std::lock_guard(_world->_queue_lock);
+        _world->_event_queue.push_back(event);
+
+        auto& statistics = _world->_dispatch_statistics;
+        statistics.max_queue_depth = std::max(statistics.max_queue_depth, _world->_event_queue.size());
+
+        // only buffer for dispatch if anybody is listening, the ids and groups are
+        // read here because the fixtures may be disabled by the time the event is dispatched
+        if (_world->_n_shape_callbacks + _world->_n_group_callbacks > 0)
+            _world->_dispatch_buffer.push_back({
+                event,
+                event.shape_a->get_id(),
+                event.shape_b->get_id(),
+                fixture_a->GetFilterData().categoryBits,
+                fixture_b->GetFilterData().categoryBits
+            });
+
+        _world->_contact_listener_ns += clock.elapsed().as_nanoseconds();
+    }
+
     // shapes start to overlap
     void PhysicsWorld::ContactListener::BeginContact(b2Contact *contact)
     {
-        auto lock = std::lock_guard(_world->_queue_lock);
-        _world->_event_queue.push_back({
-             CollisionEvent::CONTACT_START,
-             (CollisionShape *) contact->GetFixtureA()->GetUserData().pointer,
-             (CollisionShape *) contact->GetFixtureB()->GetUserData().pointer
-        });
+        if (not _world->push_trigger_contact(contact, +1))
+            push_event(CollisionEvent::CONTACT_START, contact);
     }
 
     void PhysicsWorld::ContactListener::EndContact(b2Contact *contact)
     {
-        auto lock = std::lock_guard(_world->_queue_lock);
-        _world->_event_queue.push_back({
-             CollisionEvent::CONTACT_END,
-             (CollisionShape *) contact->GetFixtureA()->GetUserData().pointer,
-             (CollisionShape *) contact->GetFixtureB()->GetUserData().pointer
-        });
+        if (not _world->push_trigger_contact(contact, -1))
+            push_event(CollisionEvent::CONTACT_END, contact);
     }
 
     void PhysicsWorld::ContactListener::PreSolve(b2Contact*, const b2Manifold*)
@@ -0,0 +1,272 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+#include <glm/glm.hpp>
+#include <SDL2/SDL_render.h>
+
+#include <include/polyline_shape.hpp>
+#include <include/render_target.hpp>
+
+namespace ts
+{
+    namespace detail
+    {
+        static inline constexpr float polyline_epsilon = 1e-5;
+
+        // left-hand normal of the segment a-b, or (0, 0) if a == b
+        static Vector2f polyline_normal(Vector2f a, Vector2f b)
+        {
+            auto delta = b - a;
+            auto length = std::sqrt(delta.x * delta.x + delta.y * delta.y);
+            if (length < polyline_epsilon)
+                return Vector2f(0, 0);
+
+            return Vector2f(-delta.y / length, delta.x / length);
+        }
+    }
+
+    PolylineShape::PolylineShape(const std::vector<Vector2f>& vertices, float thickness, PolylineJoin join)
+        : _vertices(vertices), _thickness(thickness), _join(join)
+    {
+        update_mesh();
+    }
+
+    void PolylineShape::set_vertices(const std::vector<Vector2f>& vertices)
+    {
+        _vertices = vertices;
+        update_mesh();
+    }
+
+    const std::vector<Vector2f>& PolylineShape::get_vertices() const
+    {
+        return _vertices;
+    }
+
+    void PolylineShape::set_thickness(float thickness)
+    {
+        _thickness = thickness;
+        update_mesh();
+    }
+
+    float PolylineShape::get_thickness() const
+    {
+        return _thickness;
+    }
+
+    void PolylineShape::set_join(PolylineJoin join)
+    {
+        _join = join;
+        update_mesh();
+    }
+
+    PolylineJoin PolylineShape::get_join() const
+    {
+        return _join;
+    }
+
+    void PolylineShape::set_color(RGBA color)
+    {
+        _color = color;
+        _colors.assign(_colors.size(), _color.operator SDL_Color());
+    }
+
+    RGBA PolylineShape::get_color() const
+    {
+        return _color;
+    }
+
+    void PolylineShape::set_model_transform(Vector2f translation, Angle rotation, Vector2f origin)
+    {
+        _translation = translation;
+        _rotation = rotation;
+        _origin = origin;
+    }
+
+    size_t PolylineShape::get_n_segments() const
+    {
+        return _vertices.size() < 2 ? 0 : _vertices.size() - 1;
+    }
+
+    size_t PolylineShape::get_n_triangles() const
+    {
+        return _indices.size() / 3;
+    }
+
+    Rectangle PolylineShape::get_bounding_box() const
+    {
+        return _bounds;
+    }
+
+    void PolylineShape::update_mesh()
+    {
+        _local_xy.clear();
+        _indices.clear();
+
+        // drop consecutive duplicates, they have no direction
+        auto points = std::vector<Vector2f>();
+        points.reserve(_vertices.size());
+        for (auto& v : _vertices)
+            if (points.empty() or glm::distance(v, points.back()) > detail::polyline_epsilon)
+                points.push_back(v);
+
+        bool is_closed = points.size() > 3 and glm::distance(points.front(), points.back()) <= detail::polyline_epsilon;
+        if (is_closed)
+            points.pop_back();
+
+        size_t n = points.size();
+        if (n < 2)
+        {
+            _colors.clear();
+            _bounds = Rectangle{Vector2f(0, 0), Vector2f(0, 0)};
+            return;
+        }
+
+        const float half = _thickness / 2.f;
+        const float max_miter = miter_limit * half;
+        size_t n_segments = is_closed ? n : n - 1;
+
+        auto normals = std::vector<Vector2f>();
+        normals.reserve(n_segments);
+        for (size_t i = 0; i < n_segments; ++i)
+            normals.push_back(detail::polyline_normal(points.at(i), points.at((i + 1) % n)));
+
+        // each joint emits one or more pairs of (left, right) vertices, consecutive pairs form a quad
+        _local_xy.reserve(4 * 2 * (n + 1));
+        auto push_pair = [&](Vector2f left, Vector2f right) {
+            _local_xy.push_back(left.x);
+            _local_xy.push_back(left.y);
+            _local_xy.push_back(right.x);
+            _local_xy.push_back(right.y);
+        };
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            auto point = points.at(i);
+
+            if (not is_closed and (i == 0 or i == n - 1))
+            {
+                auto normal = normals.at(i == 0 ? 0 : n_segments - 1) * half;
+                push_pair(point + normal, point - normal);
+                continue;
+            }
+
+            auto in = normals.at((i + n_segments - 1) % n_segments);
+            auto out = normals.at(i % n_segments);
+            auto sum = in + out;
+            auto sum_length = std::sqrt(sum.x * sum.x + sum.y * sum.y);
+
+            // segments fold back onto each other, there is no miter
+            if (sum_length < detail::polyline_epsilon)
+            {
+                push_pair(point + in * half, point - in * half);
+                push_pair(point + out * half, point - out * half);
+                continue;
+            }
+
+            auto miter = sum / sum_length;
+            auto miter_length = half / std::max(glm::dot(miter, out), detail::polyline_epsilon);
+
+            if (_join == PolylineJoin::MITER and miter_length <= max_miter)
+            {
+                push_pair(point + miter * miter_length, point - miter * miter_length);
+                continue;
+            }
+
+            // bevel: inner side shares the miter point, outer side gets one vertex per segment
+            auto inner = miter * std::min(miter_length, max_miter);
+            float turn = in.x * out.y - in.y * out.x;
+            if (turn > 0)
+            {
+                push_pair(point + inner, point - in * half);
+                push_pair(point + inner, point - out * half);
+            }
+            else
+            {
+                push_pair(point + in * half, point - inner);
+                push_pair(point + out * half, point - inner);
+            }
+        }
+
+        size_t n_pairs = _local_xy.size() / 4;
+        size_t n_quads = is_closed ? n_pairs : n_pairs - 1;
+        _indices.reserve(6 * n_quads);
+        for (size_t i = 0; i < n_quads; ++i)
+        {
+            int left = 2 * i;
+            int right = left + 1;
+            int next_left = 2 * ((i + 1) % n_pairs);
+            int next_right = next_left + 1;
+
+            _indices.insert(_indices.end(), {left, right, next_left, right, next_right, next_left});
+        }
+
+        _colors.assign(_local_xy.size() / 2, _color.operator SDL_Color());
+
+        auto min = Vector2f(std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+        auto max = Vector2f(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
+        for (size_t i = 0; i < _local_xy.size(); i += 2)
+        {
+            min.x = std::min(min.x, _local_xy.at(i));
+            min.y = std::min(min.y, _local_xy.at(i+1));
+            max.x = std::max(max.x, _local_xy.at(i));
+            max.y = std::max(max.y, _local_xy.at(i+1));
+        }
+        _bounds = Rectangle{min, max - min};
+    }
+
+    void PolylineShape::render(RenderTarget* target, Transform transform) const
+    {
+        if (_indices.empty())
+            return;
+
+        // model transform, applied before the render transform
+        auto model = Transform();
+        model.rotate(_rotation, _origin);
+
+        auto translation = Transform();
+        translation.translate(_translation.x, _translation.y);
+        model.combine(translation);
+        model.combine(transform);
+
+        _xy.resize(_local_xy.size());
+        auto min = Vector2f(std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+        auto max = Vector2f(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
+        for (size_t i = 0; i < _local_xy.size(); i += 2)
+        {
+            auto new_pos = model.apply_to(Vector2f{_local_xy[i], _local_xy[i+1]});
+            _xy[i] = new_pos.x;
+            _xy[i+1] = new_pos.y;
+
+            min.x = std::min(min.x, new_pos.x);
+            min.y = std::min(min.y, new_pos.y);
+            max.x = std::max(max.x, new_pos.x);
+            max.y = std::max(max.y, new_pos.y);
+        }
+
+        // skip lines that are entirely outside the viewport
+        SDL_Rect viewport;
+        SDL_RenderGetViewport(target->get_renderer(), &viewport);
+        if (viewport.w > 0 and viewport.h > 0 and (
+            max.x < 0 or max.y < 0 or
+            min.x > viewport.w or min.y > viewport.h))
+            return;
+
+        SDL_SetRenderDrawBlendMode(target->get_renderer(), SDL_BLENDMODE_BLEND);
+        SDL_RenderGeometryRaw(
+                target->get_renderer(),
+                nullptr,
+                _xy.data(), 2 * sizeof(float),
+                _colors.data(), sizeof(SDL_Color),
+                nullptr, 0,
+                _xy.size() / 2,
+                _indices.data(), _indices.size(), sizeof(int)
+        );
+        SDL_SetRenderDrawBlendMode(target->get_renderer(), SDL_BLENDMODE_NONE);
+    }
+}
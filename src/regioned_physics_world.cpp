@@ -0,0 +1,226 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include <include/regioned_physics_world.hpp>
+#include <include/collision_shape.hpp>
+#include <include/logging.hpp>
+
+namespace ts
+{
+    RegionedPhysicsWorld::RegionedPhysicsWorld(float region_size, size_t activation_radius)
+        : _region_size(region_size), _activation_radius(activation_radius), _handoff_margin(region_size * 0.05f)
+    {
+        if (region_size <= 0)
+            throw std::invalid_argument("In ts::RegionedPhysicsWorld Constructor: region size has to be larger than 0");
+    }
+
+    RegionedPhysicsWorld::~RegionedPhysicsWorld()
+    {}
+
+    void RegionedPhysicsWorld::step(Time timestep, int32_t velocity_iterations, int32_t position_iterations)
+    {
+        update_activation();
+
+        for (auto* world : _active_regions)
+            world->step(timestep, velocity_iterations, position_iterations);
+
+        hand_off();
+    }
+
+    void RegionedPhysicsWorld::update_activation()
+    {
+        _active_regions.clear();
+
+        for (auto& [coordinate, region] : _regions)
+        {
+            bool should_be_active = false;
+            for (auto& [id, position] : _anchors)
+            {
+                auto anchor = get_region_coordinate(position);
+                if (std::abs(coordinate.x - anchor.x) <= _activation_radius and std::abs(coordinate.y - anchor.y) <= _activation_radius)
+                {
+                    should_be_active = true;
+                    break;
+                }
+            }
+
+            region.is_active = should_be_active;
+            if (region.is_active)
+                _active_regions.push_back(region.world.get());
+        }
+    }
+
+    void RegionedPhysicsWorld::hand_off()
+    {
+        _handoffs.clear();
+
+        for (auto& [coordinate, region] : _regions)
+        {
+            if (not region.is_active)
+                continue;
+
+            auto bounds = get_region_bounds(coordinate);
+            float min_x = bounds.top_left.x - _handoff_margin;
+            float min_y = bounds.top_left.y - _handoff_margin;
+            float max_x = bounds.top_left.x + bounds.size.x + _handoff_margin;
+            float max_y = bounds.top_left.y + bounds.size.y + _handoff_margin;
+
+            for (auto* body = region.world->get_native()->GetBodyList(); body != nullptr; body = body->GetNext())
+            {
+                if (body->GetType() == b2_staticBody)
+                    continue;
+
+                auto* shape = (CollisionShape*) body->GetUserData().pointer;
+                if (shape == nullptr)
+                    continue;
+
+                auto& native_center = body->GetWorldCenter();
+                auto center = native_to_world(Vector2f(native_center.x, native_center.y));
+                if (center.x >= min_x and center.x < max_x and center.y >= min_y and center.y < max_y)
+                    continue;
+
+                _handoffs.push_back({shape->get_id(), shape, get_region_coordinate(center)});
+            }
+        }
+
+        // bodies are recreated in order of their id, such that the result does not depend on the order of regions or bodies
+        std::sort(_handoffs.begin(), _handoffs.end(), [](const Handoff& a, const Handoff& b) -> bool {
+            return a.shape_id < b.shape_id;
+        });
+
+        for (auto& handoff : _handoffs)
+            handoff.shape->move_to(get_region(handoff.to));
+
+        _n_handoffs = _handoffs.size();
+    }
+
+    RegionCoordinate RegionedPhysicsWorld::get_region_coordinate(Vector2f position) const
+    {
+        return RegionCoordinate{
+            int32_t(std::floor(position.x / _region_size)),
+            int32_t(std::floor(position.y / _region_size))
+        };
+    }
+
+    Rectangle RegionedPhysicsWorld::get_region_bounds(RegionCoordinate region) const
+    {
+        return Rectangle{
+            Vector2f(region.x * _region_size, region.y * _region_size),
+            Vector2f(_region_size, _region_size)
+        };
+    }
+
+    PhysicsWorld* RegionedPhysicsWorld::get_region(RegionCoordinate coordinate)
+    {
+        auto it = _regions.find(coordinate);
+        if (it != _regions.end())
+            return it->second.world.get();
+
+        auto& region = _regions[coordinate];
+        region.world = std::make_unique<PhysicsWorld>();
+        region.world->set_gravity(_gravity);
+        return region.world.get();
+    }
+
+    PhysicsWorld* RegionedPhysicsWorld::get_region_at(Vector2f position)
+    {
+        return get_region(get_region_coordinate(position));
+    }
+
+    const std::vector<PhysicsWorld*>& RegionedPhysicsWorld::get_active_regions() const
+    {
+        return _active_regions;
+    }
+
+    bool RegionedPhysicsWorld::get_is_active(RegionCoordinate coordinate) const
+    {
+        auto it = _regions.find(coordinate);
+        return it != _regions.end() and it->second.is_active;
+    }
+
+    RegionAnchorID RegionedPhysicsWorld::add_anchor(Vector2f position)
+    {
+        auto id = _current_anchor_id++;
+        _anchors.insert({id, position});
+        return id;
+    }
+
+    void RegionedPhysicsWorld::set_anchor_position(RegionAnchorID id, Vector2f position)
+    {
+        auto it = _anchors.find(id);
+        if (it == _anchors.end())
+        {
+            Log::warning("In ts::RegionedPhysicsWorld::set_anchor_position: no anchor with id ", id);
+            return;
+        }
+
+        it->second = position;
+    }
+
+    void RegionedPhysicsWorld::remove_anchor(RegionAnchorID id)
+    {
+        _anchors.erase(id);
+    }
+
+    void RegionedPhysicsWorld::set_gravity(Vector2f gravity)
+    {
+        _gravity = gravity;
+        for (auto& [coordinate, region] : _regions)
+            region.world->set_gravity(gravity);
+    }
+
+    Vector2f RegionedPhysicsWorld::get_gravity() const
+    {
+        return _gravity;
+    }
+
+    void RegionedPhysicsWorld::set_handoff_margin(float margin)
+    {
+        _handoff_margin = std::max(margin, 0.f);
+    }
+
+    size_t RegionedPhysicsWorld::get_n_regions() const
+    {
+        return _regions.size();
+    }
+
+    size_t RegionedPhysicsWorld::get_n_active_bodies() const
+    {
+        size_t out = 0;
+        for (auto& [coordinate, region] : _regions)
+            if (region.is_active)
+                out += region.world->get_native()->GetBodyCount();
+
+        return out;
+    }
+
+    size_t RegionedPhysicsWorld::get_n_frozen_bodies() const
+    {
+        size_t out = 0;
+        for (auto& [coordinate, region] : _regions)
+            if (not region.is_active)
+                out += region.world->get_native()->GetBodyCount();
+
+        return out;
+    }
+
+    size_t RegionedPhysicsWorld::get_n_handoffs() const
+    {
+        return _n_handoffs;
+    }
+
+    Vector2f RegionedPhysicsWorld::world_to_native(Vector2f in) const
+    {
+        return Vector2f(in.x / PhysicsWorld::pixel_ratio, in.y / PhysicsWorld::pixel_ratio);
+    }
+
+    Vector2f RegionedPhysicsWorld::native_to_world(Vector2f in) const
+    {
+        return Vector2f(in.x * PhysicsWorld::pixel_ratio, in.y * PhysicsWorld::pixel_ratio);
+    }
+}
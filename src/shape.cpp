@@ -4,6 +4,8 @@
 //
 
 #include <stdexcept>
+#include <limits>
+#include <algorithm>
 
 #include <glm/glm.hpp>
 #include <SDL2/SDL_render.h>
@@ -19,19 +21,34 @@ namespace ts
         if (_xy.size() == 0)
             return;
 
-        if (_texture == nullptr)
-            SDL_SetRenderDrawBlendMode(target->get_renderer(), SDL_BLENDMODE_BLEND);
-        else
-            SDL_SetRenderDrawBlendMode(target->get_renderer(), (SDL_BlendMode) _texture->get_blend_mode());
-
         auto xy = _xy;
+        auto min = Vector2f(std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+        auto max = Vector2f(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
         for (size_t i = 0; i < xy.size(); i += 2)
         {
             auto new_pos = transform.apply_to(Vector2f{xy.at(i), xy.at(i+1)});
             xy.at(i) = new_pos.x;
             xy.at(i+1) = new_pos.y;
+
+            min.x = std::min(min.x, new_pos.x);
+            min.y = std::min(min.y, new_pos.y);
+            max.x = std::max(max.x, new_pos.x);
+            max.y = std::max(max.y, new_pos.y);
         }
 
+        // skip shapes that are entirely outside the viewport
+        SDL_Rect viewport;
+        SDL_RenderGetViewport(target->get_renderer(), &viewport);
+        if (viewport.w > 0 and viewport.h > 0 and (
+            max.x < 0 or max.y < 0 or
+            min.x > viewport.w or min.y > viewport.h))
+            return;
+
+        if (_texture == nullptr)
+            SDL_SetRenderDrawBlendMode(target->get_renderer(), SDL_BLENDMODE_BLEND);
+        else
+            SDL_SetRenderDrawBlendMode(target->get_renderer(), (SDL_BlendMode) _texture->get_blend_mode());
+
         SDL_RenderGeometryRaw(
                 target->get_renderer(),
                 _texture != nullptr ? _texture->get_native() : nullptr,
@@ -4,6 +4,7 @@
 //
 
 #include <include/sound.hpp>
+#include <include/sound_cache.hpp>
 #include <include/logging.hpp>
 
 namespace ts
@@ -24,8 +25,9 @@ namespace ts
 
     bool Sound::load(const std::string& path)
     {
-        _chunk = Mix_LoadWAV(path.c_str());
+        _chunk = SoundCache::load(path);
         _id = std::hash<std::string>()(path);
+        _path = path;
 
         if (_chunk == nullptr)
         {
@@ -33,21 +35,50 @@ namespace ts
             return false;
         }
         else
+        {
+            auto guard = std::lock_guard(_loaded_lock);
+            _loaded.insert(this);
             return true;
+        }
     }
 
     void Sound::unload()
     {
-        Mix_FreeChunk(_chunk);
+        {
+            auto guard = std::lock_guard(_loaded_lock);
+            _loaded.erase(this);
+        }
+
+        SoundCache::free(_chunk);
         _chunk = nullptr;
         _id = -1;
     }
 
+    void Sound::reload_all()
+    {
+        auto guard = std::lock_guard(_loaded_lock);
+        for (auto* sound : _loaded)
+        {
+            SoundCache::free(sound->_chunk);
+            sound->_chunk = SoundCache::load(sound->_path);
+
+            if (sound->_chunk == nullptr)
+                Log::warning("In ts::Sound::reload_all: unable to reload \"", sound->_path, "\"");
+            else
+                Mix_VolumeChunk(sound->_chunk, int32_t(sound->_volume * 128));
+        }
+    }
+
     size_t Sound::get_id() const
     {
         return _id;
     }
 
+    size_t Sound::get_n_bytes() const
+    {
+        return _chunk == nullptr ? 0 : _chunk->alen;
+    }
+
     Mix_Chunk * Sound::get_native()
     {
         return _chunk;
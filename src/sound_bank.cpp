@@ -0,0 +1,312 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#include <algorithm>
+
+#include <include/sound_bank.hpp>
+#include <include/logging.hpp>
+
+namespace ts
+{
+    SoundBank::SoundBank(size_t memory_budget)
+        : _memory_budget(memory_budget)
+    {
+        auto guard = std::lock_guard(_banks_lock);
+        _banks.insert(this);
+    }
+
+    SoundBank::~SoundBank()
+    {
+        {
+            auto guard = std::lock_guard(_banks_lock);
+            _banks.erase(this);
+        }
+
+        {
+            auto lock = std::unique_lock(_mutex);
+            _shutdown = true;
+
+            for (auto& path : _preload_queue)
+                _entries.erase(path);
+
+            _preload_queue.clear();
+        }
+
+        if (_worker.joinable())
+            _worker.join();
+
+        _sound_to_path.clear();
+        _entries.clear();
+    }
+
+    void SoundBank::load(const std::string& path, std::unique_lock<std::mutex>& lock)
+    {
+        lock.unlock();
+        auto sound = std::make_unique<Sound>();
+        bool success = sound->load(path);
+        lock.lock();
+
+        // entries that are loading are never evicted, so the entry still exists
+        auto it = _entries.find(path);
+        if (not success)
+            _entries.erase(it);
+        else
+        {
+            auto& entry = it->second;
+            entry.sound = std::move(sound);
+            entry.is_loading = false;
+            entry.last_used = ++_current_tick;
+
+            _sound_to_path.insert({entry.sound.get(), path});
+            entry.n_bytes = entry.sound->get_n_bytes();
+            _memory_usage += entry.n_bytes;
+        }
+
+        _loaded.notify_all();
+        enforce_budget();
+    }
+
+    Sound* SoundBank::acquire(const std::string& path)
+    {
+        auto lock = std::unique_lock(_mutex);
+
+        bool was_decoded = false;
+
+        // the reference is taken before decoding or waiting, such that enforcing the budget once the sound is loaded can not evict it
+        auto it = _entries.find(path);
+        if (it == _entries.end())
+        {
+            _entries.emplace(path, Entry()).first->second.n_references = 1;
+            load(path, lock);
+            was_decoded = true;
+        }
+        else if (it->second.is_loading)
+        {
+            it->second.n_references += 1;
+
+            // still queued, decode here instead of waiting for the worker to reach it
+            auto queued = std::find(_preload_queue.begin(), _preload_queue.end(), path);
+            if (queued != _preload_queue.end())
+            {
+                _preload_queue.erase(queued);
+                load(path, lock);
+                was_decoded = true;
+            }
+            else
+            {
+                _loaded.wait(lock, [&]() {
+                    auto current = _entries.find(path);
+                    return current == _entries.end() or not current->second.is_loading;
+                });
+            }
+        }
+        else
+            it->second.n_references += 1;
+
+        // iterators may have been invalidated while the lock was released. If loading failed, the entry was removed along with the reference
+        it = _entries.find(path);
+        if (it == _entries.end())
+            return nullptr;
+
+        if (not was_decoded)
+            _n_hits += 1;
+
+        auto& entry = it->second;
+        entry.last_used = ++_current_tick;
+        return entry.sound.get();
+    }
+
+    void SoundBank::release(Sound* sound)
+    {
+        auto lock = std::unique_lock(_mutex);
+
+        auto path = _sound_to_path.find(sound);
+        if (path == _sound_to_path.end())
+        {
+            Log::warning("In ts::SoundBank::release: sound is not part of this bank");
+            return;
+        }
+
+        auto& entry = _entries.at(path->second);
+        if (entry.n_references == 0)
+        {
+            Log::warning("In ts::SoundBank::release: sound \"", path->second, "\" was released more often than it was acquired");
+            return;
+        }
+
+        entry.n_references -= 1;
+        entry.last_used = ++_current_tick;
+        enforce_budget();
+    }
+
+    void SoundBank::preload(const std::vector<std::string>& paths)
+    {
+        auto lock = std::unique_lock(_mutex);
+
+        for (auto& path : paths)
+        {
+            if (_entries.find(path) != _entries.end())
+                continue;
+
+            _entries.emplace(path, Entry());
+            _preload_queue.push_back(path);
+        }
+
+        if (_worker_running or _preload_queue.empty())
+            return;
+
+        // the previous worker ran out of paths, it is done or about to return
+        if (_worker.joinable())
+            _worker.join();
+
+        _worker_running = true;
+        _worker = std::thread(&SoundBank::worker_loop, this);
+    }
+
+    void SoundBank::worker_loop()
+    {
+        auto lock = std::unique_lock(_mutex);
+
+        while (not _shutdown and not _preload_queue.empty())
+        {
+            auto path = std::move(_preload_queue.front());
+            _preload_queue.pop_front();
+            load(path, lock);
+        }
+
+        _worker_running = false;
+        _loaded.notify_all();
+    }
+
+    void SoundBank::wait_for_preload()
+    {
+        auto lock = std::unique_lock(_mutex);
+        _loaded.wait(lock, [&]() {
+            return not _worker_running;
+        });
+    }
+
+    bool SoundBank::get_is_preloading() const
+    {
+        auto lock = std::unique_lock(_mutex);
+        return _worker_running;
+    }
+
+    bool SoundBank::get_is_loaded(const std::string& path) const
+    {
+        auto lock = std::unique_lock(_mutex);
+
+        auto it = _entries.find(path);
+        return it != _entries.end() and not it->second.is_loading;
+    }
+
+    void SoundBank::enforce_budget()
+    {
+        if (_memory_budget == 0)
+            return;
+
+        while (_memory_usage > _memory_budget)
+        {
+            auto lru = _entries.end();
+            for (auto it = _entries.begin(); it != _entries.end(); ++it)
+            {
+                auto& entry = it->second;
+                if (entry.is_loading or entry.n_references > 0)
+                    continue;
+
+                if (lru == _entries.end() or entry.last_used < lru->second.last_used)
+                    lru = it;
+            }
+
+            if (lru == _entries.end())
+                return; // all sounds are in use
+
+            evict(lru);
+        }
+    }
+
+    void SoundBank::evict(std::unordered_map<std::string, Entry>::iterator it)
+    {
+        auto& entry = it->second;
+        _memory_usage -= entry.n_bytes;
+        _sound_to_path.erase(entry.sound.get());
+        _entries.erase(it);
+    }
+
+    void SoundBank::update_memory_usage()
+    {
+        auto lock = std::unique_lock(_mutex);
+
+        _memory_usage = 0;
+        for (auto& pair : _entries)
+        {
+            auto& entry = pair.second;
+            if (entry.sound == nullptr)
+                continue;
+
+            entry.n_bytes = entry.sound->get_n_bytes();
+            _memory_usage += entry.n_bytes;
+        }
+
+        enforce_budget();
+    }
+
+    void SoundBank::update_all_memory_usage()
+    {
+        auto guard = std::lock_guard(_banks_lock);
+        for (auto* bank : _banks)
+            bank->update_memory_usage();
+    }
+
+    void SoundBank::evict_unused()
+    {
+        auto lock = std::unique_lock(_mutex);
+
+        for (auto it = _entries.begin(); it != _entries.end();)
+        {
+            auto& entry = it->second;
+            if (entry.is_loading or entry.n_references > 0)
+            {
+                ++it;
+                continue;
+            }
+
+            auto next = std::next(it);
+            evict(it);
+            it = next;
+        }
+    }
+
+    void SoundBank::set_memory_budget(size_t n_bytes)
+    {
+        auto lock = std::unique_lock(_mutex);
+        _memory_budget = n_bytes;
+        enforce_budget();
+    }
+
+    size_t SoundBank::get_memory_budget() const
+    {
+        auto lock = std::unique_lock(_mutex);
+        return _memory_budget;
+    }
+
+    size_t SoundBank::get_memory_usage() const
+    {
+        auto lock = std::unique_lock(_mutex);
+        return _memory_usage;
+    }
+
+    size_t SoundBank::get_n_sounds() const
+    {
+        auto lock = std::unique_lock(_mutex);
+        return _sound_to_path.size();
+    }
+
+    size_t SoundBank::get_n_hits() const
+    {
+        auto lock = std::unique_lock(_mutex);
+        return _n_hits;
+    }
+}
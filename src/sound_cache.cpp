@@ -0,0 +1,267 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <SDL2/SDL_mixer.h>
+
+#include <include/sound_cache.hpp>
+#include <include/audio_command_queue.hpp>
+#include <include/logging.hpp>
+
+namespace ts
+{
+    namespace detail
+    {
+        // maps an entire file read-only, returns nullptr if it does not exist or is empty
+        void* map_file(const std::string& path, size_t& n_bytes, bool writable)
+        {
+            int file = ::open(path.c_str(), O_RDONLY);
+            if (file < 0)
+                return nullptr;
+
+            struct stat info;
+            if (fstat(file, &info) != 0 or info.st_size <= 0)
+            {
+                ::close(file);
+                return nullptr;
+            }
+
+            // private, such that a write would only touch a copy of the page, never the cached file
+            int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+            void* data = mmap(nullptr, info.st_size, protection, MAP_PRIVATE, file, 0);
+            ::close(file);
+
+            if (data == MAP_FAILED)
+                return nullptr;
+
+            n_bytes = info.st_size;
+            return data;
+        }
+
+        // FNV-1a over the encoded file, such that an edited file is decoded again even if its path did not change
+        uint64_t hash_file(const std::string& path, bool& success)
+        {
+            size_t n_bytes = 0;
+            auto* data = static_cast<const uint8_t*>(map_file(path, n_bytes, false));
+            success = data != nullptr;
+            if (not success)
+                return 0;
+
+            uint64_t hash = 14695981039346656037ull;
+            for (size_t i = 0; i < n_bytes; ++i)
+            {
+                hash ^= data[i];
+                hash *= 1099511628211ull;
+            }
+
+            munmap(const_cast<uint8_t*>(data), n_bytes);
+            return hash ^ n_bytes;
+        }
+    }
+
+    bool SoundCache::enable(const std::string& directory)
+    {
+        auto error = std::error_code();
+        std::filesystem::create_directories(directory, error);
+
+        if (error or not std::filesystem::is_directory(directory))
+        {
+            Log::warning("In ts::SoundCache::enable: unable to create cache directory \"", directory, "\"");
+            return false;
+        }
+
+        auto guard = std::lock_guard(_lock);
+        _directory = directory;
+        return true;
+    }
+
+    void SoundCache::disable()
+    {
+        auto guard = std::lock_guard(_lock);
+        _directory.clear();
+    }
+
+    bool SoundCache::is_enabled()
+    {
+        auto guard = std::lock_guard(_lock);
+        return not _directory.empty();
+    }
+
+    std::string SoundCache::get_directory()
+    {
+        auto guard = std::lock_guard(_lock);
+        return _directory;
+    }
+
+    void SoundCache::clear()
+    {
+        auto directory = get_directory();
+        if (directory.empty())
+            return;
+
+        // mapped files stay readable until they are unmapped, even after being removed
+        auto error = std::error_code();
+        for (auto& entry : std::filesystem::directory_iterator(directory, error))
+            if (entry.path().extension() == ".pcm")
+                std::filesystem::remove(entry.path(), error);
+    }
+
+    size_t SoundCache::get_n_hits()
+    {
+        return _n_hits;
+    }
+
+    size_t SoundCache::get_n_misses()
+    {
+        return _n_misses;
+    }
+
+    Time SoundCache::get_average_hit_load_time()
+    {
+        auto n = _n_hits.load();
+        return nanoseconds(n > 0 ? _hit_ns / n : 0);
+    }
+
+    Time SoundCache::get_average_miss_load_time()
+    {
+        auto n = _n_misses.load();
+        return nanoseconds(n > 0 ? _miss_ns / n : 0);
+    }
+
+    Time SoundCache::get_total_load_time()
+    {
+        return nanoseconds(_hit_ns + _miss_ns);
+    }
+
+    void SoundCache::reset_statistics()
+    {
+        _n_hits = 0;
+        _n_misses = 0;
+        _hit_ns = 0;
+        _miss_ns = 0;
+    }
+
+    Mix_Chunk* SoundCache::load(const std::string& path)
+    {
+        auto clock = Clock();
+        auto directory = get_directory();
+
+        auto cache_path = std::string();
+        if (not directory.empty())
+        {
+            cache_path = get_cache_path(path, directory);
+
+            auto* chunk = cache_path.empty() ? nullptr : load_cached(cache_path);
+            if (chunk != nullptr)
+            {
+                _n_hits += 1;
+                _hit_ns += clock.elapsed().as_nanoseconds();
+                return chunk;
+            }
+        }
+
+        auto* chunk = Mix_LoadWAV(path.c_str());
+        if (chunk != nullptr and not cache_path.empty())
+            store(cache_path, chunk);
+
+        _n_misses += 1;
+        _miss_ns += clock.elapsed().as_nanoseconds();
+        return chunk;
+    }
+
+    std::string SoundCache::get_cache_path(const std::string& path, const std::string& directory)
+    {
+        int frequency = 0;
+        uint16_t format = 0;
+        int n_channels = 0;
+
+        // the decoded samples are only valid for the output format they were converted to
+        if (Mix_QuerySpec(&frequency, &format, &n_channels) == 0)
+            return "";
+
+        bool success = false;
+        uint64_t hash = detail::hash_file(path, success);
+        if (not success)
+            return "";
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "%016llx_%d_%04x_%d.pcm", (unsigned long long) hash, frequency, format, n_channels);
+        return (std::filesystem::path(directory) / name).string();
+    }
+
+    Mix_Chunk* SoundCache::load_cached(const std::string& cache_path)
+    {
+        size_t n_bytes = 0;
+        void* data = detail::map_file(cache_path, n_bytes, true);
+        if (data == nullptr)
+            return nullptr;
+
+        // SDL_mixer does not take ownership of the samples, they are unmapped by free
+        auto* chunk = Mix_QuickLoad_RAW(static_cast<uint8_t*>(data), n_bytes);
+        if (chunk == nullptr)
+        {
+            munmap(data, n_bytes);
+            return nullptr;
+        }
+
+        auto guard = std::lock_guard(_lock);
+        _mappings.insert({chunk, Mapping{data, n_bytes}});
+        return chunk;
+    }
+
+    void SoundCache::store(const std::string& cache_path, const Mix_Chunk* chunk)
+    {
+        // written under a temporary name first, such that a partially written file is never mapped
+        auto temporary = cache_path + "." + std::to_string(getpid()) + "_" + std::to_string(_n_stored++) + ".tmp";
+        {
+            auto file = std::ofstream(temporary, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(chunk->abuf), chunk->alen);
+
+            if (not file)
+            {
+                Log::warning("In ts::SoundCache: unable to write \"", temporary, "\"");
+                std::remove(temporary.c_str());
+                return;
+            }
+        }
+
+        if (std::rename(temporary.c_str(), cache_path.c_str()) != 0)
+            std::remove(temporary.c_str());
+    }
+
+    void SoundCache::free(Mix_Chunk* chunk)
+    {
+        if (chunk == nullptr)
+            return;
+
+        // a play issued this frame would otherwise start the chunk after it was freed
+        detail::AudioCommandQueue::flush_pending();
+
+        auto mapping = Mapping{nullptr, 0};
+        {
+            auto guard = std::lock_guard(_lock);
+            auto it = _mappings.find(chunk);
+            if (it != _mappings.end())
+            {
+                mapping = it->second;
+                _mappings.erase(it);
+            }
+        }
+
+        // halts all channels still playing the chunk, so the samples can be unmapped afterwards
+        Mix_FreeChunk(chunk);
+
+        if (mapping.data != nullptr)
+            munmap(mapping.data, mapping.n_bytes);
+    }
+}
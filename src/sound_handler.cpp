@@ -1,11 +1,15 @@
-// 
+//
 // Copyright 2022 Joshua Higginbotham
 // Created on 24.05.22 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
 //
 
+#include <limits>
+#include <algorithm>
+
 #include <include/sound_handler.hpp>
 #include <include/logging.hpp>
 #include <include/music_handler.hpp>
+#include <include/audio_mixer.hpp>
 
 namespace ts
 {
@@ -20,122 +24,399 @@ namespace ts
         }
     }
 
-    size_t SoundHandler::next_free_channel()
+    bool SoundHandler::is_busy(size_t channel)
     {
+        auto& state = _channels[channel];
+        return state.n_started.load(std::memory_order_acquire) != state.n_finished.load(std::memory_order_acquire);
+    }
+
+    void SoundHandler::issue_play(size_t channel, Mix_Chunk* chunk, uint8_t bus, int32_t n_loops, Time fade_in_duration, uint32_t stream)
+    {
+        auto& state = _channels[channel];
+        state.n_started.fetch_add(1, std::memory_order_acq_rel);
+        state.is_paused = false;
+
+        auto command = detail::AudioCommand();
+        command.channel = channel;
+        command.n_loops = n_loops;
+        command.data = chunk;
+        command.bus = bus;
+        command.stream = stream;
+
+        if (fade_in_duration.as_milliseconds() > MusicHandler::sample_rate / 1000)
+        {
+            command.type = detail::AudioCommand::CHANNEL_FADE_IN;
+            command.duration_ms = fade_in_duration.as_milliseconds();
+        }
+        else
+            command.type = detail::AudioCommand::CHANNEL_PLAY;
+
+        detail::AudioCommandQueue::push(command);
+    }
+
+    void SoundHandler::on_channel_finished(int channel)
+    {
+        if (channel < 0 or channel >= int(n_channels))
+            return;
+
+        _channels[channel].n_finished.fetch_add(1, std::memory_order_acq_rel);
+
+        auto guard = std::lock_guard(_finished_lock);
+        if (not _is_finished[channel])
+        {
+            _is_finished[channel] = true;
+            _finished[_n_finished++] = channel;
+        }
+    }
+
+    void SoundHandler::collect_finished_channels()
+    {
+        if (not _voices_initialized)
+        {
+            // reversed, such that channel 0 is handed out first
+            for (size_t i = 0; i < n_channels; ++i)
+                _free_channels[i] = n_channels - 1 - i;
+
+            _n_free = n_channels;
+            _voices_initialized = true;
+        }
+
+        std::array<uint16_t, n_channels> finished;
+        size_t n_finished;
+
+        {
+            auto guard = std::lock_guard(_finished_lock);
+            n_finished = _n_finished;
+            for (size_t i = 0; i < n_finished; ++i)
+            {
+                finished[i] = _finished[i];
+                _is_finished[_finished[i]] = false;
+            }
+            _n_finished = 0;
+        }
+
+        // a channel may have been reused since it reported finishing, e.g. when its voice was stolen
+        for (size_t i = 0; i < n_finished; ++i)
+        {
+            auto channel = finished[i];
+            if (not _voices[channel].is_free and not is_busy(channel))
+                free_voice(channel);
+        }
+    }
+
+    void SoundHandler::free_voice(size_t channel)
+    {
+        auto& voice = _voices[channel];
+        if (voice.is_allocated)
+        {
+            _n_active_voices -= 1;
+            _polyphony[voice.sound_id].n_active -= 1;
+        }
+
+        voice = detail::Voice();
+        _free_channels[_n_free++] = channel;
+    }
+
+    size_t SoundHandler::find_victim(int32_t max_priority, size_t sound_id)
+    {
+        // linear, but only reads plain data and only happens if no channel is free
+        size_t out = no_channel;
         for (size_t i = 0; i < n_channels; ++i)
-            if (not is_playing(i) and not is_paused(i))
-                return i;
+        {
+            auto& voice = _voices[i];
+            if (not voice.is_allocated or voice.priority > max_priority)
+                continue;
+
+            if (sound_id != size_t(-1) and voice.sound_id != sound_id)
+                continue;
+
+            if (out == no_channel)
+            {
+                out = i;
+                continue;
+            }
 
-        return 0;
+            auto& current = _voices[out];
+            if (voice.priority < current.priority or (voice.priority == current.priority and voice.age < current.age))
+                out = i;
+        }
+
+        return out;
     }
 
-    void SoundHandler::play(size_t channel, Sound& sound,  size_t n_loops, Time fade_in_duration)
+    size_t SoundHandler::allocate_voice(int32_t priority, size_t sound_id)
     {
-        channel = forward_index(channel, "play");
+        collect_finished_channels();
 
-        if (fade_in_duration.as_milliseconds() > MusicHandler::sample_rate / 1000)
-            Mix_FadeInChannel(channel, sound._chunk, n_loops, fade_in_duration.as_milliseconds());
+        size_t channel = no_channel;
+        auto& polyphony = _polyphony[sound_id];
+
+        if (polyphony.max > 0 and polyphony.n_active >= polyphony.max)
+            channel = find_victim(std::numeric_limits<int32_t>::max(), sound_id);
         else
-            Mix_PlayChannel(channel, sound._chunk, n_loops);
+        {
+            while (_n_free > 0)
+            {
+                auto candidate = _free_channels[--_n_free];
+                if (is_busy(candidate))
+                {
+                    // played on directly by index, returns to the stack once it finishes
+                    _voices[candidate].is_free = false;
+                    continue;
+                }
+
+                channel = candidate;
+                break;
+            }
+
+            if (channel == no_channel)
+                channel = find_victim(priority, size_t(-1));
+        }
+
+        if (channel == no_channel)
+            return no_channel;
+
+        auto& voice = _voices[channel];
+        if (voice.is_allocated)
+        {
+            // steal, playing on a busy channel halts it, the finished event this causes is
+            // ignored because the channel is busy again by the time it is collected
+            _n_active_voices -= 1;
+            _polyphony[voice.sound_id].n_active -= 1;
+            _n_stolen_voices += 1;
+        }
+
+        voice.is_free = false;
+        voice.is_allocated = true;
+        voice.priority = priority;
+        voice.age = ++_current_age;
+        voice.sound_id = sound_id;
+
+        _n_active_voices += 1;
+        _polyphony[sound_id].n_active += 1;
+        return channel;
+    }
+
+    size_t SoundHandler::next_free_channel()
+    {
+        auto guard = std::lock_guard(_voice_lock);
+        collect_finished_channels();
+
+        while (_n_free > 0)
+        {
+            auto candidate = _free_channels[_n_free - 1];
+            if (not is_busy(candidate))
+                return candidate;
+
+            _voices[candidate].is_free = false;
+            _n_free -= 1;
+        }
+
+        auto victim = find_victim(std::numeric_limits<int32_t>::max(), size_t(-1));
+        return victim != no_channel ? victim : 0;
+    }
+
+    size_t SoundHandler::play(Sound& sound, int32_t priority, size_t n_loops, Time fade_in_duration)
+    {
+        // the play is issued while holding the lock, such that no other thread can collect the channel as finished in between
+        auto guard = std::lock_guard(_voice_lock);
+
+        auto channel = allocate_voice(priority, sound.get_id());
+        if (channel == no_channel)
+            return no_channel;
+
+        issue_play(channel, sound._chunk, uint8_t(AudioMixer::get_bus(sound)), n_loops, fade_in_duration);
+        return channel;
+    }
+
+    size_t SoundHandler::play(StreamingSound& sound, int32_t priority, Time fade_in_duration)
+    {
+        if (sound._stream == nullptr)
+        {
+            Log::warning("In ts::SoundHandler::play: streamed sound is not loaded");
+            return no_channel;
+        }
+
+        auto* silence = StreamingSound::get_silence();
+        auto guard = std::lock_guard(_voice_lock);
+
+        auto channel = allocate_voice(priority, sound.get_id());
+        if (channel == no_channel)
+            return no_channel;
+
+        // the silent chunk loops until the stream ended, c.f. ts::StreamingSound::update
+        issue_play(channel, silence, uint8_t(AudioMixer::get_bus(sound)), -1, fade_in_duration, sound._stream->serial);
+        return channel;
+    }
+
+    void SoundHandler::set_max_polyphony(const Sound& sound, size_t n_voices)
+    {
+        auto guard = std::lock_guard(_voice_lock);
+        _polyphony[sound.get_id()].max = n_voices;
+    }
+
+    size_t SoundHandler::get_max_polyphony(const Sound& sound)
+    {
+        auto guard = std::lock_guard(_voice_lock);
+
+        auto it = _polyphony.find(sound.get_id());
+        return it != _polyphony.end() ? it->second.max : 0;
+    }
+
+    size_t SoundHandler::get_n_active_voices()
+    {
+        auto guard = std::lock_guard(_voice_lock);
+        collect_finished_channels();
+        return _n_active_voices;
+    }
+
+    size_t SoundHandler::get_n_stolen_voices()
+    {
+        auto guard = std::lock_guard(_voice_lock);
+        return _n_stolen_voices;
+    }
+
+    void SoundHandler::play(size_t channel, Sound& sound,  size_t n_loops, Time fade_in_duration)
+    {
+        issue_play(forward_index(channel, "play"), sound._chunk, uint8_t(AudioMixer::get_bus(sound)), n_loops, fade_in_duration);
+    }
+
+    void SoundHandler::play(size_t channel, StreamingSound& sound, Time fade_in_duration)
+    {
+        if (sound._stream == nullptr)
+        {
+            Log::warning("In ts::SoundHandler::play: streamed sound is not loaded");
+            return;
+        }
+
+        issue_play(forward_index(channel, "play"), StreamingSound::get_silence(), uint8_t(AudioMixer::get_bus(sound)), -1, fade_in_duration, sound._stream->serial);
     }
 
     void SoundHandler::stop(size_t channel, Time fade_out_duration)
     {
-        auto guard = std::lock_guard(_lock);
-        channel = forward_index(channel, "stop");
+        auto command = detail::AudioCommand();
+        command.channel = forward_index(channel, "stop");
 
         if (fade_out_duration.as_milliseconds() > MusicHandler::sample_rate / 1000)
-            Mix_FadeOutChannel(channel, fade_out_duration.as_milliseconds());
+        {
+            command.type = detail::AudioCommand::CHANNEL_FADE_OUT;
+            command.duration_ms = fade_out_duration.as_milliseconds();
+        }
         else
-            Mix_HaltChannel(channel);
+            command.type = detail::AudioCommand::CHANNEL_STOP;
+
+        detail::AudioCommandQueue::push(command);
     }
 
     void SoundHandler::pause(size_t channel)
     {
-        auto guard = std::lock_guard(_lock);
-        Mix_Pause(forward_index(channel, "pause"));
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::CHANNEL_PAUSE;
+        command.channel = forward_index(channel, "pause");
+
+        _channels[command.channel].is_paused = true;
+        detail::AudioCommandQueue::push(command);
     }
 
     void SoundHandler::unpause(size_t channel)
     {
-        auto guard = std::lock_guard(_lock);
-        Mix_Resume(forward_index(channel, "unpause"));
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::CHANNEL_UNPAUSE;
+        command.channel = forward_index(channel, "unpause");
+
+        _channels[command.channel].is_paused = false;
+        detail::AudioCommandQueue::push(command);
     }
 
     void SoundHandler::force_stop(size_t channel)
     {
-        auto guard = std::lock_guard(_lock);
-        Mix_ExpireChannel(forward_index(channel, "force_stop"), 0);
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::CHANNEL_EXPIRE;
+        command.channel = forward_index(channel, "force_stop");
+        detail::AudioCommandQueue::push(command);
     }
 
     bool SoundHandler::is_playing(size_t channel)
     {
-        auto guard = std::lock_guard(_lock);
         channel = forward_index(channel, "is_playing");
-        return not Mix_Paused(channel) and Mix_Playing(channel);
+        return not _channels[channel].is_paused and is_busy(channel);
     }
 
     bool SoundHandler::is_paused(size_t channel)
     {
-        return Mix_Paused(forward_index(channel, "is_paused"));
+        return _channels[forward_index(channel, "is_paused")].is_paused;
     }
 
     bool SoundHandler::is_stopped(size_t channel)
     {
-        return not Mix_Playing(forward_index(channel, "is_stopped"));
+        return not is_busy(forward_index(channel, "is_stopped"));
     }
 
     void SoundHandler::set_volume(size_t channel, float zero_to_one)
     {
         channel = forward_index(channel, "set_volume");
-        auto guard = std::lock_guard(_lock);
         if (zero_to_one > 1.0)
         {
-            static bool once = false;
+            static std::atomic<bool> once = false;
 
-            if (not once)
-            {
+            if (not once.exchange(true))
                 Log::warning("In ts::SoundHandler.set_volume: volume level ", zero_to_one,
                              " is outside [0, 1]; volume will instead be set to 1 (the maximum).");
-                once = true;
-            }
+
             zero_to_one = 1.0;
         }
         else if (zero_to_one < 0)
         {
-            static bool once = false;
+            static std::atomic<bool> once = false;
 
-            if (not once)
-            {
+            if (not once.exchange(true))
                 Log::warning("In ts::SoundHandler.set_volume: volume level ", zero_to_one,
                          " is outside [0, 1]; volume will instead be set to 0 (the minimum).");
-                once = true;
-            }
+
             zero_to_one = 0.0;
         }
 
-        Mix_Volume(channel, zero_to_one * 128);
-        _volume[channel] = zero_to_one;
+        _channels[channel].volume = zero_to_one;
+
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::CHANNEL_SET_VOLUME;
+        command.channel = channel;
+        command.value = zero_to_one;
+        detail::AudioCommandQueue::push(command);
     }
 
     float SoundHandler::get_volume(size_t channel)
     {
-        return _volume[forward_index(channel, "get_volume")];
+        return _channels[forward_index(channel, "get_volume")].volume;
     }
 
     void SoundHandler::set_panning(size_t channel, Angle angle)
     {
-        auto guard = std::lock_guard(_lock);
-
         channel = forward_index(channel, "set_panning");
-        _panning[channel] = angle.as_degrees();
+        _channels[channel].panning = angle.as_degrees();
+
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::CHANNEL_SET_PANNING;
+        command.channel = channel;
+        command.value = angle.as_degrees();
+        detail::AudioCommandQueue::push(command);
+    }
+
+    void SoundHandler::set_position(size_t channel, Angle angle, float distance)
+    {
+        channel = forward_index(channel, "set_position");
+        _channels[channel].panning = angle.as_degrees();
 
-        Mix_SetPosition(channel, angle.as_degrees(), 0);
+        auto command = detail::AudioCommand();
+        command.type = detail::AudioCommand::CHANNEL_SET_POSITION;
+        command.channel = channel;
+        command.value = angle.as_degrees();
+        command.distance = std::clamp(distance, 0.f, 1.f) * 255;
+        detail::AudioCommandQueue::push(command);
     }
 
     Angle SoundHandler::get_panning(size_t channel)
     {
-        return ts::degrees(_panning[forward_index(channel, "get_panning")]);
+        return ts::degrees(_channels[forward_index(channel, "get_panning")].panning);
     }
 }
-
@@ -0,0 +1,734 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#include <algorithm>
+#include <cstring>
+
+#include <include/streaming_sound.hpp>
+#include <include/sound_handler.hpp>
+#include <include/sound_cache.hpp>
+#include <include/audio_device.hpp>
+#include <include/logging.hpp>
+
+namespace ts
+{
+    namespace detail
+    {
+        SoundStream::~SoundStream()
+        {
+            // the transcoding thread only holds a raw pointer
+            if (transcoder.joinable())
+                transcoder.join();
+
+            if (converter != nullptr)
+                SDL_FreeAudioStream(converter);
+
+            if (file != nullptr)
+                std::fclose(file);
+        }
+
+        StreamWorker::~StreamWorker()
+        {
+            {
+                auto guard = std::lock_guard(lock);
+                should_stop = true;
+            }
+
+            wake.notify_all();
+            if (thread.joinable())
+                thread.join();
+        }
+
+        // byte range and format of the samples of an uncompressed .wav file
+        struct WavInfo
+        {
+            uint16_t format = 0; // SDLs AUDIO_* constant
+            int n_channels = 0;
+            int frequency = 0;
+            size_t data_begin = 0;
+            size_t data_end = 0;
+        };
+
+        // returns false for anything SDL_AudioStream can not convert directly, which is then decoded by SDL_mixer instead
+        bool parse_wav(FILE* file, WavInfo& info)
+        {
+            auto read_u16 = [](const uint8_t* data) { return uint16_t(data[0] | data[1] << 8); };
+            auto read_u32 = [](const uint8_t* data) { return uint32_t(data[0] | data[1] << 8 | data[2] << 16 | uint32_t(data[3]) << 24); };
+
+            uint8_t header[12];
+            if (std::fread(header, 1, 12, file) != 12 or std::memcmp(header, "RIFF", 4) != 0 or std::memcmp(header + 8, "WAVE", 4) != 0)
+                return false;
+
+            bool has_format = false;
+            uint8_t chunk[8];
+            while (std::fread(chunk, 1, 8, file) == 8)
+            {
+                uint32_t n_bytes = read_u32(chunk + 4);
+                long begin = std::ftell(file);
+
+                if (std::memcmp(chunk, "fmt ", 4) == 0 and n_bytes >= 16)
+                {
+                    uint8_t fmt[40] = {};
+                    if (std::fread(fmt, 1, std::min<uint32_t>(n_bytes, sizeof(fmt)), file) < 16)
+                        return false;
+
+                    uint16_t tag = read_u16(fmt);
+                    if (tag == 0xFFFE and n_bytes >= 26) // WAVE_FORMAT_EXTENSIBLE, the actual tag starts the sub format
+                        tag = read_u16(fmt + 24);
+
+                    uint16_t bits = read_u16(fmt + 14);
+                    info.n_channels = read_u16(fmt + 2);
+                    info.frequency = read_u32(fmt + 4);
+
+                    if (tag == 1 and bits == 8)
+                        info.format = AUDIO_U8;
+                    else if (tag == 1 and bits == 16)
+                        info.format = AUDIO_S16LSB;
+                    else if (tag == 1 and bits == 32)
+                        info.format = AUDIO_S32LSB;
+                    else if (tag == 3 and bits == 32)
+                        info.format = AUDIO_F32LSB;
+                    else
+                        return false;
+
+                    has_format = info.n_channels > 0 and info.frequency > 0;
+                }
+                else if (std::memcmp(chunk, "data", 4) == 0)
+                {
+                    info.data_begin = begin;
+                    info.data_end = begin + n_bytes;
+                    return has_format;
+                }
+
+                // chunks are padded to an even size
+                if (std::fseek(file, begin + n_bytes + (n_bytes & 1), SEEK_SET) != 0)
+                    return false;
+            }
+
+            return false;
+        }
+    }
+
+    // ### GAME THREAD ###
+
+    StreamingSound::StreamingSound()
+    {}
+
+    StreamingSound::StreamingSound(const std::string& path)
+    {
+        load(path);
+    }
+
+    StreamingSound::~StreamingSound()
+    {
+        unload();
+    }
+
+    bool StreamingSound::load(const std::string& path)
+    {
+        unload();
+
+        auto stream = std::make_shared<detail::SoundStream>();
+        stream->path = path;
+
+        {
+            auto guard = std::lock_guard(stream->decode_lock);
+            if (not open_source(*stream))
+            {
+                Log::warning("In ts::StreamingSound::load: unable to load \"", path, "\"");
+                return false;
+            }
+        }
+
+        {
+            auto guard = std::lock_guard(_registry_lock);
+            stream->serial = _next_serial++;
+            _registry.insert({stream->serial, stream});
+        }
+
+        _stream = stream;
+        _id = std::hash<std::string>()(path);
+
+        {
+            auto guard = std::lock_guard(_worker.lock);
+            if (not _worker.thread.joinable())
+                _worker.thread = std::thread(&StreamingSound::run_worker);
+        }
+
+        wake_worker();
+        return true;
+    }
+
+    void StreamingSound::unload()
+    {
+        if (_stream == nullptr)
+            return;
+
+        {
+            auto guard = std::lock_guard(_registry_lock);
+            _registry.erase(_stream->serial);
+        }
+
+        // the audio thread only holds a raw pointer, it has to be detached before the stream can be freed
+        SDL_LockAudio();
+        int channel = _stream->channel;
+        if (channel != -1)
+        {
+            Mix_UnregisterEffect(channel, &on_channel_effect);
+            Mix_HaltChannel(channel);
+        }
+        SDL_UnlockAudio();
+
+        // joined here instead of in the destructor, which may run on the worker thread
+        auto transcoder = std::thread();
+        {
+            auto guard = std::lock_guard(_stream->decode_lock);
+            _stream->needs_transcode = false;
+            transcoder = std::move(_stream->transcoder);
+        }
+
+        if (transcoder.joinable())
+            transcoder.join();
+
+        _stream.reset();
+        _id = -1;
+    }
+
+    size_t StreamingSound::get_id() const
+    {
+        return _id;
+    }
+
+    void StreamingSound::set_should_loop(bool b)
+    {
+        if (_stream != nullptr)
+            _stream->should_loop = b;
+    }
+
+    bool StreamingSound::get_should_loop() const
+    {
+        return _stream != nullptr and _stream->should_loop;
+    }
+
+    size_t StreamingSound::get_channel() const
+    {
+        if (_stream == nullptr)
+            return SoundHandler::no_channel;
+
+        int channel = _stream->channel;
+        return channel == -1 ? SoundHandler::no_channel : size_t(channel);
+    }
+
+    size_t StreamingSound::get_n_bytes() const
+    {
+        return _stream == nullptr ? 0 : _stream->ring.size();
+    }
+
+    Time StreamingSound::get_transcode_cpu_time() const
+    {
+        return nanoseconds(_stream == nullptr ? 0 : _stream->transcode_ns.load());
+    }
+
+        Time StreamingSound::get_decode_cpu_time() const
+    {
+        return nanoseconds(_stream == nullptr ? 0 : _stream->decode_ns.load());
+    }
+
+    float StreamingSound::get_decode_load() const
+    {
+        if (_stream == nullptr or _stream->frequency == 0 or _stream->n_decoded_frames == 0)
+            return 0;
+
+        double decoded_ns = _stream->n_decoded_frames * 1e9 / _stream->frequency;
+        return _stream->decode_ns / decoded_ns;
+    }
+
+    size_t StreamingSound::get_n_underruns() const
+    {
+        return _stream == nullptr ? 0 : _stream->n_underruns.load();
+    }
+
+    size_t StreamingSound::get_n_streams()
+    {
+        auto guard = std::lock_guard(_registry_lock);
+        return _registry.size();
+    }
+
+    Mix_Chunk* StreamingSound::get_silence()
+    {
+        auto guard = std::lock_guard(_registry_lock);
+        if (_silence_chunk == nullptr)
+            _silence_chunk = Mix_QuickLoad_RAW(_silence.data(), _silence.size());
+
+        return _silence_chunk;
+    }
+
+    // ### WORKER THREAD ###
+
+    void StreamingSound::wake_worker()
+    {
+        _worker.wake.notify_one();
+    }
+
+    void StreamingSound::run_worker()
+    {
+        auto streams = std::vector<std::shared_ptr<detail::SoundStream>>();
+        auto lock = std::unique_lock(_worker.lock);
+
+        while (not _worker.should_stop)
+        {
+            lock.unlock();
+
+            {
+                auto guard = std::lock_guard(_registry_lock);
+                for (auto& pair : _registry)
+                    streams.push_back(pair.second);
+            }
+
+            for (auto& stream : streams)
+            {
+                auto guard = std::lock_guard(stream->decode_lock);
+                fill(*stream);
+            }
+
+            // released before sleeping, such that unloaded streams are freed right away
+            streams.clear();
+
+            // the ring buffers hold far more than one wait, the audio thread never has to wake the worker
+            lock.lock();
+            _worker.wake.wait_for(lock, std::chrono::milliseconds(5));
+        }
+    }
+
+    void StreamingSound::close_source(detail::SoundStream& stream)
+    {
+        if (stream.converter != nullptr)
+            SDL_FreeAudioStream(stream.converter);
+
+        if (stream.file != nullptr)
+            std::fclose(stream.file);
+
+        stream.converter = nullptr;
+        stream.file = nullptr;
+        stream.needs_transcode = false;
+        stream.transcode_failed = false;
+        stream.source_serial += 1;
+    }
+
+    bool StreamingSound::open_source(detail::SoundStream& stream)
+    {
+        close_source(stream);
+
+        int frequency = 0;
+        uint16_t format = 0;
+        int n_channels = 0;
+
+        if (Mix_QuerySpec(&frequency, &format, &n_channels) == 0)
+            return false;
+
+        stream.frequency = frequency;
+        stream.bytes_per_frame = std::max(1, (SDL_AUDIO_BITSIZE(format) / 8) * n_channels);
+        stream.ring.assign(buffer_n_frames * stream.bytes_per_frame, 0);
+
+        // nothing is playing, c.f. load and reload_all
+        stream.write = 0;
+        stream.read = 0;
+        stream.start = 0;
+        stream.end = size_t(-1);
+        stream.decoded_generation = stream.requested_generation;
+        stream.start_generation = stream.requested_generation.load();
+        stream.consumer_generation = stream.requested_generation;
+        stream.has_output = false;
+        stream.is_finished = false;
+
+        auto* file = std::fopen(stream.path.c_str(), "rb");
+        if (file == nullptr)
+            return false;
+
+        auto info = detail::WavInfo();
+        if (detail::parse_wav(file, info))
+        {
+            stream.file = file;
+            stream.data_begin = info.data_begin;
+            stream.data_end = info.data_end;
+            stream.source_bytes_per_frame = std::max(1, (SDL_AUDIO_BITSIZE(info.format) / 8) * info.n_channels);
+
+            if (info.format != format or info.n_channels != n_channels or info.frequency != frequency)
+                stream.converter = SDL_NewAudioStream(info.format, info.n_channels, info.frequency, format, n_channels, frequency);
+
+            if (stream.converter != nullptr or (info.format == format and info.n_channels == n_channels and info.frequency == frequency))
+            {
+                rewind(stream);
+                return true;
+            }
+
+            stream.file = nullptr;
+        }
+
+        // compressed, decoded on its own thread, c.f. start_transcode
+        std::fclose(file);
+        stream.needs_transcode = true;
+        return true;
+    }
+
+    void StreamingSound::start_transcode(detail::SoundStream& stream)
+    {
+        // in this order, such that the audio thread sees at least one of them set until the file is decoded
+        stream.is_transcoding = true;
+        stream.needs_transcode = false;
+
+        // the previous transcode is done, c.f. is_transcoding
+        if (stream.transcoder.joinable())
+            stream.transcoder.join();
+
+        stream.transcoder = std::thread([&stream, path = stream.path, serial = stream.source_serial]() {
+            auto cpu_begin = detail::thread_cpu_ns();
+            auto* file = transcode(path);
+            stream.transcode_ns += detail::thread_cpu_ns() - cpu_begin;
+
+            {
+                auto guard = std::lock_guard(stream.decode_lock);
+                if (serial != stream.source_serial)
+                {
+                    // the source was reopened meanwhile, possibly in another output format
+                    if (file != nullptr)
+                        std::fclose(file);
+                }
+                else if (file == nullptr)
+                    stream.transcode_failed = true;
+                else
+                {
+                    std::fseek(file, 0, SEEK_END);
+                    stream.file = file;
+                    stream.data_begin = 0;
+                    stream.data_end = std::max<long>(0, std::ftell(file));
+                    stream.source_bytes_per_frame = stream.bytes_per_frame;
+                    rewind(stream);
+                }
+
+                stream.is_transcoding = false;
+            }
+
+            wake_worker();
+        });
+    }
+
+    FILE* StreamingSound::transcode(const std::string& path)
+    {
+        // SDL_mixer can only decode the whole file at once, the decoded chunk is freed as soon as it is written
+        FILE* file = nullptr;
+        auto directory = SoundCache::get_directory();
+        if (directory.empty())
+        {
+            // no cache, decoded into an anonymous file which the system deletes once it is closed, c.f. close_source
+            auto* chunk = Mix_LoadWAV(path.c_str());
+            if (chunk == nullptr)
+                return nullptr;
+
+            file = std::tmpfile();
+            bool written = file != nullptr and std::fwrite(chunk->abuf, 1, chunk->alen, file) == chunk->alen;
+            Mix_FreeChunk(chunk);
+
+            if (not written)
+            {
+                if (file != nullptr)
+                    std::fclose(file);
+
+                return nullptr;
+            }
+
+            return file;
+        }
+
+        // decoded only the first time a file is streamed, later streams read the cache file
+        auto cache_path = SoundCache::get_cache_path(path, directory);
+        if (cache_path.empty())
+            return nullptr;
+
+        file = std::fopen(cache_path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            auto* chunk = Mix_LoadWAV(path.c_str());
+            if (chunk == nullptr)
+                return nullptr;
+
+            SoundCache::store(cache_path, chunk);
+            Mix_FreeChunk(chunk);
+
+            file = std::fopen(cache_path.c_str(), "rb");
+        }
+
+        return file;
+    }
+
+    void StreamingSound::rewind(detail::SoundStream& stream)
+    {
+        std::fseek(stream.file, stream.data_begin, SEEK_SET);
+        stream.position = stream.data_begin;
+        stream.is_flushed = false;
+
+        if (stream.converter != nullptr)
+            SDL_AudioStreamClear(stream.converter);
+    }
+
+    size_t StreamingSound::read_source(detail::SoundStream& stream, uint8_t* out, size_t n_bytes)
+    {
+        // a short read is treated as the end of the file, such that the position stays aligned to frames
+        auto read = [&](uint8_t* to, size_t n, size_t frame) -> size_t {
+            n = std::min(n, stream.data_end - stream.position);
+            n -= n % frame;
+
+            size_t n_read = n > 0 ? std::fread(to, 1, n, stream.file) : 0;
+            if (n_read < n)
+            {
+                stream.position = stream.data_end;
+                return n_read - n_read % frame;
+            }
+
+            stream.position += n_read;
+            return n_read;
+        };
+
+        if (stream.converter == nullptr)
+            return read(out, n_bytes, stream.bytes_per_frame);
+
+        uint8_t in[4096];
+        while (SDL_AudioStreamAvailable(stream.converter) < int(n_bytes) and not stream.is_flushed)
+        {
+            size_t n = read(in, sizeof(in), stream.source_bytes_per_frame);
+            if (n == 0)
+            {
+                SDL_AudioStreamFlush(stream.converter);
+                stream.is_flushed = true;
+                break;
+            }
+
+            SDL_AudioStreamPut(stream.converter, in, n);
+        }
+
+        int n_out = SDL_AudioStreamGet(stream.converter, out, n_bytes);
+        return n_out > 0 ? n_out - n_out % stream.bytes_per_frame : 0;
+    }
+
+    void StreamingSound::fill(detail::SoundStream& stream)
+    {
+        static constexpr size_t block_n_frames = 4096;
+        static thread_local std::vector<uint8_t> block;
+
+        auto cpu_begin = detail::thread_cpu_ns();
+
+        // restart requested by on_play, everything decoded so far is skipped by the audio thread
+        uint32_t requested = stream.requested_generation.load(std::memory_order_acquire);
+        if (requested != stream.decoded_generation)
+        {
+            if (stream.file != nullptr)
+                rewind(stream);
+
+            stream.end = size_t(-1);
+            stream.start = stream.write.load();
+            stream.decoded_generation = requested;
+            stream.start_generation.store(requested, std::memory_order_release);
+        }
+
+        // never waits for the transcode, the stream starts once it is done
+        if (stream.needs_transcode and not stream.is_transcoding)
+            start_transcode(stream);
+
+        if (stream.transcode_failed)
+        {
+            Log::warning("In ts::StreamingSound: unable to decode \"", stream.path, "\"");
+            stream.transcode_failed = false;
+            stream.end = stream.write.load();
+        }
+
+        if (stream.file == nullptr or stream.end != size_t(-1))
+            return;
+
+        const size_t capacity = stream.ring.size();
+        const size_t block_n_bytes = block_n_frames * stream.bytes_per_frame;
+        block.resize(block_n_bytes);
+
+        size_t n_written = 0;
+        bool has_rewound = false; // guards against looping an empty file forever
+
+        while (true)
+        {
+            // after a restart, the audio thread never reads what was decoded before start, even if it did not skip it yet
+            size_t write = stream.write.load(std::memory_order_relaxed);
+            size_t read = std::max(stream.read.load(std::memory_order_acquire), stream.start.load(std::memory_order_relaxed));
+            if (capacity - (write - read) < block_n_bytes)
+                break;
+
+            size_t n = read_source(stream, block.data(), block_n_bytes);
+            if (n == 0)
+            {
+                if (stream.should_loop and not has_rewound)
+                {
+                    rewind(stream);
+                    has_rewound = true;
+                    continue;
+                }
+
+                if (not stream.should_loop)
+                    stream.end.store(write, std::memory_order_release);
+
+                break;
+            }
+
+            has_rewound = false;
+
+            size_t offset = write % capacity;
+            size_t first = std::min(n, capacity - offset);
+            std::memcpy(stream.ring.data() + offset, block.data(), first);
+            std::memcpy(stream.ring.data(), block.data() + first, n - first);
+
+            stream.write.store(write + n, std::memory_order_release);
+            n_written += n;
+        }
+
+        stream.decode_ns += detail::thread_cpu_ns() - cpu_begin;
+        stream.n_decoded_frames += n_written / stream.bytes_per_frame;
+    }
+
+    // ### COMMANDS ###
+
+    void StreamingSound::on_play(size_t channel, uint32_t serial)
+    {
+        auto stream = std::shared_ptr<detail::SoundStream>();
+        {
+            auto guard = std::lock_guard(_registry_lock);
+            auto it = _registry.find(serial);
+            if (it != _registry.end())
+                stream = it->second;
+        }
+
+        // unloaded before the play was applied
+        if (stream == nullptr)
+        {
+            Mix_HaltChannel(channel);
+            return;
+        }
+
+        // a stream has only one read position, so it moves to the new channel
+        int previous = stream->channel;
+        if (previous != -1 and previous != int(channel))
+        {
+            Mix_UnregisterEffect(previous, &on_channel_effect);
+            Mix_HaltChannel(previous);
+        }
+
+        // played before, start over. Otherwise the beginning is already decoded
+        if (stream->has_output)
+        {
+            stream->has_output = false;
+            stream->requested_generation += 1;
+            wake_worker();
+        }
+
+        stream->is_finished = false;
+
+        // registered before ts::AudioMixer, such that the mixer sees the stream instead of silence
+        if (Mix_RegisterEffect(channel, &on_channel_effect, &on_channel_effect_done, stream.get()) != 0)
+            stream->channel = channel;
+        else
+            Mix_HaltChannel(channel);
+    }
+
+    void StreamingSound::update()
+    {
+        // streams that are not looping end once the audio thread played their last sample
+        auto guard = std::lock_guard(_registry_lock);
+        for (auto& pair : _registry)
+        {
+            auto& stream = *pair.second;
+            int channel = stream.channel;
+            if (stream.is_finished and channel != -1)
+            {
+                stream.is_finished = false;
+                Mix_HaltChannel(channel);
+            }
+        }
+    }
+
+    void StreamingSound::reload_all()
+    {
+        auto streams = std::vector<std::shared_ptr<detail::SoundStream>>();
+        {
+            auto guard = std::lock_guard(_registry_lock);
+            for (auto& pair : _registry)
+                streams.push_back(pair.second);
+        }
+
+        // the ring buffers hold samples in the previous output format
+        for (auto& stream : streams)
+        {
+            auto guard = std::lock_guard(stream->decode_lock);
+            if (not open_source(*stream))
+                Log::warning("In ts::StreamingSound::reload_all: unable to reload \"", stream->path, "\"");
+        }
+
+        wake_worker();
+    }
+
+    // ### AUDIO THREAD ###
+
+    void StreamingSound::on_channel_effect(int, void* out, int length, void* data)
+    {
+        auto& stream = *static_cast<detail::SoundStream*>(data);
+        auto* to = static_cast<uint8_t*>(out);
+
+        // silent until the worker rewound the source or a compressed file is decoded, this is not an underrun
+        if (stream.needs_transcode or stream.is_transcoding)
+        {
+            std::memset(to, 0, length);
+            return;
+        }
+
+        uint32_t generation = stream.requested_generation.load(std::memory_order_acquire);
+        if (stream.start_generation.load(std::memory_order_acquire) != generation)
+        {
+            std::memset(to, 0, length);
+            return;
+        }
+
+        if (stream.consumer_generation != generation)
+        {
+            stream.read.store(stream.start.load(std::memory_order_relaxed), std::memory_order_release);
+            stream.consumer_generation = generation;
+        }
+
+        const size_t capacity = stream.ring.size();
+        size_t read = stream.read.load(std::memory_order_relaxed);
+        size_t write = stream.write.load(std::memory_order_acquire);
+        size_t n = std::min<size_t>(length, write - read);
+
+        size_t offset = read % capacity;
+        size_t first = std::min(n, capacity - offset);
+        std::memcpy(to, stream.ring.data() + offset, first);
+        std::memcpy(to + first, stream.ring.data(), n - first);
+
+        stream.read.store(read + n, std::memory_order_release);
+        stream.has_output = true;
+
+        if (n < size_t(length))
+        {
+            std::memset(to + n, 0, length - n);
+
+            if (read + n >= stream.end.load(std::memory_order_acquire))
+                stream.is_finished = true;
+            else
+                stream.n_underruns += 1;
+        }
+    }
+
+    void StreamingSound::on_channel_effect_done(int channel, void* data)
+    {
+        auto& stream = *static_cast<detail::SoundStream*>(data);
+
+        // the stream may have moved to another channel already
+        int expected = channel;
+        stream.channel.compare_exchange_strong(expected, -1);
+    }
+}
@@ -0,0 +1,234 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+#include <algorithm>
+#include <numeric>
+
+#include <include/world_scheduler.hpp>
+#include <include/logging.hpp>
+
+namespace ts
+{
+    WorldScheduler::WorldScheduler(size_t n_threads)
+    {
+        for (size_t i = 0; i < n_threads; ++i)
+            _queues.push_back(std::make_unique<WorkQueue>());
+
+        for (size_t i = 0; i < n_threads; ++i)
+            _threads.emplace_back(&WorldScheduler::worker_loop, this, i);
+    }
+
+    WorldScheduler::~WorldScheduler()
+    {
+        {
+            auto lock = std::lock_guard(_state_lock);
+            _shutdown = true;
+        }
+        _work_available.notify_all();
+
+        for (auto& thread : _threads)
+            thread.join();
+    }
+
+    size_t WorldScheduler::add_world(Time timestep)
+    {
+        _worlds.push_back(WorldEntry{std::make_unique<PhysicsWorld>(), timestep.as_seconds(), 0});
+        return _worlds.size() - 1;
+    }
+
+    PhysicsWorld* WorldScheduler::get_world(size_t index)
+    {
+        return _worlds.at(index).world.get();
+    }
+
+    size_t WorldScheduler::get_n_worlds() const
+    {
+        return _worlds.size();
+    }
+
+    void WorldScheduler::set_timestep(size_t index, Time timestep)
+    {
+        if (timestep.as_nanoseconds() == 0)
+        {
+            Log::warning("In ts::WorldScheduler::set_timestep: timestep cannot be 0, the timestep of world #", index, " was not changed.");
+            return;
+        }
+
+        _worlds.at(index).timestep = timestep.as_seconds();
+    }
+
+    Time WorldScheduler::get_timestep(size_t index) const
+    {
+        return seconds(_worlds.at(index).timestep);
+    }
+
+    Time WorldScheduler::get_step_duration(size_t index) const
+    {
+        return _worlds.at(index).last_duration;
+    }
+
+    size_t WorldScheduler::get_n_steps(size_t index) const
+    {
+        return _worlds.at(index).last_n_steps;
+    }
+
+    size_t WorldScheduler::get_n_threads() const
+    {
+        return _threads.size();
+    }
+
+    const std::vector<ScheduledCollisionEvent>& WorldScheduler::get_events() const
+    {
+        return _events;
+    }
+
+    void WorldScheduler::run(size_t world_index)
+    {
+        auto& entry = _worlds.at(world_index);
+        auto clock = Clock();
+
+        entry.accumulator += _elapsed;
+
+        size_t n_steps = 0;
+        while (entry.accumulator >= entry.timestep and n_steps < max_steps_per_call)
+        {
+            entry.world->step(seconds(entry.timestep), _velocity_iterations, _position_iterations);
+            entry.accumulator -= entry.timestep;
+            n_steps += 1;
+        }
+
+        // if the world fell behind, drop the remainder instead of carrying it over indefinitely
+        if (n_steps == max_steps_per_call)
+            entry.accumulator = std::min(entry.accumulator, entry.timestep);
+
+        entry.last_n_steps = n_steps;
+        entry.last_duration = clock.elapsed();
+    }
+
+    void WorldScheduler::step(Time elapsed, int32_t velocity_iterations, int32_t position_iterations)
+    {
+        _elapsed = elapsed.as_seconds();
+        _velocity_iterations = velocity_iterations;
+        _position_iterations = position_iterations;
+
+        if (_threads.empty() or _worlds.size() <= 1)
+        {
+            for (size_t i = 0; i < _worlds.size(); ++i)
+                run(i);
+        }
+        else
+        {
+            // distribute the most expensive worlds of the last step first, such that no thread
+            // is left with a single long world at the end
+
+            std::vector<size_t> order(_worlds.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&](size_t a, size_t b){
+                return _worlds.at(a).last_duration.as_nanoseconds() > _worlds.at(b).last_duration.as_nanoseconds();
+            });
+
+            _n_remaining = _worlds.size();
+            for (size_t i = 0; i < order.size(); ++i)
+            {
+                auto& queue = *_queues.at(i % _queues.size());
+                auto lock = std::lock_guard(queue.lock);
+                queue.tasks.push_back(order.at(i));
+            }
+
+            {
+                auto lock = std::lock_guard(_state_lock);
+                _generation += 1;
+            }
+            _work_available.notify_all();
+
+            auto exception = std::exception_ptr();
+            {
+                auto lock = std::unique_lock(_state_lock);
+                _work_done.wait(lock, [&](){ return _n_remaining == 0; });
+                std::swap(exception, _exception);
+            }
+
+            if (exception)
+                std::rethrow_exception(exception);
+        }
+
+        // merge event queues, in order of world index so the result does not depend on scheduling
+        _events.clear();
+        auto event = CollisionEvent();
+        for (size_t i = 0; i < _worlds.size(); ++i)
+            while (_worlds.at(i).world->next_event(&event))
+                _events.push_back({i, event});
+    }
+
+    bool WorldScheduler::try_pop(size_t thread_index, size_t& task)
+    {
+        auto& queue = *_queues.at(thread_index);
+        auto lock = std::lock_guard(queue.lock);
+
+        if (queue.tasks.empty())
+            return false;
+
+        task = queue.tasks.front();
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    bool WorldScheduler::try_steal(size_t thread_index, size_t& task)
+    {
+        for (size_t offset = 1; offset < _queues.size(); ++offset)
+        {
+            auto& queue = *_queues.at((thread_index + offset) % _queues.size());
+            auto lock = std::lock_guard(queue.lock);
+
+            if (queue.tasks.empty())
+                continue;
+
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+            return true;
+        }
+
+        return false;
+    }
+
+    void WorldScheduler::worker_loop(size_t thread_index)
+    {
+        size_t seen_generation = 0;
+        while (true)
+        {
+            {
+                auto lock = std::unique_lock(_state_lock);
+                _work_available.wait(lock, [&](){ return _shutdown or _generation != seen_generation; });
+
+                if (_shutdown)
+                    return;
+
+                seen_generation = _generation;
+            }
+
+            size_t task;
+            while (try_pop(thread_index, task) or try_steal(thread_index, task))
+            {
+                // an exception escaping the thread would terminate, forward it to the caller of step instead
+                try
+                {
+                    run(task);
+                }
+                catch (...)
+                {
+                    auto lock = std::lock_guard(_state_lock);
+                    if (not _exception)
+                        _exception = std::current_exception();
+                }
+
+                if (--_n_remaining == 0)
+                {
+                    auto lock = std::lock_guard(_state_lock);
+                    _work_done.notify_all();
+                }
+            }
+        }
+    }
+}
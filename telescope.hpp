@@ -14,10 +14,19 @@
 #include <include/time.hpp>
 #include <include/common.hpp>
 
+#include <include/audio_device.hpp>
+#include <include/audio_statistics.hpp>
+#include <include/audio_command_queue.hpp>
 #include <include/music.hpp>
 #include <include/music_handler.hpp>
+#include <include/music_playlist.hpp>
 #include <include/sound.hpp>
 #include <include/sound_handler.hpp>
+#include <include/sound_bank.hpp>
+#include <include/sound_cache.hpp>
+#include <include/streaming_sound.hpp>
+#include <include/audio_emitter_system.hpp>
+#include <include/audio_mixer.hpp>
 
 #include <include/key_or_button.hpp>
 #include <include/input_handler.hpp>
@@ -37,14 +46,21 @@
 #include <include/rectangle_shape.hpp>
 #include <include/circle_shape.hpp>
 #include <include/polygon_shape.hpp>
+#include <include/polyline_shape.hpp>
 
 #include <include/physics_world.hpp>
+#include <include/world_scheduler.hpp>
+#include <include/regioned_physics_world.hpp>
 #include <include/collision_shape.hpp>
 #include <include/collision_circle.hpp>
 #include <include/collision_line.hpp>
 #include <include/collision_polygon.hpp>
 #include <include/collision_line_sequence.hpp>
+#include <include/collision_compound.hpp>
+#include <include/collision_shape_pool.hpp>
 #include <include/collision_render_shape.hpp>
+#include <include/physics_debug_draw.hpp>
+#include <include/alpha_contours.hpp>
 
 // do not include unless you know what you're doing:
 
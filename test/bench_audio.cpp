@@ -0,0 +1,270 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+// headless audio benchmarks, runs against SDLs "dummy" audio driver (or "disk", if given), such that no audio device is needed
+// Usage: ./bench_audio [output.json] [driver]
+//
+// every scenario plays a number of looping voices spread across all buses through ts::AudioMixer and reports
+// the time spent in the mixer and the cpu time of the audio thread per audio callback, relative to the duration
+// of audio one callback produces. Each scenario runs with a small and a large buffer. Load times with and without
+// ts::SoundCache are printed, but not written to the json
+
+#include <telescope.hpp>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <cmath>
+#include <filesystem>
+
+using namespace ts;
+
+// ### RESULTS ###
+
+struct BenchmarkResult
+{
+    std::string name;
+    size_t n_voices = 0;
+    size_t chunk_size = 0;
+    size_t n_callbacks = 0;
+    double budget_us = 0;
+    double average_us = 0;
+    double max_us = 0;
+    double thread_cpu_us = 0;
+    size_t n_underruns = 0;
+
+    double load() const
+    {
+        return budget_us > 0 ? average_us / budget_us : 0;
+    }
+};
+
+static std::vector<BenchmarkResult> results;
+
+void report(BenchmarkResult result)
+{
+    std::cout << result.name << ": "
+              << result.n_voices << " voices, "
+              << result.n_callbacks << " callbacks, "
+              << result.average_us << " us avg, "
+              << result.max_us << " us max, "
+              << result.load() * 100 << "% of " << result.budget_us << " us budget, "
+              << result.thread_cpu_us << " us audio thread cpu, "
+              << result.n_underruns << " underruns"
+              << std::endl;
+
+    results.push_back(std::move(result));
+}
+
+bool write_json(const std::string& path)
+{
+    auto out = std::stringstream();
+    out << "{\n  \"benchmarks\": [\n";
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        auto& result = results.at(i);
+        out << "    {\n"
+            << "      \"name\": \"" << result.name << "\",\n"
+            << "      \"n_voices\": " << result.n_voices << ",\n"
+            << "      \"chunk_size\": " << result.chunk_size << ",\n"
+            << "      \"n_callbacks\": " << result.n_callbacks << ",\n"
+            << "      \"budget_us\": " << result.budget_us << ",\n"
+            << "      \"average_us\": " << result.average_us << ",\n"
+            << "      \"max_us\": " << result.max_us << ",\n"
+            << "      \"thread_cpu_us\": " << result.thread_cpu_us << ",\n"
+            << "      \"n_underruns\": " << result.n_underruns << ",\n"
+            << "      \"load\": " << result.load()
+            << "\n    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n}\n";
+
+    auto file = std::ofstream(path);
+    if (not file.is_open())
+    {
+        std::cerr << "[ERROR] unable to write results to " << path << std::endl;
+        return false;
+    }
+
+    file << out.str();
+    return true;
+}
+
+// ### SCENARIOS ###
+
+// write one second of a sine as 16-bit stereo wav, such that the benchmark does not depend on any asset
+std::string write_sine(const std::string& name, size_t frequency, float hz)
+{
+    auto samples = std::vector<int16_t>(2 * frequency);
+    for (size_t i = 0; i < frequency; ++i)
+    {
+        auto value = int16_t(std::sin(2 * 3.14159265358979 * hz * i / frequency) * 8000);
+        samples[2 * i] = value;
+        samples[2 * i + 1] = value;
+    }
+
+    auto path = (std::filesystem::temp_directory_path() / name).string();
+    auto file = std::ofstream(path, std::ios::binary);
+
+    auto write = [&](auto value, size_t n_bytes) {
+        file.write(reinterpret_cast<const char*>(&value), n_bytes);
+    };
+
+    uint32_t n_bytes = samples.size() * sizeof(int16_t);
+    file.write("RIFF", 4);
+    write(uint32_t(36 + n_bytes), 4);
+    file.write("WAVEfmt ", 8);
+    write(uint32_t(16), 4);
+    write(uint16_t(1), 2);                      // pcm
+    write(uint16_t(2), 2);                      // channels
+    write(uint32_t(frequency), 4);
+    write(uint32_t(frequency * 2 * sizeof(int16_t)), 4);
+    write(uint16_t(2 * sizeof(int16_t)), 2);
+    write(uint16_t(16), 2);
+    file.write("data", 4);
+    write(n_bytes, 4);
+    file.write(reinterpret_cast<const char*>(samples.data()), n_bytes);
+
+    return path;
+}
+
+void bench_mixer(size_t n_voices, std::vector<Sound*>& sounds, Time duration)
+{
+    auto result = BenchmarkResult();
+    result.n_voices = n_voices;
+    result.chunk_size = AudioDevice::get_config().chunk_size;
+    result.name = "mixer_" + std::to_string(n_voices) + "_" + std::to_string(result.chunk_size);
+
+    for (size_t i = 0; i < n_voices; ++i)
+    {
+        auto channel = i % SoundHandler::n_channels;
+        SoundHandler::play(channel, *sounds.at(i % sounds.size()), -1);
+        SoundHandler::set_panning(channel, degrees((i * 37) % 360));
+    }
+
+    flush_audio_commands();
+    AudioMixer::reset_callback_statistics();
+    AudioDevice::reset_callback_statistics();
+    AudioStatistics::reset();
+
+    auto clock = Clock();
+    while (clock.elapsed().as_seconds() < duration.as_seconds())
+    {
+        // a ramp every frame, as if ducking
+        float volume = 0.5 + 0.5 * std::sin(clock.elapsed().as_seconds() * 4);
+        AudioMixer::set_bus_volume(AudioBus::AMBIENCE, volume);
+
+        flush_audio_commands();
+        AudioStatistics::update();
+        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+    }
+
+    result.n_callbacks = AudioMixer::get_n_callbacks();
+    result.budget_us = AudioMixer::get_callback_budget().as_microseconds();
+    result.average_us = AudioMixer::get_average_callback_duration().as_microseconds();
+    result.max_us = AudioMixer::get_max_callback_duration().as_microseconds();
+    result.thread_cpu_us = AudioDevice::get_average_callback_cpu_time().as_microseconds();
+    result.n_underruns = AudioStatistics::get_n_underruns();
+
+    for (size_t i = 0; i < n_voices; ++i)
+        SoundHandler::force_stop(i % SoundHandler::n_channels);
+
+    flush_audio_commands();
+    report(result);
+}
+
+// load the same sounds with an empty and a filled ts::SoundCache, a wav only has to be converted, so the difference
+// is larger for compressed files
+void bench_sound_cache(const std::vector<std::string>& paths, size_t n_repeats)
+{
+    auto directory = (std::filesystem::temp_directory_path() / "bench_audio_cache").string();
+    SoundCache::enable(directory);
+    SoundCache::clear();
+
+    for (bool is_warm : {false, true})
+    {
+        SoundCache::reset_statistics();
+        for (size_t i = 0; i < n_repeats; ++i)
+        {
+            if (not is_warm)
+                SoundCache::clear();
+
+            for (auto& path : paths)
+                auto sound = Sound(path);
+        }
+
+        std::cout << (is_warm ? "sound_cache_hit: " : "sound_cache_miss: ")
+                  << SoundCache::get_n_hits() << " hits, "
+                  << SoundCache::get_n_misses() << " misses, "
+                  << SoundCache::get_total_load_time().as_microseconds() / (n_repeats * paths.size()) << " us avg per load"
+                  << std::endl;
+    }
+
+    SoundCache::clear();
+    SoundCache::disable();
+}
+
+int main(int argc, char** argv)
+{
+    auto output_path = std::string(argc > 1 ? argv[1] : "bench_audio.json");
+    auto driver = std::string(argc > 2 ? argv[2] : "dummy");
+
+    SDL_setenv("SDL_AUDIODRIVER", driver.c_str(), 1);
+
+    auto config = AudioConfig();
+    config.chunk_size = 1024;
+
+    if (SDL_Init(SDL_INIT_AUDIO) != 0 or not AudioDevice::open(config))
+    {
+        std::cerr << "[ERROR] unable to open audio driver " << driver << ": " << SDL_GetError() << std::endl;
+        return 1;
+    }
+
+    auto paths = std::vector<std::string>{
+        write_sine("bench_audio_sfx.wav", MusicHandler::sample_rate, 440),
+        write_sine("bench_audio_ui.wav", MusicHandler::sample_rate, 880),
+        write_sine("bench_audio_ambience.wav", MusicHandler::sample_rate, 110)
+    };
+
+    bench_sound_cache(paths, 32);
+
+    auto sfx = Sound(paths.at(0));
+    auto ui = Sound(paths.at(1));
+    auto ambience = Sound(paths.at(2));
+    auto sounds = std::vector<Sound*>{&sfx, &ui, &ambience};
+
+    AudioMixer::set_bus(ui, AudioBus::UI);
+    AudioMixer::set_bus(ambience, AudioBus::AMBIENCE);
+    AudioMixer::enable();
+    AudioMixer::set_bus_low_pass(AudioBus::AMBIENCE, 800);
+    flush_audio_commands();
+
+    for (size_t chunk_size : {256, 1024})
+    {
+        // reloads all sounds, such that the buffer size can change at runtime
+        config.chunk_size = chunk_size;
+        AudioDevice::reopen(config);
+
+        for (size_t n : {16, 64, 256})
+            bench_mixer(n, sounds, seconds(2));
+    }
+
+    AudioMixer::disable();
+    flush_audio_commands();
+
+    for (auto* sound : sounds)
+        sound->unload();
+
+    Mix_CloseAudio();
+    SDL_Quit();
+
+    return write_json(output_path) ? 0 : 1;
+}
@@ -0,0 +1,816 @@
+//
+// Copyright 2022 Joshua Higginbotham
+// Created on 10/18/26 by clem (mail@clemens-cords.com | https://github.com/Clemapfel)
+//
+
+// headless physics benchmarks, does not need a window or an audio device
+// Usage: ./bench_physics [output.json]
+//
+// every scenario reports steps per second, nanoseconds per body and step and the number of heap allocations
+// during the timed section. Results are written as json (default: ./bench_physics.json) such that they can be
+// compared across releases. Only allocations through operator new are counted, box2d allocates through malloc
+
+#include <telescope.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <random>
+#include <atomic>
+#include <cmath>
+#include <new>
+#include <cstdlib>
+
+using namespace ts;
+
+// ### ALLOCATION COUNTING ###
+
+static std::atomic<size_t> n_allocations = 0;
+static std::atomic<size_t> n_bytes_allocated = 0;
+
+void* operator new(size_t size)
+{
+    n_allocations += 1;
+    n_bytes_allocated += size;
+
+    if (void* out = std::malloc(size == 0 ? 1 : size))
+        return out;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+// ### RESULTS ###
+
+struct BenchmarkResult
+{
+    std::string name;
+    size_t n_bodies = 0;
+    size_t n_steps = 0;
+    double seconds = 0;
+    size_t n_allocations = 0;
+    size_t n_bytes_allocated = 0;
+
+    // scenario-specific values, e.g. rays per second
+    std::vector<std::pair<std::string, double>> extra;
+
+    double steps_per_second() const
+    {
+        return seconds > 0 ? n_steps / seconds : 0;
+    }
+
+    double ns_per_body() const
+    {
+        return n_steps * n_bodies > 0 ? (seconds * 1e9) / (n_steps * n_bodies) : 0;
+    }
+};
+
+static std::vector<BenchmarkResult> results;
+
+void report(BenchmarkResult result)
+{
+    std::cout << result.name << ": "
+              << result.n_bodies << " bodies, "
+              << result.steps_per_second() << " steps/s, "
+              << result.ns_per_body() << " ns/body, "
+              << result.n_allocations << " allocations";
+
+    for (auto& pair : result.extra)
+        std::cout << ", " << pair.first << " " << pair.second;
+
+    std::cout << std::endl;
+    results.push_back(std::move(result));
+}
+
+bool write_json(const std::string& path)
+{
+    auto out = std::stringstream();
+    out << "{\n  \"benchmarks\": [\n";
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        auto& result = results.at(i);
+        out << "    {\n"
+            << "      \"name\": \"" << result.name << "\",\n"
+            << "      \"n_bodies\": " << result.n_bodies << ",\n"
+            << "      \"n_steps\": " << result.n_steps << ",\n"
+            << "      \"seconds\": " << result.seconds << ",\n"
+            << "      \"steps_per_second\": " << result.steps_per_second() << ",\n"
+            << "      \"ns_per_body\": " << result.ns_per_body() << ",\n"
+            << "      \"n_allocations\": " << result.n_allocations << ",\n"
+            << "      \"n_bytes_allocated\": " << result.n_bytes_allocated;
+
+        for (auto& pair : result.extra)
+            out << ",\n      \"" << pair.first << "\": " << pair.second;
+
+        out << "\n    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n}\n";
+
+    auto file = std::ofstream(path);
+    if (not file.is_open())
+    {
+        std::cerr << "[ERROR] unable to write results to " << path << std::endl;
+        return false;
+    }
+
+    file << out.str();
+    return true;
+}
+
+// ### HELPERS ###
+
+using ShapeList = std::vector<std::unique_ptr<CollisionShape>>;
+    // sic, shapes are heap-allocated because box2d stores pointers to them
+
+static const Time timestep = seconds(1 / 60.f);
+
+// fixed seed, such that every run simulates the exact same scene
+float rng()
+{
+    static auto distribution = std::uniform_real_distribution<float>(0, 1);
+    static auto engine = std::mt19937(1234);
+    return distribution(engine);
+}
+
+std::vector<Vector2f> generate_polygon_vertices(Vector2f center, float radius, size_t n_vertices)
+{
+    auto out = std::vector<Vector2f>();
+    for (size_t i = 0; i < n_vertices; ++i)
+    {
+        auto angle = degrees(i * (360.f / n_vertices));
+        out.emplace_back(center.x + std::cos(angle.as_radians()) * radius, center.y + std::sin(angle.as_radians()) * radius);
+    }
+    return out;
+}
+
+// step the world n times, measuring time and allocations of the stepping only
+BenchmarkResult measure_steps(const std::string& name, PhysicsWorld& world, size_t n_steps, const std::function<void(size_t)>& before_step = {})
+{
+    auto out = BenchmarkResult();
+    out.name = name;
+    out.n_bodies = world.get_native()->GetBodyCount();
+    out.n_steps = n_steps;
+
+    size_t allocations_before = n_allocations;
+    size_t bytes_before = n_bytes_allocated;
+
+    auto clock = Clock();
+    for (size_t i = 0; i < n_steps; ++i)
+    {
+        if (before_step)
+            before_step(i);
+
+        world.step(timestep);
+    }
+    out.seconds = clock.elapsed().as_seconds();
+
+    out.n_allocations = n_allocations - allocations_before;
+    out.n_bytes_allocated = n_bytes_allocated - bytes_before;
+    return out;
+}
+
+// spawn n dynamic circles in a grid above a static floor
+void create_circle_pile(PhysicsWorld& world, ShapeList& shapes, size_t n, float radius = 2)
+{
+    size_t n_columns = std::ceil(std::sqrt(float(n)));
+    float width = n_columns * radius * 2.5;
+
+    shapes.push_back(std::make_unique<CollisionPolygon>(&world, ts::STATIC, Rectangle{{-width, 0}, {3 * width, 10}}));
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto x = (i % n_columns) * radius * 2.5f + (i / n_columns % 2) * radius * 0.5f;
+        auto y = -10.f - (i / n_columns) * radius * 2.5f;
+        shapes.push_back(std::make_unique<CollisionCircle>(&world, ts::DYNAMIC, Vector2f(x, y), radius));
+    }
+}
+
+std::vector<Vector2f> get_positions(ShapeList& shapes)
+{
+    std::vector<Vector2f> out;
+    out.reserve(shapes.size());
+    for (auto& shape : shapes)
+    {
+        auto position = shape->get_native_body()->GetPosition();
+        out.emplace_back(position.x, position.y);
+    }
+    return out;
+}
+
+float max_deviation(const std::vector<Vector2f>& a, const std::vector<Vector2f>& b)
+{
+    float out = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+        out = std::max(out, glm::distance(a.at(i), b.at(i)));
+    return out;
+}
+
+// ### SCENARIOS ###
+
+// boxes stacked into a pyramid, stresses the solver with many persistent contacts
+void bench_pyramid(size_t n_rows, size_t n_steps)
+{
+    auto world = PhysicsWorld();
+    world.set_gravity(Vector2f(0, 100));
+
+    const float size = 10;
+    auto shapes = ShapeList();
+    shapes.push_back(std::make_unique<CollisionPolygon>(&world, ts::STATIC, Rectangle{{-size * n_rows, 0}, {size * n_rows * 3, size}}));
+
+    for (size_t row = 0; row < n_rows; ++row)
+    {
+        size_t n_boxes = n_rows - row;
+        float offset = row * size * 0.5f;
+        for (size_t i = 0; i < n_boxes; ++i)
+        {
+            auto top_left = Vector2f(offset + i * size, -(row + 1.f) * size);
+            shapes.push_back(std::make_unique<CollisionPolygon>(&world, ts::DYNAMIC, Rectangle{top_left, {size, size}}));
+        }
+    }
+
+    report(measure_steps("pyramid_" + std::to_string(n_rows), world, n_steps));
+}
+
+// many circles falling onto a floor, stresses the broadphase and contact creation
+void bench_circle_pile(size_t n_bodies, size_t n_steps)
+{
+    auto world = PhysicsWorld();
+    world.set_gravity(Vector2f(0, 100));
+
+    auto shapes = ShapeList();
+    create_circle_pile(world, shapes, n_bodies);
+
+    report(measure_steps("circle_pile_" + std::to_string(n_bodies), world, n_steps));
+}
+
+// the scene of test/example.cpp: polygons inside a box, stirred by a rotating kinematic line and spike
+void bench_kinematic_wheel(size_t n_polygons, size_t n_steps)
+{
+    auto world = PhysicsWorld();
+    world.set_gravity(Vector2f(0, 100));
+
+    const auto size = Vector2f(800, 600);
+    const auto center = size / Vector2f(2, 2);
+    const float frame = 100;
+
+    auto shapes = ShapeList();
+    shapes.push_back(std::make_unique<CollisionLineSequence>(&world, ts::STATIC, std::vector<Vector2f>{
+        Vector2f(1, 0),
+        Vector2f(size.x, 0),
+        Vector2f(size.x, size.y - 1),
+        Vector2f(1, size.y - 1),
+        Vector2f(1, 0)
+    }));
+
+    auto* line = shapes.emplace_back(std::make_unique<CollisionLine>(&world, ts::KINEMATIC, Vector2f(0, center.y), Vector2f(size.x, center.y))).get();
+    auto* spike = shapes.emplace_back(std::make_unique<CollisionLineSequence>(&world, ts::KINEMATIC, std::vector<Vector2f>{
+        center + Vector2f(-frame, 0),
+        center + Vector2f(0, -2 * frame),
+        center + Vector2f(+frame, 0),
+        center + Vector2f(0, +2 * frame),
+        center + Vector2f(-frame, 0)
+    })).get();
+
+    line->set_angular_velocity(1);
+    spike->set_angular_velocity(1);
+
+    for (size_t i = 0; i < n_polygons; ++i)
+    {
+        auto position = Vector2f(rng() * size.x, rng() > 0.5 ? rng() * frame : size.y - frame + rng() * frame);
+        auto vertices = generate_polygon_vertices(position, std::max<float>(rng(), 0.5) * 20, std::max<size_t>(3, std::round(rng() * 6)));
+        shapes.push_back(std::make_unique<CollisionPolygon>(&world, ts::DYNAMIC, vertices));
+    }
+
+    report(measure_steps("kinematic_wheel_" + std::to_string(n_polygons), world, n_steps));
+}
+
+// rolling terrain made of a single line sequence, with dynamic polygons raining onto it
+void bench_terrain(size_t n_terrain_vertices, size_t n_polygons, size_t n_steps)
+{
+    auto world = PhysicsWorld();
+    world.set_gravity(Vector2f(0, 100));
+
+    const float spacing = 5;
+    auto terrain = std::vector<Vector2f>();
+    for (size_t i = 0; i < n_terrain_vertices; ++i)
+    {
+        float x = i * spacing;
+        terrain.emplace_back(x, 50 * std::sin(x / 200.f) + 20 * std::sin(x / 37.f));
+    }
+
+    auto shapes = ShapeList();
+    shapes.push_back(std::make_unique<CollisionLineSequence>(&world, ts::STATIC, terrain));
+
+    const float width = n_terrain_vertices * spacing;
+    for (size_t i = 0; i < n_polygons; ++i)
+    {
+        auto position = Vector2f(rng() * width, -100 - rng() * 1000);
+        auto vertices = generate_polygon_vertices(position, 4 + rng() * 6, 3 + (i % 6));
+        shapes.push_back(std::make_unique<CollisionPolygon>(&world, ts::DYNAMIC, vertices));
+    }
+
+    report(measure_steps("terrain_" + std::to_string(n_polygons), world, n_steps));
+}
+
+// traced, noisy terrain as two-sided edges vs. simplified into a single one-sided chain
+void bench_terrain_simplification(size_t n_terrain_vertices, size_t n_polygons, size_t n_steps)
+{
+    const float spacing = 2;
+    auto terrain = std::vector<Vector2f>();
+    for (size_t i = 0; i < n_terrain_vertices; ++i)
+    {
+        float x = i * spacing;
+        terrain.emplace_back(x, 50 * std::sin(x / 200.f) + 20 * std::sin(x / 37.f) + 0.25f * rng());
+    }
+
+    const float width = n_terrain_vertices * spacing;
+    auto polygons = std::vector<std::vector<Vector2f>>();
+    for (size_t i = 0; i < n_polygons; ++i)
+        polygons.push_back(generate_polygon_vertices(Vector2f(rng() * width, -100 - rng() * 1000), 4 + rng() * 6, 3 + (i % 6)));
+
+    auto run = [&](const std::string& name, bool two_sided, float tolerance) {
+        auto world = PhysicsWorld();
+        world.set_gravity(Vector2f(0, 100));
+
+        auto shapes = ShapeList();
+        auto* sequence = new CollisionLineSequence(&world, ts::STATIC, terrain, two_sided, tolerance);
+        shapes.emplace_back(sequence);
+
+        for (auto& vertices : polygons)
+            shapes.push_back(std::make_unique<CollisionPolygon>(&world, ts::DYNAMIC, vertices));
+
+        auto result = measure_steps(name, world, n_steps);
+        result.extra.push_back({"n_edges", double(sequence->get_n_edges())});
+        result.extra.push_back({"n_proxies", double(world.get_native()->GetProxyCount())});
+        report(result);
+    };
+
+    run("terrain_edges_" + std::to_string(n_terrain_vertices), true, 0);
+    run("terrain_simplified_chain_" + std::to_string(n_terrain_vertices), false, 1);
+}
+
+// many rays per step cast at random shapes of a resting pile
+void bench_ray_cast_storm(size_t n_bodies, size_t n_rays_per_step, size_t n_steps)
+{
+    auto world = PhysicsWorld();
+    world.set_gravity(Vector2f(0, 100));
+
+    auto shapes = ShapeList();
+    create_circle_pile(world, shapes, n_bodies);
+
+    // precompute rays, such that only the casting itself is measured
+    struct Ray
+    {
+        CollisionShape* target;
+        Vector2f from, to;
+    };
+
+    auto rays = std::vector<Ray>();
+    rays.reserve(n_rays_per_step);
+    for (size_t i = 0; i < n_rays_per_step; ++i)
+    {
+        auto* target = shapes.at(1 + size_t(rng() * (shapes.size() - 2))).get();
+        auto from = Vector2f(rng() * 1000 - 500, -1000);
+        rays.push_back({target, from, from + Vector2f(rng() * 200 - 100, 2000)});
+    }
+
+    size_t n_hits = 0;
+    auto result = measure_steps("ray_cast_storm_" + std::to_string(n_rays_per_step), world, n_steps, [&](size_t) {
+        for (auto& ray : rays)
+            n_hits += world.ray_cast(ray.target, ray.from, ray.to).are_colliding;
+    });
+
+    result.extra.push_back({"rays_per_second", (n_rays_per_step * n_steps) / result.seconds});
+    result.extra.push_back({"hit_ratio", double(n_hits) / (n_rays_per_step * n_steps)});
+    report(result);
+}
+
+// render sync of a mostly idle scene, updating every render shape vs. only those whose body was awake
+void bench_render_sync(size_t n_idle, size_t n_active, size_t n_steps)
+{
+    auto world = PhysicsWorld();
+
+    auto shapes = std::vector<std::unique_ptr<CollisionCircleShape>>();
+    shapes.reserve(n_idle + n_active);
+
+    size_t n_columns = std::ceil(std::sqrt(float(n_idle + n_active)));
+    for (size_t i = 0; i < n_idle + n_active; ++i)
+    {
+        auto position = Vector2f((i % n_columns) * 10, (i / n_columns) * 10);
+        shapes.push_back(std::make_unique<CollisionCircleShape>(&world, ts::DYNAMIC, position, 2));
+
+        if (i < n_active)
+            shapes.back()->set_linear_velocity(Vector2f(rng() * 10 - 5, rng() * 10 - 5));
+    }
+
+    // wait for the idle bodies to fall asleep
+    for (size_t i = 0; i < 60; ++i)
+        world.step(timestep);
+
+    auto result_all = measure_steps("render_sync_all_" + std::to_string(n_idle + n_active), world, n_steps, [&](size_t) {
+        for (auto& shape : shapes)
+            shape->update();
+    });
+    report(result_all);
+
+    auto result_awake = measure_steps("render_sync_awake_" + std::to_string(n_idle + n_active), world, n_steps, [&](size_t) {
+        CollisionRenderShape::update_awake(&world);
+    });
+    result_awake.extra.push_back({"n_awake_shapes", double(world.get_awake_shapes().size())});
+    report(result_awake);
+}
+
+// collecting the debug overlay of a large world, with and without culling
+void bench_debug_draw(size_t n_bodies, size_t n_steps)
+{
+    auto world = PhysicsWorld();
+    world.set_gravity(Vector2f(0, 100));
+
+    auto shapes = ShapeList();
+    create_circle_pile(world, shapes, n_bodies);
+
+    auto debug_draw = PhysicsDebugDraw(&world, PhysicsDebugDraw::SHAPES | PhysicsDebugDraw::CONTACTS);
+
+    for (bool culled : {false, true})
+    {
+        if (culled)
+            debug_draw.set_culling_area(Rectangle{{0, -400}, {800, 600}});
+
+        auto update_time = 0.0;
+        auto result = measure_steps(std::string("debug_draw_") + (culled ? "culled_" : "") + std::to_string(n_bodies), world, n_steps, [&](size_t) {
+            auto clock = Clock();
+            debug_draw.update();
+            update_time += clock.elapsed().as_seconds();
+        });
+
+        result.extra.push_back({"update_ms", (update_time / n_steps) * 1000});
+        result.extra.push_back({"n_vertices", double(debug_draw.get_n_vertices())});
+        result.extra.push_back({"n_triangles", double(debug_draw.get_n_triangles())});
+        report(result);
+    }
+}
+
+// the same scattered bodies in a single world vs. a regioned world where only the regions around one anchor are stepped
+void bench_regioned_world(size_t n_regions_per_axis, size_t n_bodies_per_region, size_t n_steps)
+{
+    const float region_size = 2048;
+    const size_t n_bodies = n_regions_per_axis * n_regions_per_axis * n_bodies_per_region;
+
+    auto positions = std::vector<Vector2f>();
+    positions.reserve(n_bodies);
+    for (size_t i = 0; i < n_bodies; ++i)
+        positions.emplace_back(rng() * region_size * n_regions_per_axis, rng() * region_size * n_regions_per_axis);
+
+    {
+        auto world = PhysicsWorld();
+        auto shapes = ShapeList();
+        for (auto& position : positions)
+        {
+            shapes.push_back(std::make_unique<CollisionCircle>(&world, ts::DYNAMIC, position, 4));
+            shapes.back()->set_linear_velocity(Vector2f(rng() * 200 - 100, rng() * 200 - 100));
+        }
+
+        report(measure_steps("regioned_world_single_" + std::to_string(n_bodies), world, n_steps));
+    }
+
+    auto world = RegionedPhysicsWorld(region_size, 1);
+    auto shapes = ShapeList();
+    for (auto& position : positions)
+    {
+        shapes.push_back(std::make_unique<CollisionCircle>(world.get_region_at(position), ts::DYNAMIC, position, 4));
+        shapes.back()->set_linear_velocity(Vector2f(rng() * 200 - 100, rng() * 200 - 100));
+    }
+
+    world.add_anchor(Vector2f(region_size / 2, region_size / 2));
+
+    auto result = BenchmarkResult();
+    result.name = "regioned_world_" + std::to_string(n_bodies);
+    result.n_bodies = n_bodies;
+    result.n_steps = n_steps;
+
+    size_t allocations_before = n_allocations;
+    size_t bytes_before = n_bytes_allocated;
+    size_t n_handoffs = 0;
+
+    auto clock = Clock();
+    for (size_t i = 0; i < n_steps; ++i)
+    {
+        world.step(timestep);
+        n_handoffs += world.get_n_handoffs();
+    }
+    result.seconds = clock.elapsed().as_seconds();
+    result.n_allocations = n_allocations - allocations_before;
+    result.n_bytes_allocated = n_bytes_allocated - bytes_before;
+
+    result.extra.push_back({"n_active_bodies", double(world.get_n_active_bodies())});
+    result.extra.push_back({"n_frozen_bodies", double(world.get_n_frozen_bodies())});
+    result.extra.push_back({"n_handoffs", double(n_handoffs)});
+    report(result);
+}
+
+// many trigger zones with bodies moving through them
+void bench_triggers(size_t n_triggers, size_t n_bodies, size_t n_steps)
+{
+    auto world = PhysicsWorld();
+    auto shapes = ShapeList();
+
+    const float area = 4000;
+    for (size_t i = 0; i < n_triggers; ++i)
+    {
+        auto position = Vector2f(rng() * area, rng() * area);
+        shapes.push_back(std::make_unique<CollisionPolygon>(&world, ts::STATIC, Rectangle{position, {100, 100}}));
+        world.add_trigger(shapes.back().get());
+    }
+
+    for (size_t i = 0; i < n_bodies; ++i)
+    {
+        shapes.push_back(std::make_unique<CollisionCircle>(&world, ts::DYNAMIC, Vector2f(rng() * area, rng() * area), 4));
+        shapes.back()->set_linear_velocity(Vector2f(rng() * 400 - 200, rng() * 400 - 200));
+        shapes.back()->set_collision_filter({CollisionFilterGroup::_02}, {CollisionFilterGroup::_02}); // bodies pass through each other, such that only trigger contacts remain
+    }
+
+    size_t n_entered = 0;
+    size_t n_exited = 0;
+    auto result = measure_steps("triggers_" + std::to_string(n_triggers) + "_" + std::to_string(n_bodies), world, n_steps, [&](size_t) {
+        for (auto* trigger : world.get_changed_triggers())
+        {
+            n_entered += world.get_trigger_entered(trigger).size();
+            n_exited += world.get_trigger_exited(trigger).size();
+        }
+    });
+
+    result.extra.push_back({"n_entered", double(n_entered)});
+    result.extra.push_back({"n_exited", double(n_exited)});
+    report(result);
+}
+
+// snapshot / restore latency
+void bench_snapshot(size_t n_bodies)
+{
+    auto world = PhysicsWorld();
+    world.set_gravity(Vector2f(0, 100));
+
+    auto shapes = ShapeList();
+    create_circle_pile(world, shapes, n_bodies);
+
+    // settle, such that there are contacts to save
+    for (size_t i = 0; i < 30; ++i)
+        world.step(timestep);
+
+    auto buffer = std::vector<uint8_t>();
+    size_t n_bytes = world.snapshot(buffer);
+
+    const size_t n_iterations = std::max<size_t>(10, 1000000 / n_bodies);
+
+    auto result = BenchmarkResult();
+    result.name = "snapshot_" + std::to_string(n_bodies);
+    result.n_bodies = n_bodies;
+    result.n_steps = n_iterations;
+
+    size_t allocations_before = n_allocations;
+    auto clock = Clock();
+    for (size_t i = 0; i < n_iterations; ++i)
+        world.snapshot(buffer);
+    result.seconds = clock.restart().as_seconds();
+
+    for (size_t i = 0; i < n_iterations; ++i)
+        world.restore(buffer);
+    auto restore_seconds = clock.restart().as_seconds();
+    result.n_allocations = n_allocations - allocations_before;
+
+    result.extra.push_back({"snapshot_bytes", double(n_bytes)});
+    result.extra.push_back({"snapshot_us", result.seconds * 1e6 / n_iterations});
+    result.extra.push_back({"restore_us", restore_seconds * 1e6 / n_iterations});
+    report(result);
+}
+
+// per-phase step timings, averaged over the profile window
+void bench_step_profile(size_t n_bodies)
+{
+    auto world = PhysicsWorld();
+    world.set_gravity(Vector2f(0, 100));
+
+    auto shapes = ShapeList();
+    create_circle_pile(world, shapes, n_bodies);
+
+    const size_t n_steps = 120;
+    world.set_profile_window_size(n_steps);
+
+    auto result = measure_steps("step_profile_" + std::to_string(n_bodies), world, n_steps);
+
+    auto average = world.get_average_step_profile();
+    auto max = world.get_max_step_profile();
+
+    result.extra.push_back({"collide_us", average.collide.as_microseconds()});
+    result.extra.push_back({"solve_us", average.solve.as_microseconds()});
+    result.extra.push_back({"solve_toi_us", average.solve_toi.as_microseconds()});
+    result.extra.push_back({"broadphase_us", average.broadphase.as_microseconds()});
+    result.extra.push_back({"contact_listener_us", average.contact_listener.as_microseconds()});
+    result.extra.push_back({"max_step_us", max.step.as_microseconds()});
+    result.extra.push_back({"n_awake_bodies", double(average.n_awake_bodies)});
+    result.extra.push_back({"n_contacts", double(average.n_contacts)});
+    report(result);
+}
+
+// spawn and despawn projectiles every step, pooled vs. allocating a new body each time
+void bench_shape_pool(size_t n_per_step, size_t n_steps)
+{
+    auto world = PhysicsWorld();
+
+    {
+        auto live = ShapeList();
+        auto result = measure_steps("spawn_allocating_" + std::to_string(n_per_step), world, n_steps, [&](size_t) {
+            for (auto& shape : live)
+                shape->destroy();
+
+            live.clear();
+            for (size_t i = 0; i < n_per_step; ++i)
+                live.push_back(std::make_unique<CollisionCircle>(&world, ts::DYNAMIC, Vector2f(i * 10, 0), 2));
+        });
+        result.n_bodies = n_per_step;
+        report(result);
+
+        for (auto& shape : live)
+            shape->destroy();
+    }
+
+    {
+        auto pool = CollisionShapePool<CollisionCircle>(&world, [](PhysicsWorld* world) {
+            return std::make_unique<CollisionCircle>(world, ts::DYNAMIC, Vector2f(0, 0), 2);
+        });
+        pool.reserve(n_per_step);
+
+        auto live = std::vector<CollisionShapeHandle>();
+        live.reserve(n_per_step);
+
+        auto result = measure_steps("spawn_pooled_" + std::to_string(n_per_step), world, n_steps, [&](size_t) {
+            for (auto handle : live)
+                pool.release(handle);
+
+            live.clear();
+            for (size_t i = 0; i < n_per_step; ++i)
+                live.push_back(pool.acquire(Vector2f(i * 10, 0)));
+        });
+        result.n_bodies = n_per_step;
+
+        for (auto handle : live)
+            pool.release(handle);
+
+        result.extra.push_back({"n_leaked", double(pool.get_n_leaked())});
+        report(result);
+    }
+}
+
+// level loading, constructing each polygon individually vs. creating them in bulk
+void bench_bulk_creation(size_t n_polygons)
+{
+    auto descriptions = std::vector<CollisionPolygonDescription>();
+    auto vertices = std::vector<std::vector<Vector2f>>();
+    auto rectangles = std::vector<Rectangle>();
+
+    for (size_t i = 0; i < n_polygons; ++i)
+    {
+        auto center = Vector2f(rng() * 100000, rng() * 100000);
+        auto& polygon = vertices.emplace_back(generate_polygon_vertices(center, 5 + rng() * 20, 3 + i % 6));
+
+        auto& description = descriptions.emplace_back();
+        description.n_vertices = polygon.size();
+        std::copy(polygon.begin(), polygon.end(), description.vertices.begin());
+
+        rectangles.push_back(Rectangle{center, Vector2f(5 + rng() * 20, 5 + rng() * 20)});
+    }
+
+    using PolygonList = std::vector<std::unique_ptr<CollisionPolygon>>;
+
+    // shapes are kept alive until after the timed section, such that only creation is measured
+    auto measure = [&](const std::string& name, const std::function<void(PhysicsWorld&, PolygonList&, CollisionPolygonBatch&)>& create)
+    {
+        auto world = PhysicsWorld();
+        auto shapes = PolygonList();
+        auto batch = CollisionPolygonBatch();
+
+        auto result = BenchmarkResult();
+        result.name = name + "_" + std::to_string(n_polygons);
+        result.n_bodies = n_polygons;
+        result.n_steps = 1;
+
+        size_t allocations_before = n_allocations;
+        size_t bytes_before = n_bytes_allocated;
+
+        auto clock = Clock();
+        create(world, shapes, batch);
+        result.seconds = clock.elapsed().as_seconds();
+
+        result.n_allocations = n_allocations - allocations_before;
+        result.n_bytes_allocated = n_bytes_allocated - bytes_before;
+        result.extra.push_back({"load_ms", result.seconds * 1e3});
+        report(result);
+    };
+
+    measure("create_individual", [&](PhysicsWorld& world, PolygonList& shapes, CollisionPolygonBatch&) {
+        for (auto& polygon : vertices)
+            shapes.push_back(std::make_unique<CollisionPolygon>(&world, ts::STATIC, polygon));
+    });
+
+    measure("create_bulk", [&](PhysicsWorld& world, PolygonList&, CollisionPolygonBatch& batch) {
+        batch = world.create_polygons(ts::STATIC, descriptions);
+    });
+
+    measure("create_individual_rectangles", [&](PhysicsWorld& world, PolygonList& shapes, CollisionPolygonBatch&) {
+        for (auto& rectangle : rectangles)
+            shapes.push_back(std::make_unique<CollisionPolygon>(&world, ts::STATIC, rectangle));
+    });
+
+    measure("create_bulk_rectangles", [&](PhysicsWorld& world, PolygonList&, CollisionPolygonBatch& batch) {
+        batch = world.create_polygons(ts::STATIC, rectangles);
+    });
+}
+
+// restoring a snapshot has to reproduce the body state exactly. Whether the trajectories afterwards match is reported,
+// but not checked, box2d keeps state that is not part of the snapshot, c.f. ts::PhysicsWorld::restore
+bool check_snapshot_restore(size_t n_bodies, size_t n_steps)
+{
+    auto world = PhysicsWorld();
+    world.set_gravity(Vector2f(0, 100));
+
+    auto shapes = ShapeList();
+    create_circle_pile(world, shapes, n_bodies);
+
+    for (size_t i = 0; i < 30; ++i)
+        world.step(timestep);
+
+    auto buffer = std::vector<uint8_t>();
+    world.snapshot(buffer);
+    auto snapshot_positions = get_positions(shapes);
+
+    auto run = [&]() -> std::vector<Vector2f> {
+        for (size_t i = 0; i < n_steps; ++i)
+            world.step(timestep);
+        return get_positions(shapes);
+    };
+
+    auto original = run();
+
+    world.restore(buffer);
+    auto restored_positions = get_positions(shapes);
+    auto first = run();
+
+    world.restore(buffer);
+    auto second = run();
+
+    auto deviation_state = max_deviation(snapshot_positions, restored_positions);
+    auto deviation_original = max_deviation(original, first);
+    auto deviation_restored = max_deviation(first, second);
+
+    bool passed = deviation_state == 0;
+    std::cout << "snapshot restore @ " << n_bodies << " bodies, " << n_steps << " steps: "
+              << "max deviation of restored state " << deviation_state << " "
+              << (passed ? "[PASSED]" : "[FAILED]") << ", "
+              << "after stepping: original/restored " << deviation_original << ", "
+              << "restored/restored " << deviation_restored << " (not checked)" << std::endl;
+
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    auto output_path = std::string(argc > 1 ? argv[1] : "bench_physics.json");
+    bool passed = true;
+
+    bench_pyramid(40, 600);
+    bench_circle_pile(10000, 300);
+    bench_kinematic_wheel(200, 600);
+    bench_terrain(4000, 2000, 600);
+    bench_terrain_simplification(20000, 500, 300);
+    bench_ray_cast_storm(1000, 10000, 60);
+    bench_render_sync(49000, 1000, 120);
+    bench_debug_draw(50000, 60);
+    bench_regioned_world(8, 1000, 120);
+    bench_triggers(1000, 20000, 120);
+
+    for (size_t n : {1000, 10000, 100000})
+        bench_snapshot(n);
+
+    for (size_t n : {1000, 10000})
+        bench_step_profile(n);
+
+    bench_shape_pool(1000, 120);
+    bench_bulk_creation(50000);
+
+    passed = check_snapshot_restore(1000, 60) and passed;
+    passed = write_json(output_path) and passed;
+
+    return passed ? 0 : 1;
+}
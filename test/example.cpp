@@ -4,6 +4,7 @@
 
 #include <telescope.hpp>
 
+#include <deque>
 #include <iostream>
 #include <random>
 
@@ -55,7 +56,7 @@ int main()
     world.set_gravity(Vector2f(0, 100)); // gravity pulls screen-down
 
     // level geometry:;
-    std::vector<CollisionLineSequenceShape> boundaries;
+    std::deque<CollisionLineSequenceShape> boundaries;
 
     // outer boundaries of the screen
     boundaries.emplace_back(&world, ts::STATIC, std::vector<Vector2f>{
@@ -71,12 +72,13 @@ int main()
     const auto screen_center = Vector2f(window_size.x / 2.f, window_size.y / 2.f);
 
     // horizontal line, -x: left, +y : right
-    auto line = std::vector<CollisionLineShape>{CollisionLineShape(
+    std::deque<CollisionLineShape> line;
+    line.emplace_back(
         &world,         // world
         ts::KINEMATIC,  // kinematic: can be moved and rotated but does not repond forces
         Vector2f(0, screen_center.y), // left vertex
         Vector2f(window_size.x, screen_center.y)  // right vertex
-    )};
+    );
 
     auto spike_vertices = {
         Vector2f(screen_center + Vector2f(-frame, 0)),
@@ -85,14 +87,15 @@ int main()
         Vector2f(screen_center + Vector2f(0, +2 * frame)),
         Vector2f(screen_center + Vector2f(-frame, 0))   // duplicate first to close the loop
     };
-    auto spike = std::vector<CollisionLineSequenceShape>{CollisionLineSequenceShape(
+    std::deque<CollisionLineSequenceShape> spike;
+    spike.emplace_back(
         &world,
         ts::KINEMATIC,
         spike_vertices
-    )};
+    );
 
     // fully dynamic entities
-    std::vector<CollisionPolygonShape> polygons;
+    std::deque<CollisionPolygonShape> polygons;
 
     // function to randomly spawn an entity inside the level arena
     auto spawn = [&](){
@@ -184,7 +187,7 @@ int main()
     // win conditions: all polygons are on one side of the line
     auto sound = Sound();
     sound.load("./test/ok_desu_ka.mp3");
-    std::vector<CollisionCircleShape> win_condition_snow;
+    std::deque<CollisionCircleShape> win_condition_snow;
 
     auto check_win_condition = [&]()
     {